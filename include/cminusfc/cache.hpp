@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+/*
+ * Content addressed cache of compiler outputs in a directory.
+ *
+ * An entry is named by the hash of the compiler binary, the options that
+ * change the output and the input bytes. The hash only picks the file: an
+ * entry starts with the full key and a lookup compares it, so two inputs
+ * with one hash never share an output. Entries are written to a temporary
+ * file and renamed, so concurrent compilers never see a partial entry.
+ * A hit refreshes the mtime of the entry. The "stats" file keeps the hit
+ * and miss counts over all runs and the running size of the cache, so
+ * evict() only lists the directory when the size limit is crossed, and then
+ * removes the least recently used entries until the cache fits.
+ */
+class CompileCache {
+  public:
+    struct Key {
+        std::string name; // the file name, a hash of text
+        std::string text; // everything the output depends on
+    };
+
+    CompileCache(std::filesystem::path dir, uint64_t max_size);
+
+    Key make_key(const std::string &options, const std::string &input) const;
+    bool lookup(const Key &key, std::string &output);
+    void store(const Key &key, const std::string &output);
+
+    // adds the counts of this run to the totals and enforces the size limit
+    void evict();
+    // the counts as of the last evict()
+    void print_stats(std::ostream &os) const;
+
+  private:
+    std::filesystem::path dir_;
+    uint64_t max_size_;
+    // identifies the compiler build, outputs of other builds never match
+    std::string version_;
+    std::atomic<unsigned> hits_{0};
+    std::atomic<unsigned> misses_{0};
+    // change of the cache by store(), added to the totals by evict()
+    std::atomic<int64_t> stored_entries_{0};
+    std::atomic<int64_t> stored_size_{0};
+    // filled by evict()
+    unsigned long long run_hits_{0}, run_misses_{0};
+    unsigned long long total_hits_{0}, total_misses_{0};
+    uint64_t num_entries_{0}, total_size_{0};
+
+    // lists the directory for the exact totals, and removes entries down
+    // to the size limit
+    void scan();
+};
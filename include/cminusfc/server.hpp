@@ -0,0 +1,39 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+ * Compile server protocol over a local Unix socket.
+ *
+ * client -> server: frame(cwd), frame(args joined by '\0'), frame(source),
+ *                   stdin, stdout and stderr of the client as SCM_RIGHTS
+ * server -> client: frame(status), frame(output file), frame(output)
+ *
+ * A frame is a 32-bit length followed by the bytes. Every request is served
+ * by a process forked from the warm server, so diagnostics go straight to the
+ * client's terminal and a crash only ends that request.
+ */
+
+struct CompileRequest {
+    std::string cwd;
+    std::vector<std::string> args; // args[0] is the compiler name
+    std::string source;
+};
+
+struct CompileResponse {
+    int status{0};
+    std::string output_file; // relative to the request cwd, empty if none
+    std::string output;
+};
+
+using RequestHandler = std::function<CompileResponse(const CompileRequest &)>;
+
+// server side, runs until killed
+int run_server(const std::string &socket_path, const RequestHandler &handler);
+
+// client side
+int connect_server(const std::string &socket_path);
+bool send_request(int fd, const CompileRequest &request);
+bool recv_response(int fd, CompileResponse &response);
@@ -63,21 +63,25 @@ class CodeGen {
     void gen_fptosi();
     void gen_epilogue();
 
-    static std::string label_name(BasicBlock *bb) {
-        return "." + bb->get_parent()->get_name() + "_" + bb->get_name();
+    // bb is a block of context.func, whose name starts the label
+    std::string label_name(BasicBlock *bb) const {
+        auto label = context.label_prefix;
+        bb->append_name(label);
+        return label;
     }
 
     static std::string func_exit_label_name(Function *func) {
         return func->get_name() + "_exit";
     }
 
-    static std::string fcmp_label_name(BasicBlock *bb, unsigned cnt) {
+    std::string fcmp_label_name(BasicBlock *bb, unsigned cnt) const {
         return label_name(bb) + "_fcmp_" + std::to_string(cnt);
     }
 
     struct {
         /* 随着ir遍历设置 */
         Function *func{nullptr};    // 当前函数
+        std::string label_prefix{}; // 当前函数中基本块 label 的前缀
         BasicBlock *bb{nullptr};    // 当前基本块
         Instruction *inst{nullptr}; // 当前指令
         /* 在allocate()中设置 */
@@ -87,6 +91,7 @@ class CodeGen {
 
         void clear() {
             func = nullptr;
+            label_prefix.clear();
             bb = nullptr;
             inst = nullptr;
             frame_size = 0;
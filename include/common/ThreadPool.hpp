@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * 简单的 work-stealing 线程池：
+ * 每个工作线程有自己的任务队列，自己的队列为空时从其他线程的队列尾部窃取任务。
+ * 任务接收执行它的工作线程编号，便于使用按线程划分的数据。
+ */
+class ThreadPool {
+  public:
+    using Task = std::function<void(unsigned worker_id)>;
+
+    explicit ThreadPool(unsigned num_threads);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    unsigned size() const { return threads_.size(); }
+
+    void submit(Task task);
+    // 阻塞直到所有已提交的任务执行完毕
+    void wait();
+
+  private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void worker_loop(unsigned id);
+    bool try_pop(unsigned id, Task &task);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    std::atomic<unsigned> queued_{0};  // 尚在队列中的任务
+    std::atomic<unsigned> pending_{0}; // 尚未执行完的任务
+    unsigned next_queue_{0};
+    bool stop_{false};
+};
@@ -4,6 +4,7 @@
 extern "C" {
 #include "syntax_tree.h"
 extern syntax_tree *parse(const char *input);
+extern syntax_tree *parse_file(FILE *input);
 }
 #include "User.hpp"
 #include <memory>
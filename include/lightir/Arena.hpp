@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/*
+ * Bump allocator backing the IR objects of a Module. Memory is handed out
+ * from large slabs and is only returned when the arena itself is destroyed,
+ * so objects erased earlier just leave their storage unused until then.
+ * Allocation is locked, function passes may create IR on several threads.
+ */
+class Arena {
+  public:
+    Arena() = default;
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *allocate(size_t size, size_t align = alignof(std::max_align_t));
+
+  private:
+    static constexpr size_t slab_size = 64 * 1024;
+
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<char[]>> slabs_;
+    char *cur_{nullptr};
+    char *end_{nullptr};
+};
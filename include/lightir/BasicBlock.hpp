@@ -4,32 +4,37 @@
 #include "Value.hpp"
 
 #include <list>
+#include <llvm/ADT/SmallVector.h>
 #include <llvm/ADT/ilist.h>
 #include <llvm/ADT/ilist_node.h>
 #include <set>
 #include <string>
 
+class BranchInst;
 class Function;
 class Instruction;
 class Module;
 
 class BasicBlock : public Value, public llvm::ilist_node<BasicBlock> {
   public:
-    ~BasicBlock() = default;
+    ~BasicBlock();
     static BasicBlock *create(Module *m, const std::string &name,
                               Function *parent) {
         auto prefix = name.empty() ? "" : "label_";
-        return new BasicBlock(m, prefix + name, parent);
+        return new (m) BasicBlock(m, prefix + name, parent);
+    }
+    static bool classof(const Value *v) {
+        return v->get_value_kind() == BasicBlockVal;
     }
 
     /****************api about cfg****************/
-    std::list<BasicBlock *> &get_pre_basic_blocks() { return pre_bbs_; }
-    std::list<BasicBlock *> &get_succ_basic_blocks() { return succ_bbs_; }
-
-    void add_pre_basic_block(BasicBlock *bb) { pre_bbs_.push_back(bb); }
-    void add_succ_basic_block(BasicBlock *bb) { succ_bbs_.push_back(bb); }
-    void remove_pre_basic_block(BasicBlock *bb) { pre_bbs_.remove(bb); }
-    void remove_succ_basic_block(BasicBlock *bb) { succ_bbs_.remove(bb); }
+    // the edges follow the targets of the br instructions, creating,
+    // retargeting or deleting a br updates both ends in O(1); a cond br with
+    // the same target twice is two edges. The successors are in operand
+    // order, removing a predecessor moves the last one into its place.
+    using BBList = llvm::SmallVector<BasicBlock *, 2>;
+    const BBList &get_pre_basic_blocks() const { return pre_bbs_; }
+    const BBList &get_succ_basic_blocks() const { return succ_bbs_; }
 
     // If the Block is terminated by ret/br
     bool is_terminated() const;
@@ -38,7 +43,7 @@ class BasicBlock : public Value, public llvm::ilist_node<BasicBlock> {
 
     /****************api about Instruction****************/
     void add_instruction(Instruction *instr);
-    void add_instr_begin(Instruction *instr) { instr_list_.push_front(instr); }
+    void add_instr_begin(Instruction *instr);
     void erase_instr(Instruction *instr) { instr_list_.erase(instr); }
     void remove_instr(Instruction *instr) { instr_list_.remove(instr); }
 
@@ -51,14 +56,33 @@ class BasicBlock : public Value, public llvm::ilist_node<BasicBlock> {
     Module *get_module();
     void erase_from_parent();
 
+    // dense index within the function, see Function::renumber
+    unsigned get_index() const { return index_; }
+
     virtual std::string print() override;
+    // a block is small, it is formatted as one string and written to os
+    void print(std::ostream &os);
 
   private:
+    friend class BranchInst;
+    friend class Function;
+
     BasicBlock(const BasicBlock &) = delete;
     explicit BasicBlock(Module *m, const std::string &name, Function *parent);
 
-    std::list<BasicBlock *> pre_bbs_;
-    std::list<BasicBlock *> succ_bbs_;
+    // idx is the position of the edge among the successors of from
+    static void insert_edge(BasicBlock *from, unsigned idx, BasicBlock *to);
+    static void erase_edge(BasicBlock *from, unsigned idx);
+    static void renumber_succs(BasicBlock *from, unsigned idx);
+    // gives instr the next index of the function if it has none yet
+    void take_index(Instruction *instr);
+
+    BBList pre_bbs_;
+    BBList succ_bbs_;
+    // position of each edge in the list of its other end
+    llvm::SmallVector<unsigned, 2> pre_mates_;
+    llvm::SmallVector<unsigned, 2> succ_mates_;
     llvm::ilist<Instruction> instr_list_;
     Function *parent_;
+    unsigned index_{0};
 };
@@ -8,16 +8,27 @@ class Constant : public User {
   private:
     // int value;
   public:
-    Constant(Type *ty, const std::string &name = "") : User(ty, name) {}
+    Constant(ValueKind kind, Type *ty, const std::string &name = "")
+        : User(kind, ty, name) {
+        set_module_level();
+    }
     ~Constant() = default;
+    static bool classof(const Value *v) {
+        return v->get_value_kind() >= ConstantIntVal and
+               v->get_value_kind() <= ConstantZeroVal;
+    }
 };
 
 class ConstantInt : public Constant {
   private:
     int value_;
-    ConstantInt(Type *ty, int val) : Constant(ty, ""), value_(val) {}
+    ConstantInt(Type *ty, int val)
+        : Constant(ConstantIntVal, ty, ""), value_(val) {}
 
   public:
+    static bool classof(const Value *v) {
+        return v->get_value_kind() == ConstantIntVal;
+    }
     int get_value() { return value_; }
     static ConstantInt *get(int val, Module *m);
     static ConstantInt *get(bool val, Module *m);
@@ -32,8 +43,12 @@ class ConstantArray : public Constant {
 
   public:
     ~ConstantArray() = default;
+    static bool classof(const Value *v) {
+        return v->get_value_kind() == ConstantArrayVal;
+    }
 
     Constant *get_element_value(int index);
+    const std::vector<Constant *> &get_elements() const { return const_array; }
 
     unsigned get_size_of_array() { return const_array.size(); }
 
@@ -45,9 +60,12 @@ class ConstantArray : public Constant {
 
 class ConstantZero : public Constant {
   private:
-    ConstantZero(Type *ty) : Constant(ty, "") {}
+    ConstantZero(Type *ty) : Constant(ConstantZeroVal, ty, "") {}
 
   public:
+    static bool classof(const Value *v) {
+        return v->get_value_kind() == ConstantZeroVal;
+    }
     static ConstantZero *get(Type *ty, Module *m);
     virtual std::string print() override;
 };
@@ -55,9 +73,13 @@ class ConstantZero : public Constant {
 class ConstantFP : public Constant {
   private:
     float val_;
-    ConstantFP(Type *ty, float val) : Constant(ty, ""), val_(val) {}
+    ConstantFP(Type *ty, float val)
+        : Constant(ConstantFPVal, ty, ""), val_(val) {}
 
   public:
+    static bool classof(const Value *v) {
+        return v->get_value_kind() == ConstantFPVal;
+    }
     static ConstantFP *get(float val, Module *m);
     float get_value() { return val_; }
     virtual std::string print() override;
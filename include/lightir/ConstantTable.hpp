@@ -0,0 +1,41 @@
+#pragma once
+
+#include "UniqueTable.hpp"
+#include "Value.hpp"
+
+#include <cstdint>
+#include <vector>
+
+class Constant;
+class Type;
+
+// a constant is found by its kind, type and contents: the value of an int,
+// the bits of a float (so 0.0 and -0.0 stay apart) or the elements of an
+// array
+struct ConstantKey {
+    Value::ValueKind kind;
+    Type *type;
+    // value of an int, bits of a float
+    uint32_t bits;
+    // elements of an array
+    const std::vector<Constant *> *elements;
+};
+
+struct ConstantKeyInfo {
+    static uint64_t hash(const ConstantKey &key);
+    static bool matches(Constant *constant, const ConstantKey &key);
+};
+
+/*
+ * Uniquing table of the constants of a Module. It owns the constants and
+ * frees them with the module; there is no global state, so modules on
+ * different threads never contend.
+ */
+class ConstantTable
+    : public UniqueTable<Constant, ConstantKey, ConstantKeyInfo> {
+  public:
+    ~ConstantTable() { clear(); }
+
+    // frees every constant, the IR must not use them anymore
+    void clear();
+};
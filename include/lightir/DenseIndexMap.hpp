@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+
+class BasicBlock;
+class Instruction;
+
+/*
+ * Side table keyed by the dense index of a block or an instruction of one
+ * function (see Function::renumber), a lookup is a vector access. The map is
+ * sized for the keys of the function; keys made after that grow it when they
+ * are first written.
+ */
+template <typename Key, typename T> class DenseIndexMap {
+  public:
+    DenseIndexMap() = default;
+    explicit DenseIndexMap(unsigned num_indices) : slots_(num_indices) {}
+
+    T &operator[](const Key *key) {
+        auto idx = key->get_index();
+        if (idx >= slots_.size())
+            slots_.resize(idx + 1);
+        return slots_[idx].value;
+    }
+    // a key made after the map was sized reads as T()
+    const T &at(const Key *key) const {
+        auto idx = key->get_index();
+        return idx < slots_.size() ? slots_[idx].value : empty_;
+    }
+
+    // drops every value and sizes the map for num_indices keys
+    void reset(unsigned num_indices) {
+        slots_.clear();
+        slots_.resize(num_indices);
+    }
+
+  private:
+    // keeps std::vector<bool> from packing a map of bools
+    struct Slot {
+        T value{};
+    };
+    std::vector<Slot> slots_;
+    static inline const T empty_{};
+};
+
+template <typename T> using DenseBlockMap = DenseIndexMap<BasicBlock, T>;
+template <typename T> using DenseInstMap = DenseIndexMap<Instruction, T>;
@@ -12,6 +12,7 @@
 #include <llvm/ADT/ilist_node.h>
 #include <map>
 #include <memory>
+#include <string_view>
 
 class Module;
 class Argument;
@@ -25,6 +26,9 @@ class Function : public Value, public llvm::ilist_node<Function> {
     ~Function() = default;
     static Function *create(FunctionType *ty, const std::string &name,
                             Module *parent);
+    static bool classof(const Value *v) {
+        return v->get_value_kind() == FunctionVal;
+    }
 
     FunctionType *get_function_type() const;
     Type *get_return_type() const;
@@ -44,14 +48,33 @@ class Function : public Value, public llvm::ilist_node<Function> {
 
     bool is_declaration() { return basic_blocks_.empty(); }
 
+    // Every block and instruction has a distinct index below
+    // get_num_block_indices()/get_num_inst_indices(), which keys side tables
+    // such as DenseBlockMap. New ones take the next index; the indices of
+    // removed ones stay unused until renumber() packs them in layout order,
+    // which must not happen while a side table of the function is alive.
+    unsigned get_num_block_indices() const { return num_block_indices_; }
+    unsigned get_num_inst_indices() const { return num_inst_indices_; }
+    void renumber();
+
     void set_instr_name();
+    // names v, an argument, block or instruction of this function read back
+    // from printed IR; a name such as "op12" stays numbered and the names
+    // made by set_instr_name start past it
+    void set_printed_name(Value *v, std::string_view name);
     std::string print();
+    // writes the function to os without building it as a string first
+    void print(std::ostream &os);
 
   private:
+    friend class BasicBlock;
+
     llvm::ilist<BasicBlock> basic_blocks_;
     std::list<Argument> arguments_;
     Module *parent_;
     unsigned seq_cnt_; // print use
+    unsigned num_block_indices_{0};
+    unsigned num_inst_indices_{0};
 };
 
 // Argument of Function, does not contain actual value
@@ -60,8 +83,11 @@ class Argument : public Value {
     Argument(const Argument &) = delete;
     explicit Argument(Type *ty, const std::string &name = "",
                       Function *f = nullptr, unsigned arg_no = 0)
-        : Value(ty, name), parent_(f), arg_no_(arg_no) {}
+        : Value(ArgumentVal, ty, name), parent_(f), arg_no_(arg_no) {}
     virtual ~Argument() {}
+    static bool classof(const Value *v) {
+        return v->get_value_kind() == ArgumentVal;
+    }
 
     inline const Function *get_parent() const { return parent_; }
     inline Function *get_parent() { return parent_; }
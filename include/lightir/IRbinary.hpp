@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Module.hpp"
+
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <string>
+
+/*
+ * Compact binary form of a Module, loaded back without parsing text.
+ *
+ * The file is "LIRB", the format version, then the sections below. Every
+ * number is an unsigned LEB128 varint, signed ints are zigzag encoded and a
+ * name is an index into the string table (0 is the empty name).
+ *
+ *   strings    count, then length and bytes of each string
+ *   types      count, then TypeID and the ids of contained types, a type
+ *              only refers to types before it
+ *   constants  count, then ValueKind, type and value of each constant, the
+ *              elements of a ConstantArray come before it
+ *   globals    count, then name, element type, is_const and init + 1
+ *   functions  count and the name and type of each function, then the body
+ *              of each one: number of blocks (0 for a declaration), the
+ *              names of the args, name and size of each block and the
+ *              instructions as OpID, name, type, number of operands and
+ *              the operands
+ *
+ * Globals, functions, then the args, blocks and instructions of the current
+ * function are numbered in that order. An operand is (id << 2 | tag): a
+ * numbered value, a constant, or an instruction further down the function
+ * (a phi incoming value, or a block laid out before its dominator), which
+ * is followed by its type.
+ */
+
+// writes m in the binary form
+void write_binary(Module *m, std::ostream &os);
+
+// rebuilds the module, nullptr if data is truncated or malformed; types and
+// operands are checked as IRparser does, so bad input never reaches the
+// asserts of the constructors
+std::unique_ptr<Module> read_binary(const char *data, size_t size);
+// maps the file into memory and reads it, nullptr if it cannot be read
+std::unique_ptr<Module> read_binary_file(const std::string &file);
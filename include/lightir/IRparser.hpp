@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Module.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+/*
+ * Single pass parser for the .ll dialect printed by Module::print.
+ *
+ * Values may be used before they are defined (phi incoming values, blocks
+ * and functions defined further down); the module comes out with globals,
+ * functions and blocks in the order of the text. Types are checked while
+ * parsing, so malformed IR gives an error instead of an assert in the
+ * instruction constructors. The "undef" incoming values printed for the
+ * predecessors a phi does not list are skipped.
+ */
+
+// nullptr on error, err is then "line <n>: <message>"
+std::unique_ptr<Module> parse_ir(const char *data, size_t size,
+                                 std::string &err);
+std::unique_ptr<Module> parse_ir_file(const std::string &file,
+                                      std::string &err);
@@ -5,6 +5,7 @@
 
 #include <cstdint>
 #include <llvm/ADT/ilist_node.h>
+#include <tuple>
 
 class BasicBlock;
 class Function;
@@ -70,6 +71,10 @@ class Instruction : public User, public llvm::ilist_node<Instruction> {
     OpID get_instr_type() const { return op_id_; }
     std::string get_instr_op_name() const;
 
+    // dense index within the function, given when the instruction is first
+    // put into a block, see Function::renumber
+    unsigned get_index() const { return index_; }
+
     bool is_void() {
         return ((op_id_ == ret) || (op_id_ == br) || (op_id_ == store) ||
                 (op_id_ == call && this->get_type()->is_void_type()));
@@ -109,15 +114,37 @@ class Instruction : public User, public llvm::ilist_node<Instruction> {
 
     bool isTerminator() const { return is_br() || is_ret(); }
 
+    static bool classof(const Value *v) {
+        return v->get_value_kind() == InstructionVal;
+    }
+
+  protected:
+    // classof of the subclasses: an instruction with first <= op_id <= last
+    static bool is_op(const Value *v, OpID first, OpID last) {
+        if (not classof(v))
+            return false;
+        auto id = static_cast<const Instruction *>(v)->op_id_;
+        return first <= id and id <= last;
+    }
+
   private:
+    friend class BasicBlock;
+    friend class Function;
+
+    static constexpr unsigned no_index = ~0u;
+
     OpID op_id_;
+    unsigned index_{no_index};
     BasicBlock *parent_;
 };
 
 template <typename Inst> class BaseInst : public Instruction {
   protected:
+    // every create_* passes the basic block last, the instruction is
+    // allocated from the arena of its module
     template <typename... Args> static Inst *create(Args &&...args) {
-        return new Inst(std::forward<Args>(args)...);
+        auto bb = std::get<sizeof...(Args) - 1>(std::forward_as_tuple(args...));
+        return new (bb->get_module()) Inst(std::forward<Args>(args)...);
     }
 
     template <typename... Args>
@@ -131,6 +158,7 @@ class IBinaryInst : public BaseInst<IBinaryInst> {
     IBinaryInst(OpID id, Value *v1, Value *v2, BasicBlock *bb);
 
   public:
+    static bool classof(const Value *v) { return is_op(v, add, sdiv); }
     static IBinaryInst *create_add(Value *v1, Value *v2, BasicBlock *bb);
     static IBinaryInst *create_sub(Value *v1, Value *v2, BasicBlock *bb);
     static IBinaryInst *create_mul(Value *v1, Value *v2, BasicBlock *bb);
@@ -146,6 +174,7 @@ class FBinaryInst : public BaseInst<FBinaryInst> {
     FBinaryInst(OpID id, Value *v1, Value *v2, BasicBlock *bb);
 
   public:
+    static bool classof(const Value *v) { return is_op(v, fadd, fdiv); }
     static FBinaryInst *create_fadd(Value *v1, Value *v2, BasicBlock *bb);
     static FBinaryInst *create_fsub(Value *v1, Value *v2, BasicBlock *bb);
     static FBinaryInst *create_fmul(Value *v1, Value *v2, BasicBlock *bb);
@@ -161,6 +190,7 @@ class ICmpInst : public BaseInst<ICmpInst> {
     ICmpInst(OpID id, Value *lhs, Value *rhs, BasicBlock *bb);
 
   public:
+    static bool classof(const Value *v) { return is_op(v, ge, ne); }
     static ICmpInst *create_ge(Value *v1, Value *v2, BasicBlock *bb);
     static ICmpInst *create_gt(Value *v1, Value *v2, BasicBlock *bb);
     static ICmpInst *create_le(Value *v1, Value *v2, BasicBlock *bb);
@@ -178,6 +208,7 @@ class FCmpInst : public BaseInst<FCmpInst> {
     FCmpInst(OpID id, Value *lhs, Value *rhs, BasicBlock *bb);
 
   public:
+    static bool classof(const Value *v) { return is_op(v, fge, fne); }
     static FCmpInst *create_fge(Value *v1, Value *v2, BasicBlock *bb);
     static FCmpInst *create_fgt(Value *v1, Value *v2, BasicBlock *bb);
     static FCmpInst *create_fle(Value *v1, Value *v2, BasicBlock *bb);
@@ -195,6 +226,7 @@ class CallInst : public BaseInst<CallInst> {
     CallInst(Function *func, std::vector<Value *> args, BasicBlock *bb);
 
   public:
+    static bool classof(const Value *v) { return is_op(v, call, call); }
     static CallInst *create_call(Function *func, std::vector<Value *> args,
                                  BasicBlock *bb);
     FunctionType *get_function_type() const;
@@ -210,7 +242,12 @@ class BranchInst : public BaseInst<BranchInst> {
                BasicBlock *bb);
     ~BranchInst();
 
+    // position among the successors of the target in operand i
+    unsigned succ_index(unsigned i) const;
+    void on_set_operand(unsigned i, Value *old_val) override;
+
   public:
+    static bool classof(const Value *v) { return is_op(v, br, br); }
     static BranchInst *create_cond_br(Value *cond, BasicBlock *if_true,
                                       BasicBlock *if_false, BasicBlock *bb);
     static BranchInst *create_br(BasicBlock *if_true, BasicBlock *bb);
@@ -229,6 +266,7 @@ class ReturnInst : public BaseInst<ReturnInst> {
     ReturnInst(Value *val, BasicBlock *bb);
 
   public:
+    static bool classof(const Value *v) { return is_op(v, ret, ret); }
     static ReturnInst *create_ret(Value *val, BasicBlock *bb);
     static ReturnInst *create_void_ret(BasicBlock *bb);
     bool is_void_ret() const;
@@ -243,7 +281,11 @@ class GetElementPtrInst : public BaseInst<GetElementPtrInst> {
     GetElementPtrInst(Value *ptr, std::vector<Value *> idxs, BasicBlock *bb);
 
   public:
-    static Type *get_element_type(Value *ptr, std::vector<Value *> idxs);
+    static bool classof(const Value *v) {
+        return is_op(v, getelementptr, getelementptr);
+    }
+    static Type *get_element_type(Value *ptr,
+                                  const std::vector<Value *> &idxs);
     static GetElementPtrInst *create_gep(Value *ptr, std::vector<Value *> idxs,
                                          BasicBlock *bb);
     Type *get_element_type() const;
@@ -258,6 +300,7 @@ class StoreInst : public BaseInst<StoreInst> {
     StoreInst(Value *val, Value *ptr, BasicBlock *bb);
 
   public:
+    static bool classof(const Value *v) { return is_op(v, store, store); }
     static StoreInst *create_store(Value *val, Value *ptr, BasicBlock *bb);
 
     Value *get_rval() { return this->get_operand(0); }
@@ -273,6 +316,7 @@ class LoadInst : public BaseInst<LoadInst> {
     LoadInst(Value *ptr, BasicBlock *bb);
 
   public:
+    static bool classof(const Value *v) { return is_op(v, load, load); }
     static LoadInst *create_load(Value *ptr, BasicBlock *bb);
 
     Value *get_lval() const { return this->get_operand(0); }
@@ -288,6 +332,7 @@ class AllocaInst : public BaseInst<AllocaInst> {
     AllocaInst(Type *ty, BasicBlock *bb);
 
   public:
+    static bool classof(const Value *v) { return is_op(v, alloca, alloca); }
     static AllocaInst *create_alloca(Type *ty, BasicBlock *bb);
 
     Type *get_alloca_type() const {
@@ -304,6 +349,7 @@ class ZextInst : public BaseInst<ZextInst> {
     ZextInst(Value *val, Type *ty, BasicBlock *bb);
 
   public:
+    static bool classof(const Value *v) { return is_op(v, zext, zext); }
     static ZextInst *create_zext(Value *val, Type *ty, BasicBlock *bb);
     static ZextInst *create_zext_to_i32(Value *val, BasicBlock *bb);
 
@@ -319,6 +365,7 @@ class FpToSiInst : public BaseInst<FpToSiInst> {
     FpToSiInst(Value *val, Type *ty, BasicBlock *bb);
 
   public:
+    static bool classof(const Value *v) { return is_op(v, fptosi, fptosi); }
     static FpToSiInst *create_fptosi(Value *val, Type *ty, BasicBlock *bb);
     static FpToSiInst *create_fptosi_to_i32(Value *val, BasicBlock *bb);
 
@@ -334,6 +381,7 @@ class SiToFpInst : public BaseInst<SiToFpInst> {
     SiToFpInst(Value *val, Type *ty, BasicBlock *bb);
 
   public:
+    static bool classof(const Value *v) { return is_op(v, sitofp, sitofp); }
     static SiToFpInst *create_sitofp(Value *val, BasicBlock *bb);
 
     Type *get_dest_type() const { return get_type(); };
@@ -349,6 +397,7 @@ class PhiInst : public BaseInst<PhiInst> {
             std::vector<BasicBlock *> val_bbs, BasicBlock *bb);
 
   public:
+    static bool classof(const Value *v) { return is_op(v, phi, phi); }
     static PhiInst *create_phi(Type *ty, BasicBlock *bb,
                                std::vector<Value *> vals = {},
                                std::vector<BasicBlock *> val_bbs = {});
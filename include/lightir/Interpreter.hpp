@@ -0,0 +1,101 @@
+#pragma once
+
+#include "Instruction.hpp"
+#include "Module.hpp"
+
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <vector>
+
+/*
+ * Executes a Module directly, starting from main. The runtime functions of
+ * src/io/io.c (input/output/outputFloat/neg_idx_except) are provided natively.
+ * Every executed instruction is counted per opcode, per function and per
+ * basic block, as a cost metric for the optimization passes.
+ */
+class Interpreter {
+  public:
+    explicit Interpreter(Module *m, std::istream &in = std::cin,
+                         std::ostream &out = std::cout);
+    ~Interpreter();
+
+    // runs main and returns its return value
+    int run();
+
+    uint64_t get_total_count() const;
+    void print_stats(std::ostream &os) const;
+
+  private:
+    // a runtime value, its type is known from the IR
+    union RtValue {
+        int32_t i;
+        float f;
+        char *p;
+    };
+
+    // an operand is a slot of the frame, or an immediate value
+    struct Operand {
+        int slot;
+        RtValue imm;
+    };
+
+    struct PhiMove {
+        unsigned dest;
+        Operand src;
+    };
+
+    struct FuncState;
+    struct BlockState;
+
+    struct InstState {
+        Instruction::OpID op;
+        int dest; // slot of the result, -1 if void
+        std::vector<Operand> ops;
+        // load/store: size of the accessed value
+        // alloca: offset in the frame memory
+        unsigned size;
+        // getelementptr: element size for each index
+        std::vector<unsigned> scales;
+        // call
+        Function *callee;
+        // br: targets and the phi moves of each edge
+        BlockState *targets[2];
+        std::vector<PhiMove> moves[2];
+    };
+
+    struct BlockState {
+        BasicBlock *bb;
+        unsigned num_phis;
+        std::vector<InstState> insts;
+        uint64_t entries{0};
+        uint64_t count{0};
+    };
+
+    struct FuncState {
+        Function *func;
+        unsigned num_slots{0};
+        unsigned frame_size{0};
+        std::vector<std::unique_ptr<BlockState>> blocks;
+        uint64_t calls{0};
+        uint64_t count{0};
+    };
+
+    FuncState *get_func_state(Function *func);
+    Operand get_operand(Value *v, const std::map<Value *, unsigned> &slots);
+    void init_global(char *mem, Constant *init);
+
+    RtValue call(Function *func, const std::vector<RtValue> &args);
+    RtValue call_builtin(Function *func, const std::vector<RtValue> &args);
+    RtValue execute(FuncState *state, const std::vector<RtValue> &args);
+
+    Module *m_;
+    std::istream &in_;
+    std::ostream &out_;
+
+    std::map<GlobalVariable *, std::unique_ptr<char[]>> globals_;
+    std::map<Function *, std::unique_ptr<FuncState>> funcs_;
+    std::array<uint64_t, Instruction::sitofp + 1> op_counts_{};
+};
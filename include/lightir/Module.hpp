@@ -1,15 +1,18 @@
 #pragma once
 
+#include "Arena.hpp"
+#include "ConstantTable.hpp"
+#include "StringInterner.hpp"
 #include "Function.hpp"
 #include "GlobalVariable.hpp"
 #include "Instruction.hpp"
 #include "Type.hpp"
+#include "TypeTable.hpp"
 #include "Value.hpp"
 
 #include <list>
 #include <llvm/ADT/ilist.h>
 #include <llvm/ADT/ilist_node.h>
-#include <map>
 #include <memory>
 #include <string>
 
@@ -18,7 +21,7 @@ class Function;
 class Module {
   public:
     Module();
-    ~Module() = default;
+    ~Module();
 
     Type *get_void_type();
     Type *get_label_type();
@@ -30,7 +33,8 @@ class Module {
 
     PointerType *get_pointer_type(Type *contained);
     ArrayType *get_array_type(Type *contained, unsigned num_elements);
-    FunctionType *get_function_type(Type *retty, std::vector<Type *> &args);
+    FunctionType *get_function_type(Type *retty,
+                                    const std::vector<Type *> &args);
 
     void add_function(Function *f);
     llvm::ilist<Function> &get_functions();
@@ -39,8 +43,20 @@ class Module {
 
     void set_print_name();
     std::string print();
+    // streams the module to os, global by global and function by function
+    void print(std::ostream &os);
+
+    Arena &get_arena() { return arena_; }
+    // the names of the values of this module
+    StringInterner &get_names() { return names_; }
+    // see ConstantInt::get and the other Constant factories
+    ConstantTable &get_constants() { return constants_; }
 
   private:
+    // declared first so that it outlives every IR object of the module
+    Arena arena_;
+    StringInterner names_{arena_};
+    ConstantTable constants_;
     // The global variables in the module
     llvm::ilist<GlobalVariable> global_list_;
     // The functions in the module
@@ -51,9 +67,6 @@ class Module {
     std::unique_ptr<Type> label_ty_;
     std::unique_ptr<Type> void_ty_;
     std::unique_ptr<FloatType> float32_ty_;
-    std::map<Type *, std::unique_ptr<PointerType>> pointer_map_;
-    std::map<std::pair<Type *, int>, std::unique_ptr<ArrayType>> array_map_;
-    std::map<std::pair<Type *, std::vector<Type *>>,
-             std::unique_ptr<FunctionType>>
-        function_map_;
+    // pointer, array and function types
+    TypeTable types_;
 };
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Arena.hpp"
+#include "UniqueTable.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// header of an interned string, the characters follow it in the arena
+struct InternedString {
+    size_t size;
+    const char *data() const {
+        return reinterpret_cast<const char *>(this + 1);
+    }
+    std::string_view view() const { return {data(), size}; }
+};
+
+/*
+ * Name of a Value in one machine word: empty, an interned string, or a
+ * numbered temporary such as "op12" whose text is only made when the name
+ * is printed. The low bit tells the last two apart, an InternedString is
+ * at least 8 byte aligned.
+ */
+class Symbol {
+  public:
+    enum Prefix : uint8_t { Arg, Label, Op };
+
+    Symbol() = default;
+    explicit Symbol(const InternedString *str)
+        : bits_(reinterpret_cast<uintptr_t>(str)) {}
+    static Symbol numbered(Prefix prefix, uintptr_t num) {
+        Symbol sym;
+        sym.bits_ = num << 3 | uintptr_t(prefix) << 1 | 1;
+        return sym;
+    }
+    // the prefix and number of str if append_to prints a numbered symbol
+    // as exactly str ("op12", not "op012")
+    static bool parse_numbered(std::string_view str, Prefix &prefix,
+                               uintptr_t &num);
+
+    bool empty() const { return bits_ == 0; }
+    void append_to(std::string &out) const;
+    std::string str() const {
+        std::string out;
+        append_to(out);
+        return out;
+    }
+
+  private:
+    uintptr_t bits_{0};
+};
+
+struct InternedStringInfo {
+    static uint64_t hash(std::string_view key) {
+        return std::hash<std::string_view>()(key);
+    }
+    static bool matches(InternedString *str, std::string_view key) {
+        return str->view() == key;
+    }
+};
+
+// the names of a Module, each distinct string is stored once in its arena
+class StringInterner {
+  public:
+    explicit StringInterner(Arena &arena) : arena_(arena) {}
+
+    Symbol intern(std::string_view str);
+
+  private:
+    Arena &arena_;
+    UniqueTable<InternedString, std::string_view, InternedStringInfo> table_;
+};
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cassert>
 #include <iostream>
+#include <string>
 #include <vector>
 
 class Module;
@@ -42,13 +44,27 @@ class Type {
     Type *get_array_element_type() const;
 
     Module *get_module() const { return m_; }
-    unsigned get_size() const;
+    unsigned get_size() const {
+        assert(sized_ && "bad use on get_size()");
+        return size_;
+    }
 
-    std::string print() const;
+    // both are computed once, when the type is created
+    const std::string &print() const { return print_; }
+
+  protected:
+    // called at the end of the constructor of each concrete type
+    void init_cache();
 
   private:
+    unsigned compute_size() const;
+    std::string compute_print() const;
+
     TypeID tid_;
     Module *m_;
+    bool sized_{false};
+    unsigned size_{0};
+    std::string print_;
 };
 
 class IntegerType : public Type {
@@ -63,18 +79,19 @@ class IntegerType : public Type {
 
 class FunctionType : public Type {
   public:
-    FunctionType(Type *result, std::vector<Type *> params);
+    FunctionType(Type *result, const std::vector<Type *> &params);
 
     static bool is_valid_return_type(Type *ty);
     static bool is_valid_argument_type(Type *ty);
 
-    static FunctionType *get(Type *result, std::vector<Type *> params);
+    static FunctionType *get(Type *result, const std::vector<Type *> &params);
 
     unsigned get_num_of_args() const;
 
     Type *get_param_type(unsigned i) const;
     std::vector<Type *>::iterator param_begin() { return args_.begin(); }
     std::vector<Type *>::iterator param_end() { return args_.end(); }
+    const std::vector<Type *> &get_params() const { return args_; }
     Type *get_return_type() const;
 
   private:
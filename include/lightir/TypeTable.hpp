@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Type.hpp"
+#include "UniqueTable.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// a derived type is found by its TypeID and parts: the element type of a
+// pointer or array and the length of the array, or the return type and
+// the parameter types of a function
+struct TypeKey {
+    Type::TypeID tid;
+    Type *contained;
+    unsigned num_elements;
+    const std::vector<Type *> *params;
+};
+
+struct TypeKeyInfo {
+    static uint64_t hash(const TypeKey &key);
+    static bool matches(Type *type, const TypeKey &key);
+};
+
+// hash-consed pointer, array and function types of a Module, freed with it
+class TypeTable : public UniqueTable<Type, TypeKey, TypeKeyInfo> {
+  public:
+    ~TypeTable();
+};
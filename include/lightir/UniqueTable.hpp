@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+// final step of splitmix64, spreads the bits of x over the whole word
+inline uint64_t hash_mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+/*
+ * Hash-consing set of the objects of a Module, such as its constants and
+ * derived types.
+ *
+ * Open addressing with linear probing over a power of two array of
+ * (hash, object) slots; the hash of an object is computed once, when it is
+ * inserted. Info::hash(key) hashes a key and Info::matches(obj, key) tells
+ * whether obj is the object of key, so a lookup never builds an object or
+ * copies its key. The table does not free the objects, see for_each.
+ */
+template <typename T, typename Key, typename Info> class UniqueTable {
+  public:
+    UniqueTable() : slots_(new Slot[min_capacity]) {}
+    UniqueTable(const UniqueTable &) = delete;
+    UniqueTable &operator=(const UniqueTable &) = delete;
+
+    // the object of key, make() creates it on a miss; the lock only orders
+    // the function passes of one module that run in parallel
+    template <typename Make> T *get(const Key &key, Make make) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto hash = Info::hash(key);
+        auto slot = find(key, hash);
+        if (slot->object)
+            return slot->object;
+        auto object = make();
+        slot->hash = hash;
+        slot->object = object;
+        // keep the load factor at most 3/4
+        if (++size_ * 4 > capacity_ * 3)
+            grow();
+        return object;
+    }
+
+    size_t size() const { return size_; }
+
+    template <typename Func> void for_each(Func func) const {
+        for (size_t i = 0; i != capacity_; ++i) {
+            if (slots_[i].object)
+                func(slots_[i].object);
+        }
+    }
+
+    // forgets every object without freeing it
+    void reset() {
+        slots_.reset(new Slot[min_capacity]);
+        capacity_ = min_capacity;
+        size_ = 0;
+    }
+
+  private:
+    static constexpr size_t min_capacity = 64;
+
+    struct Slot {
+        uint64_t hash{0};
+        T *object{nullptr};
+    };
+
+    // the slot of key, or the empty slot it would go to
+    Slot *find(const Key &key, uint64_t hash) {
+        auto mask = capacity_ - 1;
+        for (auto i = hash & mask;; i = (i + 1) & mask) {
+            auto &slot = slots_[i];
+            if (not slot.object or
+                (slot.hash == hash and Info::matches(slot.object, key)))
+                return &slot;
+        }
+    }
+
+    void grow() {
+        auto old_slots = std::move(slots_);
+        auto old_capacity = capacity_;
+        capacity_ *= 2;
+        slots_.reset(new Slot[capacity_]);
+        auto mask = capacity_ - 1;
+        for (size_t i = 0; i != old_capacity; ++i) {
+            auto &slot = old_slots[i];
+            if (not slot.object)
+                continue;
+            auto j = slot.hash & mask;
+            while (slots_[j].object)
+                j = (j + 1) & mask;
+            slots_[j] = slot;
+        }
+    }
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t capacity_{min_capacity};
+    size_t size_{0};
+    std::mutex mutex_;
+};
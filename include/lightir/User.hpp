@@ -2,40 +2,92 @@
 
 #include "Value.hpp"
 
-#include <vector>
+#include <iterator>
+
+// iterable view of the operands of a user
+class OperandList {
+  public:
+    class iterator {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Value *;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value *const *;
+        using reference = Value *const &;
+
+        explicit iterator(const Use *use) : use_(use) {}
+        Value *const &operator*() const { return use_->value_; }
+        iterator &operator++() {
+            ++use_;
+            return *this;
+        }
+        bool operator==(const iterator &other) const {
+            return use_ == other.use_;
+        }
+        bool operator!=(const iterator &other) const {
+            return use_ != other.use_;
+        }
+
+      private:
+        const Use *use_;
+    };
+
+    OperandList(const Use *uses, unsigned size) : uses_(uses), size_(size) {}
+    iterator begin() const { return iterator(uses_); }
+    iterator end() const { return iterator(uses_ + size_); }
+    unsigned size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    Value *operator[](unsigned i) const { return uses_[i].value_; }
+
+  private:
+    const Use *uses_;
+    unsigned size_;
+};
 
 class User : public Value {
   public:
-    User(Type *ty, const std::string &name = "") : Value(ty, name){};
+    User(ValueKind kind, Type *ty, const std::string &name = "")
+        : Value(kind, ty, name){};
     virtual ~User() { remove_all_operands(); }
+    static bool classof(const Value *v) {
+        return v->get_value_kind() >= GlobalVariableVal;
+    }
 
-    const std::vector<Value *> &get_operands() const { return operands_; }
-    unsigned get_num_operand() const { return operands_.size(); }
+    OperandList get_operands() const {
+        return OperandList(operands_, num_operands_);
+    }
+    unsigned get_num_operand() const { return num_operands_; }
 
     // start from 0
-    Value *get_operand(unsigned i) const { return operands_.at(i); };
+    Value *get_operand(unsigned i) const {
+        assert(i < num_operands_ && "get_operand out of index");
+        return operands_[i].value_;
+    };
     // start from 0
     void set_operand(unsigned i, Value *v);
     void add_operand(Value *v);
 
     void remove_all_operands();
     void remove_operand(unsigned i);
+    // used when the whole module is destroyed: unlike remove_all_operands,
+    // the use lists of the operands are cleared at once instead of one use
+    // at a time, and on_set_operand is not called
+    void drop_all_references();
 
-  private:
-    std::vector<Value *> operands_; // operands of this value
-};
+  protected:
+    // called after operand i changed from old_val: by set_operand, by
+    // add_operand with old_val nullptr, and by remove_operand and
+    // remove_all_operands with operand i nullptr, before the operands after
+    // it move down
+    virtual void on_set_operand(unsigned i, Value *old_val) {}
 
-/* For example: op = func(a, b)
- *  for a: Use(op, 0)
- *  for b: Use(op, 1)
- */
-struct Use {
-    User *val_;       // used by whom
-    unsigned arg_no_; // the no. of operand
-
-    Use(User *val, unsigned no) : val_(val), arg_no_(no) {}
+  private:
+    void move_use(Use &from, Use &to, unsigned arg_no);
 
-    bool operator==(const Use &other) const {
-        return val_ == other.val_ and arg_no_ == other.arg_no_;
-    }
+    // operands of this value, each one is also a node of a use list.
+    // The array comes from the arena of the module like the user itself;
+    // when it grows the old array is left in the arena
+    Use *operands_{nullptr};
+    unsigned num_operands_{0};
+    unsigned capacity_{0};
 };
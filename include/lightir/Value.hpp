@@ -1,60 +1,166 @@
 #pragma once
 
+#include "StringInterner.hpp"
+
+#include <cassert>
+#include <cstdint>
 #include <functional>
 #include <iostream>
-#include <list>
 #include <string>
-#include <cassert>
 
+class Module;
 class Type;
 class Value;
 class User;
-struct Use;
+
+/* For example: op = func(a, b)
+ *  for a: Use(op, 0)
+ *  for b: Use(op, 1)
+ * Use nodes live in the operand array of the user and are linked into the
+ * use list of the used value, so adding or removing a use is O(1).
+ */
+struct Use {
+    User *val_{nullptr};    // used by whom
+    unsigned arg_no_{0};    // the no. of operand
+    Value *value_{nullptr}; // the used value
+
+  private:
+    friend class Value;
+    friend class UseList;
+    Use *next_{nullptr};
+    Use **prev_{nullptr}; // the pointer pointing to this node
+};
+
+// iterable view of the use list of a value
+class UseList {
+  public:
+    class iterator {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Use;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Use *;
+        using reference = Use &;
+
+        explicit iterator(Use *use = nullptr) : use_(use) {}
+        Use &operator*() const { return *use_; }
+        Use *operator->() const { return use_; }
+        iterator &operator++();
+        bool operator==(const iterator &other) const {
+            return use_ == other.use_;
+        }
+        bool operator!=(const iterator &other) const {
+            return use_ != other.use_;
+        }
+
+      private:
+        Use *use_;
+    };
+
+    UseList(Use *head, unsigned size) : head_(head), size_(size) {}
+    iterator begin() const { return iterator(head_); }
+    iterator end() const { return iterator(); }
+    unsigned size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+  private:
+    Use *head_;
+    unsigned size_;
+};
 
 class Value {
   public:
-    explicit Value(Type *ty, const std::string &name = "")
-        : type_(ty), name_(name){};
+    // discriminator of the concrete class, checked by the classof of each
+    // subclass; instructions are further told apart by their OpID
+    enum ValueKind : uint8_t {
+        ArgumentVal,
+        BasicBlockVal,
+        FunctionVal,
+        // users
+        GlobalVariableVal,
+        ConstantIntVal,
+        ConstantFPVal,
+        ConstantArrayVal,
+        ConstantZeroVal,
+        InstructionVal,
+    };
+
+    // the name is interned in the module of ty
+    Value(ValueKind kind, Type *ty, const std::string &name = "");
     virtual ~Value() { replace_all_use_with(nullptr); }
 
-    std::string get_name() const { return name_; };
+    // IR objects are allocated from the arena of their module and released
+    // together with it, delete only runs the destructor
+    static void *operator new(size_t size, Module *m);
+    static void operator delete(void *ptr, Module *m) {}
+    static void operator delete(void *ptr) {}
+
+    std::string get_name() const { return name_.str(); };
+    // appends the name to out, without a temporary string
+    void append_name(std::string &out) const { name_.append_to(out); }
     Type *get_type() const { return type_; }
-    const std::list<Use> &get_use_list() const { return use_list_; }
+    ValueKind get_value_kind() const { return kind_; }
+    UseList get_use_list() const { return UseList(use_head_, num_uses_); }
+
+    // only names a value that has no name yet
+    bool set_name(const std::string &name);
+    bool set_name(Symbol name);
 
-    bool set_name(std::string name);
+    // link/unlink a use node owned by the user, use->value_ is this value
+    void add_use(Use *use);
+    void remove_use(Use *use);
 
-    void add_use(User *user, unsigned arg_no);
-    void remove_use(User *user, unsigned arg_no);
+    // forget all uses without updating the users, only valid when the users
+    // are dropped as well (see User::drop_all_references)
+    void drop_all_uses() {
+        use_head_ = nullptr;
+        num_uses_ = 0;
+    }
 
     void replace_all_use_with(Value *new_val);
     void replace_use_with_if(Value *new_val, std::function<bool(Use *)> pred);
 
     virtual std::string print() = 0;
 
-    template<typename T>
-    T *as()
-    {
-      static_assert(std::is_base_of<Value, T>::value, "T must be a subclass of Value");
-      const auto ptr = dynamic_cast<T*>(this);
-      assert(ptr && "dynamic_cast failed");
-      return ptr;
+    // checked casts based on T::classof, no RTTI involved
+    template <typename T> T *as() {
+        static_assert(std::is_base_of<Value, T>::value,
+                      "T must be a subclass of Value");
+        assert(T::classof(this) && "as<T>() on a value of another class");
+        return static_cast<T *>(this);
     }
-    template<typename T>
-    [[nodiscard]] const T* as() const {
-        static_assert(std::is_base_of<Value, T>::value, "T must be a subclass of Value");
-        const auto ptr = dynamic_cast<const T*>(this);
-        assert(ptr);
-        return ptr;
+    template <typename T> [[nodiscard]] const T *as() const {
+        static_assert(std::is_base_of<Value, T>::value,
+                      "T must be a subclass of Value");
+        assert(T::classof(this) && "as<T>() on a value of another class");
+        return static_cast<const T *>(this);
     }
     // is 接口
-    template <typename T>
-    [[nodiscard]] bool is() const {
-        static_assert(std::is_base_of<Value, T>::value, "T must be a subclass of Value");
-        return dynamic_cast<const T*>(this);
+    template <typename T> [[nodiscard]] bool is() const {
+        static_assert(std::is_base_of<Value, T>::value,
+                      "T must be a subclass of Value");
+        return T::classof(this);
     }
 
+  protected:
+    // Constants, globals and functions may be used from several functions.
+    // Function passes running in parallel edit their use lists concurrently,
+    // so add_use/remove_use lock them.
+    void set_module_level() { module_level_ = true; }
+
   private:
     Type *type_;
-    std::list<Use> use_list_; // who use this value
-    std::string name_;        // should we put name field here ?
+    Use *use_head_{nullptr}; // who use this value
+    unsigned num_uses_{0};
+    Symbol name_;
+    bool module_level_{false};
+    ValueKind kind_;
 };
+
+// dynamic_cast for the Value hierarchy, a null value gives nullptr
+template <typename T> T *dyn_cast(Value *v) {
+    return v and T::classof(v) ? static_cast<T *>(v) : nullptr;
+}
+template <typename T> const T *dyn_cast(const Value *v) {
+    return v and T::classof(v) ? static_cast<const T *>(v) : nullptr;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "PassManager.hpp"
+
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+enum class AliasResult { NoAlias, MayAlias, MustAlias };
+
+/**
+ * 基于基对象的别名分析。沿 GEP 链把指针追溯到它指向的对象
+ * （alloca、全局变量、形参，其它情况如从内存读出的指针记为未知），
+ * 并把地址拆成 基对象 + 常量偏移 + Σ 变量×步长：
+ * - 基对象不同：两个已知对象（alloca、全局变量）互不别名；
+ *   地址未被写入内存的 alloca 与形参、未知指针也互不别名
+ * - 基对象相同且变量部分相同：按常量偏移和访问大小判断
+ * - 其余情况为 MayAlias
+ * 变量相同时按同一次执行的取值比较，与 SSA 值的含义一致
+ */
+class AliasAnalysis : public FunctionPass {
+  public:
+    explicit AliasAnalysis(Module *m) : FunctionPass(m) {}
+    ~AliasAnalysis() = default;
+    std::string get_name() const override { return "AliasAnalysis"; }
+    void run_on_func(Function *f) override;
+    PreservedAnalyses get_preserved_analyses() const override {
+        return PreservedAnalyses::all();
+    }
+
+    std::unique_ptr<FunctionPass> clone() const override {
+        return std::make_unique<AliasAnalysis>(m_);
+    }
+
+    // 指针指向的对象
+    static Value *get_underlying_object(Value *ptr);
+
+    // p1、p2 按各自指向的类型访问时是否重叠
+    AliasResult alias(Value *p1, Value *p2);
+    // inst 是否可能写 ptr 指向的内存，调用按被调函数的摘要判断
+    bool may_modify(Instruction *inst, Value *ptr);
+    // inst 是否可能写 ptr 所在对象的任意位置
+    bool may_modify_object(Instruction *inst, Value *ptr);
+    // ptr 是否一定落在 alloca 或全局变量之内，即可以提前读取
+    bool is_dereferenceable(Value *ptr);
+
+  private:
+    // 基对象 + 常量偏移 + Σ 变量×步长，偏移以字节计
+    struct Location {
+        Value *base;
+        long offset{0};
+        std::vector<std::pair<Value *, long>> terms{};
+    };
+
+    static Location decompose(Value *ptr);
+    static Value *get_stored_object(AllocaInst *slot);
+    static bool is_identified_object(Value *base);
+    bool may_be_same_object(Value *base1, Value *base2);
+
+    // 地址逃逸的 alloca
+    std::unordered_set<Value *> escaped_{};
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Module.hpp"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <typeindex>
+#include <unordered_map>
+
+class Pass;
+
+/**
+ * pass 执行后仍然有效的分析集合。
+ * PassManager 在每个 pass 结束后，使未被保留的分析结果失效
+ */
+class PreservedAnalyses {
+  public:
+    static PreservedAnalyses all() {
+        PreservedAnalyses pa;
+        pa.all_ = true;
+        return pa;
+    }
+    static PreservedAnalyses none() { return PreservedAnalyses(); }
+
+    template <typename AnalysisType> PreservedAnalyses &preserve() {
+        preserved_.insert(typeid(AnalysisType));
+        return *this;
+    }
+    bool is_preserved(std::type_index id) const {
+        return all_ or preserved_.count(id) != 0;
+    }
+
+  private:
+    bool all_{false};
+    std::set<std::type_index> preserved_;
+};
+
+/**
+ * 缓存分析结果，供各 pass 共享：
+ * - 函数级分析（Dominators、LoopDetection）按函数缓存，
+ *   由 get_result<T>(f) 获取，分析对象只对 f 执行 run_on_func
+ * - 模块级分析（CallGraph、FuncInfo）由 get_result<T>() 获取
+ * 结果在失效前一直有效，因此 pass 修改 IR 后需要声明保留哪些分析，
+ * 或者调用 invalidate 使受影响函数的结果失效。
+ * 并行执行 FunctionPass 时，各线程处理不同的函数，
+ * 缓存表本身由互斥锁保护，分析的计算在锁外进行
+ */
+class AnalysisManager {
+  public:
+    explicit AnalysisManager(Module *m) : m_(m) {}
+    ~AnalysisManager();
+
+    template <typename AnalysisType> AnalysisType *get_result(Function *f) {
+        std::type_index id = typeid(AnalysisType);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto &results = func_results_[id];
+            auto it = results.find(f);
+            if (it != results.end())
+                return static_cast<AnalysisType *>(it->second.get());
+        }
+        auto result = std::make_unique<AnalysisType>(m_);
+        result->set_analysis_manager(this);
+        result->run_on_func(f);
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto &slot = func_results_[id][f];
+        if (not slot)
+            slot = std::move(result);
+        return static_cast<AnalysisType *>(slot.get());
+    }
+
+    // f 上已缓存的结果，没有时返回 nullptr 而不计算，
+    // 供修改 CFG 的 pass 增量更新仍然缓存的分析
+    template <typename AnalysisType>
+    AnalysisType *get_cached_result(Function *f) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto &results = func_results_[typeid(AnalysisType)];
+        auto it = results.find(f);
+        if (it == results.end())
+            return nullptr;
+        return static_cast<AnalysisType *>(it->second.get());
+    }
+
+    template <typename AnalysisType> AnalysisType *get_result() {
+        std::type_index id = typeid(AnalysisType);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = module_results_.find(id);
+            if (it != module_results_.end())
+                return static_cast<AnalysisType *>(it->second.get());
+        }
+        auto result = std::make_unique<AnalysisType>(m_);
+        result->set_analysis_manager(this);
+        result->run();
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto &slot = module_results_[id];
+        if (not slot)
+            slot = std::move(result);
+        return static_cast<AnalysisType *>(slot.get());
+    }
+
+    // 使 f 上未被保留的函数级分析失效，用于 pass 只修改了部分函数的 CFG
+    void invalidate(Function *f, const PreservedAnalyses &pa);
+    // 使所有未被保留的分析失效，并重新编号没有缓存分析的函数
+    void invalidate(const PreservedAnalyses &pa);
+
+  private:
+    Module *m_;
+    std::mutex mutex_;
+    std::map<std::type_index,
+             std::unordered_map<Function *, std::unique_ptr<Pass>>>
+        func_results_;
+    std::map<std::type_index, std::unique_ptr<Pass>> module_results_;
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * 定长位向量，数据流分析中的集合。按 64 位字存放，集合运算逐字
+ * 进行，编译目标支持时使用 SSE2/AVX2 一次处理多个字（见 BitVector.cpp）。
+ * 二元运算要求两个位向量长度相同，超出 size() 的位始终为 0
+ */
+class BitVector {
+  public:
+    using Word = uint64_t;
+    static constexpr unsigned word_bits = 64;
+
+    BitVector() = default;
+    explicit BitVector(unsigned size, bool value = false)
+        : size_(size), words_((size + word_bits - 1) / word_bits) {
+        if (value)
+            set_all();
+    }
+
+    unsigned size() const { return size_; }
+    bool test(unsigned i) const {
+        return words_[i / word_bits] >> (i % word_bits) & 1;
+    }
+    void set(unsigned i) {
+        words_[i / word_bits] |= Word(1) << (i % word_bits);
+    }
+    void reset(unsigned i) {
+        words_[i / word_bits] &= ~(Word(1) << (i % word_bits));
+    }
+    void set_all();
+    void reset_all();
+    bool any() const;
+    unsigned count() const;
+    // 不小于 i 的第一个为 1 的位，没有时返回 size()
+    unsigned find_next(unsigned i) const;
+
+    // 以下运算返回 *this 是否发生变化
+    bool union_with(const BitVector &other);     // *this |= other
+    bool intersect_with(const BitVector &other); // *this &= other
+    bool subtract(const BitVector &other);       // *this &= ~other
+    // *this = gen | (in & ~kill)，位向量数据流的传递函数
+    bool assign_transfer(const BitVector &gen, const BitVector &in,
+                         const BitVector &kill);
+
+    bool operator==(const BitVector &other) const {
+        return size_ == other.size_ and words_ == other.words_;
+    }
+    bool operator!=(const BitVector &other) const {
+        return not(*this == other);
+    }
+
+    // 按从小到大的顺序对每个为 1 的位调用 f
+    template <typename F> void for_each(F f) const {
+        for (unsigned w = 0; w < words_.size(); w++) {
+            for (auto word = words_[w]; word; word &= word - 1)
+                f(w * word_bits + __builtin_ctzll(word));
+        }
+    }
+
+  private:
+    unsigned size_{0};
+    std::vector<Word> words_;
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "PassManager.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+/**
+ * 模块的调用图：每个函数的调用点、被调函数与调用者，
+ * 以及 Tarjan 算法求出的强连通分量。分量按自底向上的顺序排列，
+ * 被调函数所在的分量总在调用者之前，过程间分析按此顺序扫描一遍即可，
+ * 只有递归的分量需要在分量内迭代
+ */
+class CallGraph : public Pass {
+  public:
+    using FuncList = std::vector<Function *>;
+
+    explicit CallGraph(Module *m) : Pass(m) {}
+
+    void run();
+    std::string get_name() const override { return "CallGraph"; }
+    PreservedAnalyses get_preserved_analyses() const override {
+        return PreservedAnalyses::all();
+    }
+
+    // func 中的调用指令，按在函数中的顺序排列
+    const std::vector<CallInst *> &get_call_sites(Function *func) const {
+        return call_sites_.at(func);
+    }
+    // 不重复，按第一次调用的顺序排列
+    const FuncList &get_callees(Function *func) const {
+        return callees_.at(func);
+    }
+    // 不重复，按函数在模块中的顺序排列
+    const FuncList &get_callers(Function *func) const {
+        return callers_.at(func);
+    }
+    const std::vector<FuncList> &get_sccs() const { return sccs_; }
+    unsigned get_scc_index(Function *func) const { return scc_index_.at(func); }
+    // 所在分量有多个函数，或者直接调用自身
+    bool is_recursive(Function *func) const { return recursive_.at(func); }
+
+  private:
+    void compute_sccs();
+
+    std::unordered_map<Function *, std::vector<CallInst *>> call_sites_;
+    std::unordered_map<Function *, FuncList> callees_;
+    std::unordered_map<Function *, FuncList> callers_;
+    std::vector<FuncList> sccs_;
+    std::unordered_map<Function *, unsigned> scc_index_;
+    std::unordered_map<Function *, bool> recursive_;
+};
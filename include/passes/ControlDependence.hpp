@@ -0,0 +1,38 @@
+#pragma once
+
+#include "BasicBlock.hpp"
+#include "DenseIndexMap.hpp"
+#include "PassManager.hpp"
+
+/**
+ * 控制依赖图：Y 控制依赖于 X，当且仅当 X 末尾的分支
+ * 决定 Y 是否执行，即 X 在 Y 的后必经边界中（见 PostDominators）。
+ * 结果按基本块的稠密编号存放，两个方向的边都按基本块在函数中的顺序排列
+ */
+class ControlDependence : public FunctionPass {
+  public:
+    using BBList = BasicBlock::BBList;
+
+    explicit ControlDependence(Module *m) : FunctionPass(m) {}
+    ~ControlDependence() = default;
+    std::string get_name() const override { return "ControlDependence"; }
+    void run_on_func(Function *f) override;
+    PreservedAnalyses get_preserved_analyses() const override {
+        return PreservedAnalyses::all();
+    }
+
+    std::unique_ptr<FunctionPass> clone() const override {
+        return std::make_unique<ControlDependence>(m_);
+    }
+
+    // bb 控制依赖的基本块
+    const BBList &get_controllers(BasicBlock *bb) {
+        return controllers_.at(bb);
+    }
+    // 控制依赖于 bb 的基本块
+    const BBList &get_dependents(BasicBlock *bb) { return dependents_.at(bb); }
+
+  private:
+    DenseBlockMap<BBList> controllers_{};
+    DenseBlockMap<BBList> dependents_{};
+};
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "BasicBlock.hpp"
+#include "BitVector.hpp"
+#include "DenseIndexMap.hpp"
+#include "Function.hpp"
+
+#include <algorithm>
+#include <vector>
+
+enum class DataFlowDirection { Forward, Backward };
+enum class DataFlowMeet { Union, Intersect };
+
+/**
+ * 以基本块为单位的位向量数据流求解器。
+ * 使用者为每个基本块填好 gen/kill（以及需要时的 edge_gen）后调用 solve。
+ * - 前向问题：in 为各前驱 out 的交汇，out = gen ∪ (in − kill)
+ * - 后向问题：out 为各后继 in 的交汇，in = gen ∪ (out − kill)
+ * 基本块按逆后序排列（后向问题为后序），工作表按这个顺序轮流扫描，
+ * 结果变化时再把受影响的基本块放回工作表。
+ * 集合运算见 BitVector，逐字并行计算
+ */
+template <DataFlowDirection direction, DataFlowMeet meet>
+class BitVectorDataFlow {
+  public:
+    BitVectorDataFlow(Function *f, unsigned num_bits)
+        : func_(f), boundary_(num_bits) {
+        auto num_blocks = f->get_num_block_indices();
+        for (auto map : {&gen_, &kill_, &edge_gen_, &in_, &out_})
+            map->reset(num_blocks);
+        // 交集问题从全集开始向下求不动点
+        BitVector init(num_bits, meet == DataFlowMeet::Intersect);
+        for (auto &bb : f->get_basic_blocks()) {
+            gen_[&bb] = kill_[&bb] = edge_gen_[&bb] = BitVector(num_bits);
+            in_[&bb] = out_[&bb] = init;
+        }
+    }
+
+    BitVector &gen(BasicBlock *bb) { return gen_[bb]; }
+    BitVector &kill(BasicBlock *bb) { return kill_[bb]; }
+    // 交汇后、传递前并入的位，用于只在某些边上成立的事实，
+    // 例如后向活跃分析中后继的 phi 对从 bb 流入的值的使用
+    BitVector &edge_gen(BasicBlock *bb) { return edge_gen_[bb]; }
+    // 没有前驱（后向问题为没有后继）的基本块的交汇结果，默认为空集
+    void set_boundary(const BitVector &boundary) { boundary_ = boundary; }
+
+    void solve();
+
+    const BitVector &get_in(BasicBlock *bb) const { return in_.at(bb); }
+    const BitVector &get_out(BasicBlock *bb) const { return out_.at(bb); }
+    DenseBlockMap<BitVector> &get_in() { return in_; }
+    DenseBlockMap<BitVector> &get_out() { return out_; }
+    // 求解过程中计算传递函数的次数
+    unsigned get_num_visits() const { return num_visits_; }
+
+  private:
+    static constexpr bool forward = direction == DataFlowDirection::Forward;
+
+    void compute_order();
+
+    Function *func_;
+    BitVector boundary_;
+    DenseBlockMap<BitVector> gen_, kill_, edge_gen_, in_, out_;
+    std::vector<BasicBlock *> order_{}; // 扫描工作表的顺序
+    DenseBlockMap<unsigned int> position_{}; // 基本块在 order_ 中的位置
+    unsigned num_visits_{0};
+};
+
+/**
+ *!@brief 计算扫描工作表的顺序
+ *
+ * 从入口出发用显式栈深度优先遍历得到逆后序，不可达的基本块按在函数中的
+ * 顺序排在最后；后向问题把整个顺序反过来。
+ */
+template <DataFlowDirection direction, DataFlowMeet meet>
+void BitVectorDataFlow<direction, meet>::compute_order() {
+    DenseBlockMap<bool> visited(func_->get_num_block_indices());
+    std::vector<std::pair<BasicBlock *, unsigned>> stack;
+    auto entry = func_->get_entry_block();
+    visited[entry] = true;
+    stack.emplace_back(entry, 0);
+    while (not stack.empty()) {
+        auto &[bb, next] = stack.back();
+        auto &succs = bb->get_succ_basic_blocks();
+        if (next < succs.size()) {
+            auto succ = succs[next++];
+            if (not visited[succ]) {
+                visited[succ] = true;
+                stack.emplace_back(succ, 0);
+            }
+            continue;
+        }
+        order_.push_back(bb);
+        stack.pop_back();
+    }
+    if (forward)
+        std::reverse(order_.begin(), order_.end());
+    std::vector<BasicBlock *> unreachable;
+    for (auto &bb : func_->get_basic_blocks()) {
+        if (not visited[&bb])
+            unreachable.push_back(&bb);
+    }
+    if (not forward)
+        std::reverse(unreachable.begin(), unreachable.end());
+    order_.insert(forward ? order_.end() : order_.begin(), unreachable.begin(),
+                  unreachable.end());
+    position_.reset(func_->get_num_block_indices());
+    for (unsigned i = 0; i < order_.size(); i++)
+        position_[order_[i]] = i;
+}
+
+/**
+ *!@brief 用工作表算法求解数据流方程
+ *
+ * 工作表为按位置索引的位向量，按位置从前往后轮流扫描，初始时所有基本块
+ * 都在工作表中。对取出的基本块先交汇得到其输入，再用传递函数更新输出，
+ * 输出变化时把后继（后向问题为前驱）放回工作表。位置在当前基本块之前的
+ * 要等到下一轮扫描才处理：回边带来的变化攒到下一轮一起传播，不会每个
+ * 循环都把其后的整段代码重算一遍，轮数与迭代算法相同。
+ */
+template <DataFlowDirection direction, DataFlowMeet meet>
+void BitVectorDataFlow<direction, meet>::solve() {
+    compute_order();
+    BitVector pending(order_.size(), true);
+    for (unsigned pos = 0; pos != order_.size();) {
+        auto bb = order_[pos];
+        pending.reset(pos);
+        num_visits_++;
+
+        auto &sources = forward ? bb->get_pre_basic_blocks()
+                                : bb->get_succ_basic_blocks();
+        auto &met = forward ? in_[bb] : out_[bb];
+        if (sources.empty()) {
+            met = boundary_;
+        } else {
+            met = forward ? out_[sources[0]] : in_[sources[0]];
+            for (unsigned i = 1; i < sources.size(); i++) {
+                auto &val = forward ? out_[sources[i]] : in_[sources[i]];
+                if (meet == DataFlowMeet::Union)
+                    met.union_with(val);
+                else
+                    met.intersect_with(val);
+            }
+        }
+        met.union_with(edge_gen_[bb]);
+
+        auto &result = forward ? out_[bb] : in_[bb];
+        if (result.assign_transfer(gen_[bb], met, kill_[bb])) {
+            for (auto target : forward ? bb->get_succ_basic_blocks()
+                                       : bb->get_pre_basic_blocks())
+                pending.set(position_[target]);
+        }
+        pos = pending.find_next(pos + 1);
+        // 扫描到末尾，从头开始下一轮
+        if (pos == order_.size())
+            pos = pending.find_next(0);
+    }
+}
@@ -1,28 +1,68 @@
 #pragma once
 
+#include "ControlDependence.hpp"
+#include "DenseIndexMap.hpp"
+#include "Dominators.hpp"
 #include "FuncInfo.hpp"
+#include "LoopDetection.hpp"
 #include "PassManager.hpp"
+#include "PostDominators.hpp"
 
+#include <deque>
 #include <unordered_set>
 
 /**
  * 死代码消除：参见
  *https://www.clear.rice.edu/comp512/Lectures/10Dead-Clean-SCCP.pdf
+ * aggressive 模式下分支不再总是有用：只有有用指令所在的基本块
+ * 控制依赖于它时才有用，无用的分支改为跳转到最近的有用后必经结点，
+ * 整个无用的 if 区域和循环随之变为不可达而被删除。
+ * 这假定能够到达 ret 的循环都会终止，只有到不了 ret 的死循环被保留
  **/
-class DeadCode : public Pass {
+class DeadCode : public FunctionPass {
   public:
-    DeadCode(Module *m) : Pass(m), func_info(std::make_shared<FuncInfo>(m)) {}
+    DeadCode(Module *m, bool aggressive = false)
+        : FunctionPass(m), aggressive_(aggressive) {}
 
-    void run();
+    void init() override;
+    void run_on_func(Function *func) override;
+    void finish() override;
+    std::string get_name() const override { return "DeadCode"; }
+    // 删除基本块或改写分支的函数已在 run_on_func 中使其 CFG 分析失效；
+    // 删除无用的全局变量 load 可能使函数变为纯函数，FuncInfo 需要重新计算
+    PreservedAnalyses get_preserved_analyses() const override {
+        return PreservedAnalyses::none()
+            .preserve<Dominators>()
+            .preserve<PostDominators>()
+            .preserve<ControlDependence>()
+            .preserve<LoopDetection>();
+    }
+
+    // 副本共享同一份 FuncInfo 结果
+    std::unique_ptr<FunctionPass> clone() const override {
+        auto worker = std::make_unique<DeadCode>(m_, aggressive_);
+        worker->func_info = func_info;
+        return worker;
+    }
+    void merge(FunctionPass *worker) override {
+        ins_count += static_cast<DeadCode *>(worker)->ins_count;
+    }
 
   private:
-    std::shared_ptr<FuncInfo> func_info;
+    bool aggressive_;
+    FuncInfo *func_info;
+    // aggressive 模式下使用
+    PostDominators *post_dominators{nullptr};
+    ControlDependence *control_dependence{nullptr};
+    DenseBlockMap<bool> live_blocks{}; // 含有有用指令的基本块
     int ins_count{0}; // 用以衡量死代码消除的性能
     std::deque<Instruction *> work_list{};
-    std::unordered_map<Instruction *, bool> marked{};
+    DenseInstMap<bool> marked{}; // 以指令在函数内的编号为下标
 
     void mark(Function *func);
     void mark(Instruction *ins);
+    void mark_live(Instruction *ins);
+    bool redirect_dead_branches(Function *func);
     bool sweep(Function *func);
     bool clear_basic_blocks(Function *func);
     bool is_critical(Instruction *ins);
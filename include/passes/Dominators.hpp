@@ -1,26 +1,47 @@
 #pragma once
 
 #include "BasicBlock.hpp"
+#include "DenseIndexMap.hpp"
 #include "PassManager.hpp"
 
-#include <map>
-#include <set>
+#include <functional>
+#include <vector>
 
-class Dominators : public Pass {
+/**
+ * 支配关系分析。结果按基本块的稠密编号存放（见 DenseBlockMap），
+ * 只对应最近一次 run_on_func 的函数，由 AnalysisManager 按函数缓存
+ */
+class Dominators : public FunctionPass {
   public:
-    using BBSet = std::set<BasicBlock *>;
+    // 支配边界按基本块在函数中的顺序排列
+    using BBList = BasicBlock::BBList;
 
-    explicit Dominators(Module *m) : Pass(m) {}
+    explicit Dominators(Module *m) : FunctionPass(m) {}
     ~Dominators() = default;
-    void run() override;
-    void run_on_func(Function *f);
+    std::string get_name() const override { return "Dominators"; }
+    void run_on_func(Function *f) override;
+    PreservedAnalyses get_preserved_analyses() const override {
+        return PreservedAnalyses::all();
+    }
+
+    std::unique_ptr<FunctionPass> clone() const override {
+        return std::make_unique<Dominators>(m_);
+    }
+
+    // 计算直接支配者的算法，Auto 在可达基本块不少于
+    // semi_nca_threshold 个时使用 Semi-NCA，否则使用迭代算法
+    enum class Algorithm { Auto, Iterative, SemiNCA };
+    static constexpr unsigned semi_nca_threshold = 256;
+    void set_algorithm(Algorithm algorithm) { algorithm_ = algorithm; }
 
     // functions for getting information
     BasicBlock *get_idom(BasicBlock *bb) { return idom_.at(bb); }
-    const BBSet &get_dominance_frontier(BasicBlock *bb) {
+    const BBList &get_dominance_frontier(BasicBlock *bb) {
+        if (not frontier_valid_)
+            create_dominance_frontier(func_);
         return dom_frontier_.at(bb);
     }
-    const BBSet &get_dom_tree_succ_blocks(BasicBlock *bb) {
+    const BBList &get_dom_tree_succ_blocks(BasicBlock *bb) {
         return dom_tree_succ_blocks_.at(bb);
     }
 
@@ -30,57 +51,93 @@ class Dominators : public Pass {
 
     // functions for dominance tree
     const bool is_dominate(BasicBlock *bb1, BasicBlock *bb2) {
+        if (not dom_order_valid_)
+            create_dom_dfs_order(func_);
         return dom_tree_L_.at(bb1) <= dom_tree_L_.at(bb2) &&
                dom_tree_R_.at(bb1) >= dom_tree_L_.at(bb2);
     }
 
     const std::vector<BasicBlock *> &get_dom_dfs_order() {
+        if (not dom_order_valid_)
+            create_dom_dfs_order(func_);
         return dom_dfs_order_;
     }
 
     const std::vector<BasicBlock *> &get_dom_post_order() {
+        if (not dom_order_valid_)
+            create_dom_dfs_order(func_);
         return dom_post_order_;
     }
 
+    // 增量更新：修改 CFG 后调用，每次调用对应一处已完成的修改，
+    // 按修改的先后顺序调用。直接支配者、支配树和层数立即更新，
+    // 支配树的DFS序和支配边界在下次查询时重新计算
+    // 加入了边 from->to
+    void insert_edge(BasicBlock *from, BasicBlock *to);
+    // 删除了边 from->to
+    void delete_edge(BasicBlock *from, BasicBlock *to);
+    // 新建的 bb 跳转到唯一的后继，后继的部分入边已改为进入 bb，
+    // 即拆分了这些边
+    void insert_block(BasicBlock *bb);
+    // 即将删除不可达的 bb，进入 bb 的边应已删除
+    void remove_block(BasicBlock *bb);
+
   private:
 
-    void dfs(BasicBlock *bb, std::set<BasicBlock *> &visited);
+    void run_dfs(BasicBlock *root,
+                 const std::function<bool(BasicBlock *)> &descend);
+    void clear_dfs();
     void create_idom(Function *f);
+    void semi_nca();
     void create_dominance_frontier(Function *f);
     void create_dom_tree_succ(Function *f);
     void create_dom_dfs_order(Function *f);
 
-    BasicBlock * intersect(BasicBlock *b1, BasicBlock *b2);
+    static unsigned intersect(const std::vector<unsigned> &doms, unsigned b1,
+                              unsigned b2);
 
-    void create_reverse_post_order(Function *f);
     void set_idom(BasicBlock *bb, BasicBlock *idom) { idom_[bb] = idom; }
-    void set_dominance_frontier(BasicBlock *bb, BBSet &df) {
-        dom_frontier_[bb].clear();
-        dom_frontier_[bb].insert(df.begin(), df.end());
-    }
     void add_dom_tree_succ_block(BasicBlock *bb, BasicBlock *dom_tree_succ_bb) {
-        dom_tree_succ_blocks_[bb].insert(dom_tree_succ_bb);
-    }
-    unsigned int get_post_order(BasicBlock *bb) {
-        return post_order_.at(bb);
+        dom_tree_succ_blocks_[bb].push_back(dom_tree_succ_bb);
     }
     // for debug
     void print_idom(Function *f);
     void print_dominance_frontier(Function *f);
 
-    // TODO 补充需要的函数
-    std::list<BasicBlock *> reverse_post_order_{};
-    std::map<BasicBlock *, int> post_order_id_{}; // the root has highest ID
-
-    std::vector<BasicBlock *> post_order_vec_{}; // 逆后序
-    std::map<BasicBlock *, unsigned int> post_order_{}; // 逆后序
-    std::map<BasicBlock *, BasicBlock *> idom_{};  // 直接支配
-    std::map<BasicBlock *, BBSet> dom_frontier_{}; // 支配边界集合
-    std::map<BasicBlock *, BBSet> dom_tree_succ_blocks_{}; // 支配树中的后继节点
+    // 增量更新使用
+    bool is_reachable(BasicBlock *bb) { return get_idom(bb) != nullptr; }
+    BasicBlock *nca(BasicBlock *b1, BasicBlock *b2);
+    bool dominates(BasicBlock *bb1, BasicBlock *bb2);
+    void reparent(BasicBlock *bb, BasicBlock *idom);
+    void update_levels(BasicBlock *root);
+    void insert_reachable_edge(BasicBlock *from, BasicBlock *to);
+    void insert_unreachable_edge(BasicBlock *from, BasicBlock *to);
+    void delete_unreachable(BasicBlock *to);
+    void rebuild_subtree(BasicBlock *d);
+
+    Function *func_{nullptr};
+    Algorithm algorithm_{Algorithm::Auto};
+
+    // run_dfs 的结果，在两次遍历之间清空
+    std::vector<BasicBlock *> pre_order_vec_{}; // 先序
+    DenseBlockMap<unsigned int> pre_order_{}; // 从 1 开始的先序号，0 表示未访问
+    std::vector<unsigned int> pre_order_parent_{}; // DFS 树上父节点的先序号
+    std::vector<BasicBlock *> post_order_vec_{}; // 后序
+    DenseBlockMap<unsigned int> post_order_{}; // 后序号
+    std::vector<unsigned int> semi_idom_{}; // semi_nca 求出的直接支配者先序号
+
+    DenseBlockMap<BasicBlock *> idom_{};  // 直接支配
+    DenseBlockMap<BBList> dom_tree_succ_blocks_{}; // 支配树中的后继节点
+    DenseBlockMap<unsigned int> dom_tree_level_{}; // 支配树上的层数
+    DenseBlockMap<bool> marked_{}; // 增量更新时的访问标记，用后清空
+
+    bool frontier_valid_{false};
+    DenseBlockMap<BBList> dom_frontier_{}; // 支配边界集合
 
     // 支配树上的dfs序L,R
-    std::map<BasicBlock *, unsigned int> dom_tree_L_;
-    std::map<BasicBlock *, unsigned int> dom_tree_R_;
+    bool dom_order_valid_{false};
+    DenseBlockMap<unsigned int> dom_tree_L_;
+    DenseBlockMap<unsigned int> dom_tree_R_;
 
     std::vector<BasicBlock *> dom_dfs_order_;
     std::vector<BasicBlock *> dom_post_order_;
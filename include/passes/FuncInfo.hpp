@@ -1,35 +1,69 @@
 #pragma once
 
+#include "GlobalVariable.hpp"
 #include "PassManager.hpp"
 #include "logging.hpp"
 
-#include <deque>
+#include <set>
 #include <unordered_map>
+#include <vector>
 
 /**
- * 计算哪些函数是纯函数
- * WARN:
- * 假定所有函数都是纯函数，除非他写入了全局变量、修改了传入的数组、或者直接间接调用了非纯函数
+ * 函数的内存访问摘要：读写了哪些形参指向的内存和全局变量、形参是否逃逸、
+ * 是否调用 input/output 等运行时函数。按调用图（见 CallGraph）的强连通分量
+ * 自底向上计算，分量内迭代到不动点，调用点上把被调函数的摘要映射到
+ * 实参所指的对象。
+ * 含循环或递归的函数可能不返回，记为 may_trap，外提调用时需要考虑
+ * WARN: has_side_effect 不考虑 may_trap，删除无用调用时仍假定函数总会返回
  */
 class FuncInfo : public Pass {
   public:
+    // 对一块内存的访问方式，可按位组合
+    enum ModRef : unsigned { NoModRef = 0, Ref = 1, Mod = 2, ModRef = 3 };
+
+    struct Summary {
+        std::vector<unsigned> args{};     // 每个形参指向的内存的 ModRef
+        std::vector<bool> escaped_args{}; // 形参指针被写入内存
+        std::set<GlobalVariable *> read_globals{};
+        std::set<GlobalVariable *> written_globals{};
+        // 无法确定指向哪个对象的内存
+        bool reads_unknown{false};
+        bool writes_unknown{false};
+        // 可能调用运行时函数（输入输出、下标越界时退出）
+        bool calls_io{false};
+        // 可能陷入或不返回：除数不是非零常数的 sdiv、循环、递归，
+        // 或调用了这样的函数
+        bool may_trap{false};
+
+        bool operator==(const Summary &other) const;
+        bool operator!=(const Summary &other) const {
+            return not(*this == other);
+        }
+    };
+
     FuncInfo(Module *m) : Pass(m) {}
 
     void run();
+    std::string get_name() const override { return "FuncInfo"; }
+    PreservedAnalyses get_preserved_analyses() const override {
+        return PreservedAnalyses::all();
+    }
 
-    bool is_pure_function(Function *func) const { return is_pure.at(func); }
+    const Summary &get_summary(Function *func) const {
+        return summaries.at(func);
+    }
+    // 不访问自身栈帧以外的内存，也不调用运行时函数，可以任意移动或删除
+    bool is_pure_function(Function *func) const;
+    // 写了栈帧以外的内存或调用运行时函数，结果无用时调用也不能删除
+    bool has_side_effect(Function *func) const;
 
   private:
-    std::deque<Function *> worklist;
-    std::unordered_map<Function *, bool> is_pure;
-
-    void trivial_mark(Function *func);
-    void process(Function *func);
-    Value *get_first_addr(Value *val);
+    std::unordered_map<Function *, Summary> summaries;
 
-    bool is_side_effect_inst(Instruction *inst);
-    bool is_local_load(LoadInst *inst);
-    bool is_local_store(StoreInst *inst);
+    void summarize_declaration(Function *func);
+    Summary summarize(Function *func);
+    void add_access(Summary &summary, Value *ptr, unsigned mod_ref);
+    void add_call(Summary &summary, CallInst *call);
 
     void log();
 };
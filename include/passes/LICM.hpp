@@ -1,24 +1,40 @@
+#include "AliasAnalysis.hpp"
 #include "FuncInfo.hpp"
 #include "LoopDetection.hpp"
 #include "PassManager.hpp"
 #include <memory>
 #include <unordered_map>
 
-class LoopInvariantCodeMotion : public Pass {
+class LoopInvariantCodeMotion : public FunctionPass {
   public:
-    LoopInvariantCodeMotion(Module *m) : Pass(m) {}
+    LoopInvariantCodeMotion(Module *m) : FunctionPass(m) {}
     ~LoopInvariantCodeMotion() = default;
 
-    void run() override;
+    void init() override;
+    void run_on_func(Function *f) override;
+    std::string get_name() const override { return "LICM"; }
+    // 插入 preheader 的函数已在 run_on_func 中使其 CFG 分析失效
+    PreservedAnalyses get_preserved_analyses() const override {
+        return PreservedAnalyses::none()
+            .preserve<FuncInfo>()
+            .preserve<AliasAnalysis>()
+            .preserve<Dominators>()
+            .preserve<LoopDetection>();
+    }
+
+    // 副本共享同一份 FuncInfo 结果
+    std::unique_ptr<FunctionPass> clone() const override {
+        auto worker = std::make_unique<LoopInvariantCodeMotion>(m_);
+        worker->func_info_ = func_info_;
+        return worker;
+    }
 
   private:
     std::unordered_map<std::shared_ptr<Loop>, bool> is_loop_done_;
-    std::unique_ptr<LoopDetection> loop_detection_;
-    std::unique_ptr<FuncInfo> func_info_;
+    FuncInfo *func_info_;
     void traverse_loop(std::shared_ptr<Loop> loop);
     void run_on_loop(std::shared_ptr<Loop> loop);
     void collect_loop_info(std::shared_ptr<Loop> loop,
-                          std::set<Value *> &loop_instructions,
-                          std::set<Value *> &updated_global,
-                          bool &contains_impure_call);
+                           std::set<Value *> &loop_instructions,
+                           std::vector<Instruction *> &memory_writes);
 };
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "BitVector.hpp"
+#include "DenseIndexMap.hpp"
+#include "PassManager.hpp"
+
+#include <vector>
+
+/**
+ * 活跃变量分析，在 BitVectorDataFlow 上求解的后向并集问题。
+ * 只跟踪在定值的基本块之外被使用（包括被 phi 使用）的指令，
+ * 其余的值不会在任何基本块的入口或出口活跃；位向量以这些值的
+ * 稠密编号为下标，基本块很多时集合也只有跨块的值那么长。
+ * phi 在其所在基本块入口定值，它对某个前驱流入的值的使用
+ * 计入该前驱的出口处活跃，而不计入 phi 所在基本块的入口处活跃
+ */
+class Liveness : public FunctionPass {
+  public:
+    explicit Liveness(Module *m) : FunctionPass(m) {}
+    ~Liveness() = default;
+    std::string get_name() const override { return "Liveness"; }
+    void run_on_func(Function *f) override;
+    PreservedAnalyses get_preserved_analyses() const override {
+        return PreservedAnalyses::all();
+    }
+
+    std::unique_ptr<FunctionPass> clone() const override {
+        return std::make_unique<Liveness>(m_);
+    }
+
+    const BitVector &get_live_in(BasicBlock *bb) { return live_in_.at(bb); }
+    const BitVector &get_live_out(BasicBlock *bb) { return live_out_.at(bb); }
+    bool is_live_in(Instruction *inst, BasicBlock *bb) {
+        auto bit = bits_.at(inst);
+        return bit != 0 and get_live_in(bb).test(bit - 1);
+    }
+    bool is_live_out(Instruction *inst, BasicBlock *bb) {
+        auto bit = bits_.at(inst);
+        return bit != 0 and get_live_out(bb).test(bit - 1);
+    }
+    // 位向量中的下标对应的指令
+    Instruction *get_value(unsigned bit) { return values_[bit]; }
+    unsigned get_num_values() const { return values_.size(); }
+
+  private:
+    std::vector<Instruction *> values_{};
+    DenseInstMap<unsigned int> bits_{}; // 下标加 1，0 表示不跟踪
+    DenseBlockMap<BitVector> live_in_{};
+    DenseBlockMap<BitVector> live_out_{};
+};
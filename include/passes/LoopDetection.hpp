@@ -43,10 +43,9 @@ class Loop {
     void add_latch(BasicBlock *bb) { latches_.insert(bb); }
 };
 
-class LoopDetection : public Pass {
+class LoopDetection : public FunctionPass {
   private:
     Function *func_;
-    std::unique_ptr<Dominators> dominators_;
     std::vector<std::shared_ptr<Loop>> loops_;
     // map from header to loop
     std::unordered_map<BasicBlock *, std::shared_ptr<Loop>> bb_to_loop_;
@@ -54,11 +53,19 @@ class LoopDetection : public Pass {
                                      std::shared_ptr<Loop> loop);
 
   public:
-    LoopDetection(Module *m) : Pass(m) {}
+    LoopDetection(Module *m) : FunctionPass(m) {}
     ~LoopDetection() = default;
 
-    void run() override;
-    void run_on_func(Function *f);
+    std::string get_name() const override { return "LoopDetection"; }
+    void run_on_func(Function *f) override;
+    PreservedAnalyses get_preserved_analyses() const override {
+        return PreservedAnalyses::all();
+    }
+    void finish() override { print(); }
+    std::unique_ptr<FunctionPass> clone() const override {
+        return std::make_unique<LoopDetection>(m_);
+    }
+    void merge(FunctionPass *worker) override;
     void print() ;
     std::vector<std::shared_ptr<Loop>> &get_loops() { return loops_; }
 };
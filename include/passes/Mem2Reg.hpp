@@ -1,41 +1,57 @@
 #pragma once
 
+#include "DenseIndexMap.hpp"
 #include "Dominators.hpp"
 #include "Instruction.hpp"
+#include "LoopDetection.hpp"
+#include "PostDominators.hpp"
 #include "Value.hpp"
 
-#include <map>
 #include <memory>
+#include <vector>
 
-class Mem2Reg : public Pass {
+class Mem2Reg : public FunctionPass {
   private:
     Function *func_;
-    std::unique_ptr<Dominators> dominators_;
-    std::map<Value *, Value *> phi_map;
+    Dominators *dominators_;
     // TODO 添加需要的变量
 
+    // 以下各表以 alloca 或 phi 指令在函数内的编号为下标
     // 变量定值栈
-    std::map<Value *, std::vector<Value *>> var_val_stack;
+    DenseInstMap<std::vector<Value *>> var_val_stack;
     // phi指令对应的左值(地址)
-    std::map<PhiInst *, Value *> phi_lval;
+    DenseInstMap<AllocaInst *> phi_lval;
 
   public:
-    Mem2Reg(Module *m) : Pass(m) {}
+    Mem2Reg(Module *m) : FunctionPass(m) {}
     ~Mem2Reg() = default;
 
-    void run() override;
+    void run_on_func(Function *f) override;
+    std::string get_name() const override { return "Mem2Reg"; }
+    // 只插入 phi 并删除 alloca/load/store，不改变 CFG；
+    // 依赖指令的分析（别名、函数摘要等）都需要重新计算
+    PreservedAnalyses get_preserved_analyses() const override {
+        return PreservedAnalyses::none()
+            .preserve<Dominators>()
+            .preserve<LoopDetection>()
+            .preserve<PostDominators>();
+    }
+    std::unique_ptr<FunctionPass> clone() const override {
+        return std::make_unique<Mem2Reg>(m_);
+    }
 
     void generate_phi();
     void rename(BasicBlock *bb);
 
     static inline bool is_global_variable(Value *l_val) {
-        return dynamic_cast<GlobalVariable *>(l_val) != nullptr;
+        return dyn_cast<GlobalVariable>(l_val) != nullptr;
     }
     static inline bool is_gep_instr(Value *l_val) {
-        return dynamic_cast<GetElementPtrInst *>(l_val) != nullptr;
+        return dyn_cast<GetElementPtrInst>(l_val) != nullptr;
     }
 
+    // 只提升 alloca 出的局部变量，全局变量和 gep 得到的数组元素留在内存中
     static inline bool is_valid_ptr(Value *l_val) {
-        return not is_global_variable(l_val) and not is_gep_instr(l_val);
+        return dyn_cast<AllocaInst>(l_val) != nullptr;
     }
 };
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+class Module;
+
+// 模块中 IR 的规模统计
+struct IRCounts {
+    unsigned functions{0};
+    unsigned blocks{0};
+    unsigned instructions{0};
+
+    static IRCounts collect(Module *m);
+};
+
+// 一次 pass 运行的测量结果
+struct PassRecord {
+    std::string name;
+    double wall_ms{0};
+    double cpu_ms{0};
+    IRCounts before;
+    IRCounts after;
+    long peak_rss_kb{0}; // pass 结束时进程的峰值 RSS
+};
+
+/**
+ * PassManager 的计时与统计层：
+ * -time-passes 输出每个 pass 的 wall/cpu 时间与峰值 RSS，
+ * -stats 输出每个 pass 前后的函数/基本块/指令数量，
+ * -stats-json 以 JSON 形式输出全部记录
+ */
+class PassInstrumentation {
+  public:
+    void enable() { enabled_ = true; }
+    bool enabled() const { return enabled_; }
+
+    void run_pass(const std::string &name, Module *m,
+                  const std::function<void()> &body);
+
+    const std::vector<PassRecord> &get_records() const { return records_; }
+
+    void print_timing_table(std::ostream &os) const;
+    void print_stats_table(std::ostream &os) const;
+    void print_json(std::ostream &os) const;
+
+    static long get_peak_rss_kb();
+
+  private:
+    bool enabled_{false};
+    std::vector<PassRecord> records_;
+};
@@ -1,8 +1,11 @@
 #pragma once
 
+#include "AnalysisManager.hpp"
 #include "Module.hpp"
+#include "PassInstrumentation.hpp"
 
 #include <memory>
+#include <string>
 #include <vector>
 
 class Pass {
@@ -10,27 +13,65 @@ class Pass {
     Pass(Module *m) : m_(m) {}
     virtual ~Pass() = default;
     virtual void run() = 0;
+    // 用于 -time-passes / -stats 的输出
+    virtual std::string get_name() const = 0;
+
+    // 执行后仍然有效的分析，默认使所有分析失效
+    virtual PreservedAnalyses get_preserved_analyses() const {
+        return PreservedAnalyses::none();
+    }
+    void set_analysis_manager(AnalysisManager *am) { am_ = am; }
 
   protected:
     Module *m_;
+    // 由 PassManager 或 AnalysisManager 设置，用于获取缓存的分析结果
+    AnalysisManager *am_{nullptr};
+};
+
+/**
+ * 逐函数执行的 pass：run_on_func 只能修改该函数内部的 IR。
+ * PassManager 并行执行时，init() 与 finish() 在主线程串行执行，
+ * 作为并行阶段前后的屏障；每个工作线程使用 clone() 得到的副本处理函数，
+ * 副本共享 init() 的结果，结束后通过 merge() 汇总回原对象。
+ * 分析结果通过 am_ 获取，各线程可以同时请求不同函数的分析
+ */
+class FunctionPass : public Pass {
+  public:
+    FunctionPass(Module *m) : Pass(m) {}
+
+    void run() override;
+
+    virtual void init() {}
+    virtual void run_on_func(Function *f) = 0;
+    virtual void finish() {}
+
+    virtual std::unique_ptr<FunctionPass> clone() const = 0;
+    virtual void merge(FunctionPass *worker) {}
 };
 
 class PassManager {
   public:
-    PassManager(Module *m) : m_(m) {}
+    PassManager(Module *m) : m_(m), analysis_manager_(m) {}
 
     template <typename PassType, typename... Args>
     void add_pass(Args &&...args) {
         passes_.emplace_back(new PassType(m_, std::forward<Args>(args)...));
+        passes_.back()->set_analysis_manager(&analysis_manager_);
     }
 
-    void run() {
-        for (auto &pass : passes_) {
-            pass->run();
-        }
-    }
+    void run();
+
+    // 大于 1 时，FunctionPass 在多个线程上并行处理不同的函数
+    void set_num_threads(unsigned n) { num_threads_ = n; }
+    PassInstrumentation &get_instrumentation() { return instrumentation_; }
 
   private:
+    void run_pass(Pass *pass);
+    void run_function_pass_parallel(FunctionPass *pass);
+
     std::vector<std::unique_ptr<Pass>> passes_;
     Module *m_;
+    unsigned num_threads_{1};
+    AnalysisManager analysis_manager_;
+    PassInstrumentation instrumentation_;
 };
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "BasicBlock.hpp"
+#include "DenseIndexMap.hpp"
+#include "PassManager.hpp"
+
+#include <vector>
+
+/**
+ * 后必经关系分析，即反向 CFG 上的支配关系。
+ * 函数可能有多个 ret，也可能有到不了 ret 的死循环，因此引入虚拟出口：
+ * 没有后继的基本块和到不了这些块的基本块都连向虚拟出口，
+ * 每个基本块都被虚拟出口后必经。结果按基本块的稠密编号存放
+ */
+class PostDominators : public FunctionPass {
+  public:
+    // 后必经边界按基本块在函数中的顺序排列
+    using BBList = BasicBlock::BBList;
+
+    explicit PostDominators(Module *m) : FunctionPass(m) {}
+    ~PostDominators() = default;
+    std::string get_name() const override { return "PostDominators"; }
+    void run_on_func(Function *f) override;
+    PreservedAnalyses get_preserved_analyses() const override {
+        return PreservedAnalyses::all();
+    }
+
+    std::unique_ptr<FunctionPass> clone() const override {
+        return std::make_unique<PostDominators>(m_);
+    }
+
+    // 直接后必经结点，为虚拟出口时返回 nullptr
+    BasicBlock *get_ipdom(BasicBlock *bb) { return ipdom_.at(bb); }
+    // 能否沿 CFG 到达没有后继的基本块，即所在的不是死循环
+    bool reaches_exit(BasicBlock *bb) { return reaches_exit_.at(bb); }
+    const BBList &get_post_dominance_frontier(BasicBlock *bb) {
+        return frontier_.at(bb);
+    }
+
+  private:
+    void find_exits(Function *f);
+    void run_dfs(Function *f);
+    void create_ipdom();
+    void create_post_dominance_frontier(Function *f);
+
+    // 连向虚拟出口的基本块
+    std::vector<BasicBlock *> exits_{};
+    // 反向 CFG 上的后序，虚拟出口在最后，记为 nullptr
+    std::vector<BasicBlock *> post_order_vec_{};
+    DenseBlockMap<unsigned int> post_order_{}; // 后序号
+    std::vector<unsigned int> doms_{}; // 以后序号表示的直接后必经结点
+
+    DenseBlockMap<BasicBlock *> ipdom_{};
+    DenseBlockMap<bool> reaches_exit_{};
+    DenseBlockMap<bool> is_exit_{};
+    DenseBlockMap<BBList> frontier_{}; // 后必经边界
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "BitVector.hpp"
+#include "DenseIndexMap.hpp"
+#include "PassManager.hpp"
+
+#include <vector>
+
+/**
+ * 到达定值分析，在 BitVectorDataFlow 上求解的前向并集问题。
+ * 定值指 store 指令，位向量以 store 在函数内的稠密编号为下标。
+ * 只有写同一个地址值（同一个 alloca、全局变量或 gep 指令）的 store
+ * 才互相注销，因此结果是可能到达的定值的一个超集
+ */
+class ReachingDefinitions : public FunctionPass {
+  public:
+    explicit ReachingDefinitions(Module *m) : FunctionPass(m) {}
+    ~ReachingDefinitions() = default;
+    std::string get_name() const override { return "ReachingDefinitions"; }
+    void run_on_func(Function *f) override;
+    PreservedAnalyses get_preserved_analyses() const override {
+        return PreservedAnalyses::all();
+    }
+
+    std::unique_ptr<FunctionPass> clone() const override {
+        return std::make_unique<ReachingDefinitions>(m_);
+    }
+
+    // 到达基本块入口、出口的 store
+    const BitVector &get_reach_in(BasicBlock *bb) { return reach_in_.at(bb); }
+    const BitVector &get_reach_out(BasicBlock *bb) {
+        return reach_out_.at(bb);
+    }
+    bool reaches(StoreInst *store, BasicBlock *bb) {
+        auto bit = bits_.at(store);
+        return bit != 0 and get_reach_in(bb).test(bit - 1);
+    }
+    // 位向量中的下标对应的 store
+    StoreInst *get_store(unsigned bit) { return stores_[bit]; }
+    unsigned get_num_stores() const { return stores_.size(); }
+
+  private:
+    std::vector<StoreInst *> stores_{};
+    DenseInstMap<unsigned int> bits_{}; // 下标加 1
+    DenseBlockMap<BitVector> reach_in_{};
+    DenseBlockMap<BitVector> reach_out_{};
+};
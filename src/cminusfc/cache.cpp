@@ -0,0 +1,195 @@
+#include "cache.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// FNV-1a, continued from h; only names the entry, see lookup()
+static uint64_t hash_bytes(uint64_t h, const std::string &data) {
+    for (unsigned char c : data) {
+        h ^= c;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+static std::string to_hex(uint64_t v) {
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx",
+                  static_cast<unsigned long long>(v));
+    return buf;
+}
+
+CompileCache::CompileCache(fs::path dir, uint64_t max_size)
+    : dir_(std::move(dir)), max_size_(max_size) {
+    std::error_code ec;
+    fs::create_directories(dir_, ec);
+    // a rebuilt compiler has another size or mtime
+    struct stat st;
+    if (stat("/proc/self/exe", &st) == 0) {
+        version_ = std::to_string(st.st_size) + "." +
+                   std::to_string(st.st_mtim.tv_sec) + "." +
+                   std::to_string(st.st_mtim.tv_nsec);
+    }
+}
+
+CompileCache::Key CompileCache::make_key(const std::string &options,
+                                         const std::string &input) const {
+    Key key;
+    key.text = version_ + '\0' + options + '\0' + input;
+    uint64_t h = hash_bytes(0xcbf29ce484222325ULL, key.text);
+    key.name = to_hex(h) + "-" + to_hex(input.size());
+    return key;
+}
+
+// an entry is the length of the key text, a newline, the key text and the
+// output
+bool CompileCache::lookup(const Key &key, std::string &output) {
+    auto path = dir_ / key.name;
+    std::ifstream stream(path, std::ios::binary);
+    std::string header;
+    size_t key_size = 0;
+    if (stream and std::getline(stream, header)) {
+        key_size = std::strtoull(header.c_str(), nullptr, 10);
+    }
+    std::string text(key_size, '\0');
+    if (key_size != key.text.size() or
+        not stream.read(text.data(), key_size) or text != key.text) {
+        // no entry, or another key with the same hash
+        misses_++;
+        return false;
+    }
+    std::ostringstream data;
+    data << stream.rdbuf();
+    output = data.str();
+    // recently used, see evict()
+    utimensat(AT_FDCWD, path.c_str(), nullptr, 0);
+    hits_++;
+    return true;
+}
+
+static bool write_all(int fd, const std::string &data) {
+    auto *p = data.data();
+    auto len = data.size();
+    while (len > 0) {
+        auto n = write(fd, p, len);
+        if (n <= 0)
+            return false;
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+void CompileCache::store(const Key &key, const std::string &output) {
+    auto tmp = (dir_ / "tmp.XXXXXX").string();
+    int fd = mkstemp(tmp.data());
+    if (fd < 0)
+        return;
+    auto header = std::to_string(key.text.size()) + "\n";
+    bool written = write_all(fd, header) and write_all(fd, key.text) and
+                   write_all(fd, output);
+    close(fd);
+    // a colliding entry is replaced, the totals count the difference
+    auto path = dir_ / key.name;
+    struct stat st;
+    bool replaced = stat(path.c_str(), &st) == 0;
+    if (not written or rename(tmp.c_str(), path.c_str()) != 0) {
+        unlink(tmp.c_str());
+        return;
+    }
+    int64_t size = header.size() + key.text.size() + output.size();
+    stored_entries_ += replaced ? 0 : 1;
+    stored_size_ += replaced ? size - st.st_size : size;
+}
+
+void CompileCache::evict() {
+    // totals of all runs, the file is locked against concurrent compilers
+    int fd = open((dir_ / "stats").c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0 or flock(fd, LOCK_EX) != 0) {
+        if (fd >= 0)
+            close(fd);
+        run_hits_ = hits_.exchange(0);
+        run_misses_ = misses_.exchange(0);
+        return;
+    }
+    char buf[128] = {};
+    unsigned long long hits = 0, misses = 0, entries = 0, size = 0;
+    int fields = 0;
+    if (pread(fd, buf, sizeof(buf) - 1, 0) > 0)
+        fields = std::sscanf(buf, "%llu %llu %llu %llu", &hits, &misses,
+                             &entries, &size);
+    run_hits_ = hits_.exchange(0);
+    run_misses_ = misses_.exchange(0);
+    total_hits_ = hits + run_hits_;
+    total_misses_ = misses + run_misses_;
+    int64_t new_entries = entries + stored_entries_.exchange(0);
+    int64_t new_size = size + stored_size_.exchange(0);
+    num_entries_ = std::max<int64_t>(new_entries, 0);
+    total_size_ = std::max<int64_t>(new_size, 0);
+    // the totals drift when compilers race on one entry or the directory
+    // is changed by hand, the scan sets them right
+    if (fields < 4 or total_size_ > max_size_)
+        scan();
+    auto len = std::snprintf(buf, sizeof(buf), "%llu %llu %llu %llu\n",
+                             total_hits_, total_misses_,
+                             static_cast<unsigned long long>(num_entries_),
+                             static_cast<unsigned long long>(total_size_));
+    if (ftruncate(fd, 0) != 0 or pwrite(fd, buf, len, 0) != ssize_t(len))
+        std::cerr << "cannot update cache stats in " << dir_ << std::endl;
+    close(fd);
+}
+
+void CompileCache::scan() {
+    struct Entry {
+        fs::path path;
+        uint64_t size;
+        fs::file_time_type time;
+    };
+    std::vector<Entry> entries;
+    std::error_code ec;
+    for (auto &file : fs::directory_iterator(dir_, ec)) {
+        auto name = file.path().filename().string();
+        if (name == "stats" or name.rfind("tmp.", 0) == 0)
+            continue;
+        auto size = file.file_size(ec);
+        auto time = file.last_write_time(ec);
+        if (not ec)
+            entries.push_back({file.path(), size, time});
+    }
+    num_entries_ = entries.size();
+    total_size_ = 0;
+    for (auto &entry : entries)
+        total_size_ += entry.size;
+    if (total_size_ > max_size_) {
+        // least recently used first
+        std::sort(entries.begin(), entries.end(),
+                  [](const Entry &lhs, const Entry &rhs) {
+                      return lhs.time < rhs.time;
+                  });
+        for (auto &entry : entries) {
+            if (total_size_ <= max_size_)
+                break;
+            if (fs::remove(entry.path, ec)) {
+                total_size_ -= entry.size;
+                num_entries_--;
+            }
+        }
+    }
+}
+
+void CompileCache::print_stats(std::ostream &os) const {
+    os << "cache " << dir_.string() << ": " << run_hits_ << " hits, "
+       << run_misses_ << " misses (" << total_hits_ << " hits, "
+       << total_misses_ << " misses in total), " << num_entries_
+       << " entries, " << total_size_ << " bytes" << std::endl;
+}
@@ -0,0 +1,72 @@
+#include "server.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using std::string;
+using std::operator""s;
+
+/*
+ * Thin client of `cminusfc -server <socket>`:
+ *   cminusfc-client <socket> <cminusfc options> <input-file>
+ * sends the source file and options, then writes the returned output file.
+ */
+
+// options of cminusfc that take a value
+static bool takes_value(const string &arg) {
+    return arg == "-o"s or arg == "-j"s or arg == "-stats-json"s or
+           arg == "-cache-dir"s or arg == "-cache-size"s;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <socket> <cminusfc options> <input-file>" << std::endl;
+        return 1;
+    }
+
+    CompileRequest request;
+    request.cwd = std::filesystem::current_path();
+    request.args.push_back("cminusfc");
+    string input_file;
+    for (int i = 2; i < argc; ++i) {
+        request.args.push_back(argv[i]);
+        if (takes_value(argv[i]) and i + 1 < argc) {
+            request.args.push_back(argv[++i]);
+        } else if (argv[i][0] != '-') {
+            input_file = argv[i];
+        }
+    }
+
+    // options are checked by the server, only the source is read here
+    std::ifstream input_stream(input_file);
+    if (input_file.empty() or not input_stream) {
+        std::cerr << argv[0] << ": cannot read input file \'" << input_file
+                  << "\'" << std::endl;
+        return 1;
+    }
+    std::ostringstream source;
+    source << input_stream.rdbuf();
+    request.source = source.str();
+
+    int fd = connect_server(argv[1]);
+    if (fd < 0) {
+        std::cerr << argv[0] << ": cannot connect to server " << argv[1]
+                  << std::endl;
+        return 1;
+    }
+    CompileResponse response;
+    if (not send_request(fd, request) or not recv_response(fd, response)) {
+        // the server already reported the error on our stderr
+        return 1;
+    }
+
+    if (not response.output_file.empty()) {
+        std::ofstream output_stream(response.output_file);
+        output_stream << response.output;
+    }
+    return response.status;
+}
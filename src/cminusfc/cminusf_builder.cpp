@@ -4,13 +4,13 @@
 #define CONST_FP(num) ConstantFP::get((float)num, module.get())
 #define CONST_INT(num) ConstantInt::get(num, module.get())
 
-// types
-Type *VOID_T;
-Type *INT1_T;
-Type *INT32_T;
-Type *INT32PTR_T;
-Type *FLOAT_T;
-Type *FLOATPTR_T;
+// types, thread_local since batch mode builds several modules at once
+thread_local Type *VOID_T;
+thread_local Type *INT1_T;
+thread_local Type *INT32_T;
+thread_local Type *INT32PTR_T;
+thread_local Type *FLOAT_T;
+thread_local Type *FLOATPTR_T;
 
 /*
  * use CMinusfBuilder::Scope to construct scopes
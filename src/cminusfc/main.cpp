@@ -9,84 +9,434 @@
 #include "Mem2Reg.hpp"
 #include "LoopDetection.hpp"
 #include "LICM.hpp"
+#include "Interpreter.hpp"
+#include "IRbinary.hpp"
+#include "IRparser.hpp"
+#include "ThreadPool.hpp"
+#include "server.hpp"
+#include "cache.hpp"
 
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <mutex>
+#include <set>
+#include <sstream>
 #include <string>
+#include <vector>
 
 using std::string;
 using std::operator""s;
 
 struct Config {
     string exe_name; // compiler exe name
-    std::filesystem::path input_file;
+    // more than one input file means batch mode
+    std::vector<std::filesystem::path> input_files;
+    // output file, or output directory in batch mode
     std::filesystem::path output_file;
 
     bool emitast{false};
     bool emitasm{false};
     bool emitllvm{false};
+    // LightIR binary form, see IRbinary.hpp
+    bool emitbinary{false};
+    // run the program with the LightIR interpreter
+    bool interpret{false};
+    bool interpret_stats{false};
     // optization conifg
     bool mem2reg{false};
     bool licm{false};
+    // aggressive dead code elimination, see DeadCode.hpp
+    bool adce{false};
+    // number of threads for function passes, or for files in batch mode
+    unsigned jobs{1};
+    // pass instrumentation config
+    bool time_passes{false};
+    bool stats{false};
+    std::filesystem::path stats_json_file;
+    // socket path of the compile server
+    string server_socket;
+    // compile cache, see cache.hpp
+    std::filesystem::path cache_dir;
+    uint64_t cache_size{256 << 20};
+    bool cache_stats{false};
 
     Config(int argc, char **argv) : argc(argc), argv(argv) {
         parse_cmd_line();
         check();
     }
 
+    bool batch_mode() const { return input_files.size() > 1; }
+    bool emits_output() const { return emitllvm or emitasm or emitbinary; }
+    // the reports of the passes and the interpreter need a real compilation
+    bool use_cache() const {
+        return not cache_dir.empty() and emits_output() and not interpret and
+               not time_passes and not stats and stats_json_file.empty();
+    }
+    // the options that change the output, part of the cache key
+    string get_cache_options(const std::filesystem::path &input_file) const;
+    std::filesystem::path get_output_file(
+        const std::filesystem::path &input_file) const;
+
   private:
     int argc{-1};
     char **argv{nullptr};
 
     void parse_cmd_line();
+    void read_response_file(const string &file);
     void check();
     // print helper infomation and exit
     void print_help() const;
     void print_err(const string &msg) const;
 };
 
-int main(int argc, char **argv) {
-    Config config(argc, argv);
+// serializes the instrumentation reports of concurrent compilations
+static std::mutex report_mutex;
+
+static bool is_source_file(const std::filesystem::path &file) {
+    return file.extension() == ".cminus";
+}
+
+static bool is_ir_file(const std::filesystem::path &file) {
+    return file.extension() == ".ll";
+}
+
+static bool is_binary_file(const std::filesystem::path &file) {
+    return file.extension() == ".lirb";
+}
+
+// the parser has reported the syntax error and left no root
+static bool parsed(syntax_tree *syntax_tree) {
+    if (syntax_tree->root) {
+        return true;
+    }
+    del_syntax_tree(syntax_tree);
+    return false;
+}
+
+static bool print_ast(syntax_tree *syntax_tree) {
+    if (not parsed(syntax_tree)) {
+        return false;
+    }
+    auto ast = AST(syntax_tree);
+    ASTPrinter printer;
+    ast.run_visitor(printer);
+    return true;
+}
 
-    auto syntax_tree = parse(config.input_file.c_str());
+static std::unique_ptr<Module> build_module(syntax_tree *syntax_tree) {
+    if (not parsed(syntax_tree)) {
+        return nullptr;
+    }
     auto ast = AST(syntax_tree);
+    CminusfBuilder builder;
+    ast.run_visitor(builder);
+    return builder.getModule();
+}
 
-    if (config.emitast) { // if emit ast (lab1), print ast and return
-        ASTPrinter printer;
-        ast.run_visitor(printer);
+// builds the module from the source, or loads it from a .ll/.lirb file
+static std::unique_ptr<Module> load_module(const Config &config,
+                                           const std::filesystem::path &file) {
+    std::unique_ptr<Module> m;
+    std::string err;
+    if (is_source_file(file)) {
+        m = build_module(parse(file.c_str()));
+    } else if (is_ir_file(file)) {
+        m = parse_ir_file(file, err);
     } else {
-        std::unique_ptr<Module> m;
-        CminusfBuilder builder;
-        ast.run_visitor(builder);
-        m = builder.getModule();
+        m = read_binary_file(file);
+    }
+    if (not m) {
+        std::cerr << config.exe_name << ": cannot read \'" << file.string()
+                  << "\'" << (err.empty() ? "" : ": " + err) << std::endl;
+    }
+    return m;
+}
+
+// runs the passes on m; exit_code is the return value of the interpreted
+// program
+static void compile(const Config &config, Module *m,
+                    const std::filesystem::path &input_file,
+                    unsigned num_threads, int &exit_code) {
+    PassManager PM(m);
+    PM.set_num_threads(num_threads);
+    // optimization 
+    if(config.mem2reg) {
+        PM.add_pass<Mem2Reg>();
+        PM.add_pass<DeadCode>(config.adce);
+    }
+    if(config.licm) {
+        PM.add_pass<LoopInvariantCodeMotion>();
+        PM.add_pass<DeadCode>(config.adce);
+    }
+    if (config.time_passes or config.stats or
+        not config.stats_json_file.empty()) {
+        PM.get_instrumentation().enable();
+    }
+    PM.run();
+
+    auto &instrumentation = PM.get_instrumentation();
+    if (config.time_passes or config.stats) {
+        std::lock_guard<std::mutex> lock(report_mutex);
+        if (config.batch_mode()) {
+            std::cerr << "; " << input_file.string() << "\n";
+        }
+        if (config.time_passes) {
+            instrumentation.print_timing_table(std::cerr);
+        }
+        if (config.stats) {
+            instrumentation.print_stats_table(std::cerr);
+        }
+    }
+    if (not config.stats_json_file.empty()) {
+        std::ofstream json_stream(config.stats_json_file);
+        instrumentation.print_json(json_stream);
+    }
 
-        PassManager PM(m.get());
-        // optimization 
-        if(config.mem2reg) {
-            PM.add_pass<Mem2Reg>();
-            PM.add_pass<DeadCode>();
+    if (config.interpret) {
+        Interpreter interpreter(m);
+        exit_code = interpreter.run();
+        if (config.interpret_stats) {
+            interpreter.print_stats(std::cerr);
         }
-        if(config.licm) {
-            PM.add_pass<LoopInvariantCodeMotion>();
-            PM.add_pass<DeadCode>();
+    }
+}
+
+// the .ll header names the input file, so it is not part of a cache entry
+static void emit_header(const Config &config,
+                        const std::filesystem::path &input_file,
+                        std::ostream &output_stream) {
+    if (config.emitllvm) {
+        auto abs_path = std::filesystem::canonical(input_file);
+        output_stream << "; ModuleID = 'cminus'\n";
+        output_stream << "source_filename = " << abs_path << "\n\n";
+    }
+}
+
+// writes the .ll/.s/.lirb output of m, the IR is streamed without building
+// it as one string
+static void emit_body(const Config &config, Module *m,
+                      std::ostream &output_stream) {
+    if (config.emitllvm) {
+        m->print(output_stream);
+    } else if (config.emitasm) {
+        CodeGen codegen(m);
+        codegen.run();
+        output_stream << codegen.print();
+    } else if (config.emitbinary) {
+        write_binary(m, output_stream);
+    }
+}
+
+// writes the output of m, and adds it to the cache if there is one
+static void emit(const Config &config, Module *m,
+                 const std::filesystem::path &input_file,
+                 std::ostream &output_stream, CompileCache *cache,
+                 const CompileCache::Key &key) {
+    emit_header(config, input_file, output_stream);
+    if (not cache) {
+        emit_body(config, m, output_stream);
+        return;
+    }
+    std::ostringstream body;
+    emit_body(config, m, body);
+    cache->store(key, body.str());
+    output_stream << body.str();
+}
+
+static int compile_file(const Config &config,
+                        const std::filesystem::path &input_file,
+                        const std::filesystem::path &output_file,
+                        unsigned num_threads, CompileCache *cache) {
+    if (config.emitast) {
+        return print_ast(parse(input_file.c_str())) ? 0 : -1;
+    }
+    CompileCache::Key key;
+    if (cache) {
+        // a hit is written without parsing the input
+        std::ifstream input_stream(input_file, std::ios::binary);
+        std::ostringstream input;
+        input << input_stream.rdbuf();
+        key = cache->make_key(config.get_cache_options(input_file),
+                              input.str());
+        string body;
+        if (cache->lookup(key, body)) {
+            std::ofstream output_stream(output_file);
+            emit_header(config, input_file, output_stream);
+            output_stream << body;
+            return 0;
         }
-        PM.run();
+    }
+    auto m = load_module(config, input_file);
+    if (not m) {
+        return -1;
+    }
+    int exit_code = 0;
+    compile(config, m.get(), input_file, num_threads, exit_code);
+    if (config.emits_output()) {
+        std::ofstream output_stream(output_file);
+        emit(config, m.get(), input_file, output_stream, cache, key);
+    }
+    return exit_code;
+}
+
+static void finish_cache(const Config &config, CompileCache *cache) {
+    if (not cache) {
+        return;
+    }
+    cache->evict();
+    if (config.cache_stats) {
+        cache->print_stats(std::cerr);
+    }
+}
+
+static syntax_tree *parse_source(string source) {
+    // fmemopen rejects an empty buffer
+    if (source.empty()) {
+        source = "\n";
+    }
+    auto *input = fmemopen(source.data(), source.size(), "r");
+    auto *syntax_tree = parse_file(input);
+    fclose(input);
+    return syntax_tree;
+}
 
-        std::ofstream output_stream(config.output_file);
-        if (config.emitllvm) {
-            auto abs_path = std::filesystem::canonical(config.input_file);
-            output_stream << "; ModuleID = 'cminus'\n";
-            output_stream << "source_filename = " << abs_path << "\n\n";
-            output_stream << m->print();
-        } else if (config.emitasm) {
-            CodeGen codegen(m.get());
-            codegen.run();
-            output_stream << codegen.print();
+// runs in a process forked by the server, so errors may exit as usual
+static CompileResponse handle_request(const CompileRequest &request) {
+    std::vector<char *> argv;
+    for (auto &arg : request.args) {
+        argv.push_back(const_cast<char *>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+    Config config(argv.size() - 1, argv.data());
+    if (config.batch_mode() or not config.server_socket.empty()) {
+        std::cerr << config.exe_name << ": server expects one input file"
+                  << std::endl;
+        return {-1, "", ""};
+    }
+
+    auto &input_file = config.input_files.front();
+    CompileResponse response;
+    if (config.emitast) {
+        if (not print_ast(parse_source(request.source))) {
+            response.status = -1;
         }
+        return response;
+    }
+    std::unique_ptr<CompileCache> cache;
+    CompileCache::Key key;
+    if (config.use_cache()) {
+        cache = std::make_unique<CompileCache>(config.cache_dir,
+                                               config.cache_size);
+        key = cache->make_key(config.get_cache_options(input_file),
+                              request.source);
+        string body;
+        if (cache->lookup(key, body)) {
+            std::ostringstream output_stream;
+            emit_header(config, input_file, output_stream);
+            output_stream << body;
+            response.output = output_stream.str();
+            response.output_file = config.output_file;
+            finish_cache(config, cache.get());
+            return response;
+        }
+    }
+    std::unique_ptr<Module> m;
+    std::string err;
+    if (is_source_file(input_file)) {
+        m = build_module(parse_source(request.source));
+    } else if (is_ir_file(input_file)) {
+        m = parse_ir(request.source.data(), request.source.size(), err);
+    } else {
+        m = read_binary(request.source.data(), request.source.size());
+    }
+    if (not m) {
+        std::cerr << config.exe_name << ": cannot read \'"
+                  << input_file.string() << "\'"
+                  << (err.empty() ? "" : ": " + err) << std::endl;
+        return {-1, "", ""};
+    }
+    compile(config, m.get(), input_file, config.jobs, response.status);
+    if (config.emits_output()) {
+        std::ostringstream output_stream;
+        emit(config, m.get(), input_file, output_stream, cache.get(), key);
+        response.output = output_stream.str();
+        response.output_file = config.output_file;
+    }
+    finish_cache(config, cache.get());
+    return response;
+}
+
+int main(int argc, char **argv) {
+    Config config(argc, argv);
+
+    if (not config.server_socket.empty()) {
+        return run_server(config.server_socket, handle_request);
+    }
+    std::unique_ptr<CompileCache> cache;
+    if (config.use_cache()) {
+        cache = std::make_unique<CompileCache>(config.cache_dir,
+                                               config.cache_size);
     }
+    if (not config.batch_mode()) {
+        auto exit_code = compile_file(config, config.input_files.front(),
+                                      config.output_file, config.jobs,
+                                      cache.get());
+        finish_cache(config, cache.get());
+        return exit_code;
+    }
+
+    // batch mode: each worker compiles one file at a time, and the passes of
+    // a single file run serially; a file that fails does not stop the others,
+    // and the batch returns the nonzero result of any of them
+    std::atomic<int> batch_exit_code{0};
+    ThreadPool pool(config.jobs);
+    for (auto &input_file : config.input_files) {
+        pool.submit([&](unsigned) {
+            auto output_file = config.get_output_file(input_file);
+            auto exit_code =
+                compile_file(config, input_file, output_file, 1, cache.get());
+            if (exit_code != 0) {
+                batch_exit_code = exit_code;
+            }
+        });
+    }
+    pool.wait();
+    finish_cache(config, cache.get());
+
+    return batch_exit_code;
+}
 
-    return 0;
+string
+Config::get_cache_options(const std::filesystem::path &input_file) const {
+    string options = input_file.extension().string();
+    options += emitllvm ? " -emit-llvm" : emitasm ? " -S" : " -emit-binary";
+    options += mem2reg ? " -mem2reg" : "";
+    options += licm ? " -licm" : "";
+    options += adce ? " -adce" : "";
+    return options;
+}
+
+std::filesystem::path
+Config::get_output_file(const std::filesystem::path &input_file) const {
+    if (not batch_mode()) {
+        return output_file;
+    }
+    std::filesystem::path file = input_file.stem();
+    if (emitllvm) {
+        file.replace_extension(".ll");
+    } else if (emitasm) {
+        file.replace_extension(".s");
+    } else if (emitbinary) {
+        file.replace_extension(".lirb");
+    }
+    return output_file / file;
 }
 
 void Config::parse_cmd_line() {
@@ -107,53 +457,178 @@ void Config::parse_cmd_line() {
             emitasm = true;
         } else if (argv[i] == "-emit-llvm"s) {
             emitllvm = true;
+        } else if (argv[i] == "-emit-binary"s) {
+            emitbinary = true;
+        } else if (argv[i] == "-interpret"s) {
+            interpret = true;
+        } else if (argv[i] == "-interpret-stats"s) {
+            interpret = true;
+            interpret_stats = true;
         } else if (argv[i] == "-mem2reg"s) {
             mem2reg = true;
         } else if (argv[i] == "-licm"s) {
             licm = true;
-        }else {
-            if (input_file.empty()) {
-                input_file = argv[i];
+        } else if (argv[i] == "-adce"s) {
+            adce = true;
+        } else if (argv[i] == "-j"s) {
+            if (i + 1 < argc && std::atoi(argv[i + 1]) > 0) {
+                jobs = std::atoi(argv[i + 1]);
+                i += 1;
+            } else {
+                print_err("bad number of jobs");
+            }
+        } else if (argv[i] == "-time-passes"s) {
+            time_passes = true;
+        } else if (argv[i] == "-stats"s) {
+            stats = true;
+        } else if (argv[i] == "-stats-json"s) {
+            if (stats_json_file.empty() && i + 1 < argc) {
+                stats_json_file = argv[i + 1];
+                i += 1;
+            } else {
+                print_err("bad stats json file");
+            }
+        } else if (argv[i] == "-server"s) {
+            if (server_socket.empty() && i + 1 < argc) {
+                server_socket = argv[i + 1];
+                i += 1;
+            } else {
+                print_err("bad server socket");
+            }
+        } else if (argv[i] == "-cache-dir"s) {
+            if (cache_dir.empty() && i + 1 < argc) {
+                cache_dir = argv[i + 1];
+                i += 1;
+            } else {
+                print_err("bad cache dir");
+            }
+        } else if (argv[i] == "-cache-size"s) {
+            // a positive number of MiB, nothing else in the argument
+            const char *arg = i + 1 < argc ? argv[i + 1] : "";
+            char *end = nullptr;
+            errno = 0;
+            auto mib = std::strtoull(arg, &end, 10);
+            if (std::isdigit(static_cast<unsigned char>(arg[0])) and
+                *end == '\0' and errno == 0 and mib > 0 and
+                mib <= UINT64_MAX >> 20) {
+                cache_size = uint64_t(mib) << 20;
+                i += 1;
             } else {
-                string err =
-                    "unrecognized command-line option \'"s + argv[i] + "\'"s;
-                print_err(err);
+                print_err("bad cache size");
             }
+        } else if (argv[i] == "-cache-stats"s) {
+            cache_stats = true;
+        } else if (argv[i][0] == '@') {
+            read_response_file(argv[i] + 1);
+        } else if (argv[i][0] == '-') {
+            string err =
+                "unrecognized command-line option \'"s + argv[i] + "\'"s;
+            print_err(err);
+        } else {
+            input_files.emplace_back(argv[i]);
+        }
+    }
+}
+
+// a response file lists one input file per line
+void Config::read_response_file(const string &file) {
+    std::ifstream stream(file);
+    if (not stream) {
+        print_err("cannot open response file \'"s + file + "\'"s);
+    }
+    string line;
+    while (std::getline(stream, line)) {
+        if (not line.empty()) {
+            input_files.emplace_back(line);
         }
     }
 }
 
 void Config::check() {
-    if (input_file.empty()) {
+    // the server gets its input files from the requests
+    if (not server_socket.empty()) {
+        return;
+    }
+    if (input_files.empty()) {
         print_err("no input file");
     }
-    if (input_file.extension() != ".cminus") {
-        print_err("file format not recognized");
+    for (auto &input_file : input_files) {
+        if (not is_source_file(input_file) and not is_ir_file(input_file) and
+            not is_binary_file(input_file)) {
+            print_err("file format not recognized");
+        }
+        if (emitast and not is_source_file(input_file)) {
+            print_err("emit ast needs a source file");
+        }
     }
-    if (emitllvm and emitasm) {
-        print_err("emit llvm and emit asm both set");
+    if (emitllvm + emitasm + emitbinary > 1) {
+        print_err("more than one output format set");
     }
-    if (not emitllvm and not emitasm and not emitast) {
+    if (not emits_output() and not emitast and not interpret) {
         print_err("not supported: generate executable file directly");
     }
     if (licm and not mem2reg) {
         print_err("licm must be used with mem2reg");
     }
-    if (output_file.empty()) {
-        output_file = input_file.stem();
+    if (adce and not mem2reg) {
+        print_err("adce must be used with mem2reg");
+    }
+    if (batch_mode()) {
+        if (emitast) {
+            print_err("emit ast does not support multiple input files");
+        }
+        if (interpret) {
+            print_err("interpret does not support multiple input files");
+        }
+        if (not stats_json_file.empty()) {
+            print_err("stats json does not support multiple input files");
+        }
+        // -o names the output directory in batch mode
+        if (output_file.empty()) {
+            output_file = ".";
+        }
+        std::filesystem::create_directories(output_file);
+        std::set<std::filesystem::path> outputs;
+        for (auto &input_file : input_files) {
+            if (not outputs.insert(get_output_file(input_file)).second) {
+                print_err("duplicate output file for \'"s +
+                          input_file.string() + "\'"s);
+            }
+        }
+    } else if (output_file.empty()) {
+        output_file = input_files.front().stem();
         if (emitllvm) {
             output_file.replace_extension(".ll");
         } else if (emitasm) {
             output_file.replace_extension(".s");
+        } else if (emitbinary) {
+            output_file.replace_extension(".lirb");
+        }
+    }
+    // e.g. foo.ll -emit-llvm without -o; an output that does not exist
+    // yet or cannot be resolved (a pipe such as /dev/stdout) is never the
+    // input
+    for (auto &input_file : input_files) {
+        std::error_code ec;
+        if (emits_output() and
+            std::filesystem::equivalent(get_output_file(input_file),
+                                        input_file, ec)) {
+            print_err("output file would overwrite \'"s +
+                      input_file.string() + "\'"s);
         }
     }
 }
 
 void Config::print_help() const {
     std::cout << "Usage: " << exe_name
-              << " [-h|--help] [-o <target-file>] [-emit-llvm] [-S] [-dump-json]"
-                 "[-mem2reg] [-licm]"
-                 "<input-file>"
+              << " [-h|--help] [-o <target-file>] [-emit-llvm] [-S] "
+                 "[-emit-binary] [-dump-json]"
+                 "[-mem2reg] [-licm] [-adce] [-interpret] [-interpret-stats] "
+                 "[-j <threads>] [-time-passes] [-stats] "
+                 "[-stats-json <json-file>] "
+                 "[-server <socket>] [-cache-dir <dir>] "
+                 "[-cache-size <MiB>] [-cache-stats] "
+                 "<input-file>... [@<response-file>]"
               << std::endl;
     exit(0);
 }
@@ -0,0 +1,223 @@
+#include "server.hpp"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static bool write_all(int fd, const void *buf, size_t len) {
+    auto *p = static_cast<const char *>(buf);
+    while (len > 0) {
+        auto n = write(fd, p, len);
+        if (n < 0 and errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+static bool read_all(int fd, void *buf, size_t len) {
+    auto *p = static_cast<char *>(buf);
+    while (len > 0) {
+        auto n = read(fd, p, len);
+        if (n < 0 and errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+static bool send_frame(int fd, const std::string &data) {
+    uint32_t len = data.size();
+    return write_all(fd, &len, sizeof(len)) and
+           write_all(fd, data.data(), data.size());
+}
+
+static bool recv_frame(int fd, std::string &data) {
+    uint32_t len;
+    if (not read_all(fd, &len, sizeof(len)))
+        return false;
+    data.resize(len);
+    return read_all(fd, data.data(), len);
+}
+
+// pass the client's stdin, stdout and stderr along with one dummy byte
+static bool send_std_fds(int fd) {
+    int fds[3] = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+    char dummy = 0;
+    iovec iov{&dummy, 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fds))] = {};
+
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    auto *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    std::memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+    return sendmsg(fd, &msg, 0) == 1;
+}
+
+static bool recv_std_fds(int fd, int (&fds)[3]) {
+    char dummy;
+    iovec iov{&dummy, 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fds))] = {};
+
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    if (recvmsg(fd, &msg, 0) != 1)
+        return false;
+    auto *cmsg = CMSG_FIRSTHDR(&msg);
+    if (not cmsg or cmsg->cmsg_type != SCM_RIGHTS or
+        cmsg->cmsg_len != CMSG_LEN(sizeof(fds)))
+        return false;
+    std::memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+    return true;
+}
+
+static bool recv_request(int fd, CompileRequest &request) {
+    int fds[3];
+    if (not recv_std_fds(fd, fds))
+        return false;
+    for (int i = 0; i < 3; i++) {
+        dup2(fds[i], i);
+        close(fds[i]);
+    }
+
+    std::string args;
+    if (not recv_frame(fd, request.cwd) or not recv_frame(fd, args) or
+        not recv_frame(fd, request.source))
+        return false;
+    request.args.clear();
+    for (size_t begin = 0; begin < args.size();) {
+        auto end = args.find('\0', begin);
+        if (end == std::string::npos)
+            end = args.size();
+        request.args.push_back(args.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return true;
+}
+
+static bool send_response(int fd, const CompileResponse &response) {
+    return send_frame(fd, std::to_string(response.status)) and
+           send_frame(fd, response.output_file) and
+           send_frame(fd, response.output);
+}
+
+static sockaddr_un make_address(const std::string &socket_path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socket_path.c_str(),
+                 sizeof(addr.sun_path) - 1);
+    return addr;
+}
+
+static void serve(int conn, const RequestHandler &handler) {
+    CompileRequest request;
+    if (not recv_request(conn, request))
+        exit(-1);
+    if (chdir(request.cwd.c_str()) != 0) {
+        std::cerr << "cannot enter directory " << request.cwd << std::endl;
+        exit(-1);
+    }
+    auto response = handler(request);
+    std::cout.flush();
+    std::cerr.flush();
+    send_response(conn, response);
+    exit(0);
+}
+
+int run_server(const std::string &socket_path, const RequestHandler &handler) {
+    if (socket_path.size() >= sizeof(sockaddr_un::sun_path)) {
+        std::cerr << "socket path too long: " << socket_path << std::endl;
+        return -1;
+    }
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    auto addr = make_address(socket_path);
+    // remove the socket left by a previous server
+    unlink(socket_path.c_str());
+    if (listen_fd < 0 or
+        bind(listen_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) <
+            0 or
+        listen(listen_fd, SOMAXCONN) < 0) {
+        std::cerr << "cannot listen on " << socket_path << ": "
+                  << std::strerror(errno) << std::endl;
+        return -1;
+    }
+    // finished requests are reaped automatically
+    signal(SIGCHLD, SIG_IGN);
+
+    while (true) {
+        int conn = accept(listen_fd, nullptr, nullptr);
+        if (conn < 0) {
+            if (errno == EINTR)
+                continue;
+            std::cerr << "accept failed: " << std::strerror(errno)
+                      << std::endl;
+            return -1;
+        }
+        auto pid = fork();
+        if (pid == 0) {
+            close(listen_fd);
+            signal(SIGCHLD, SIG_DFL);
+            serve(conn, handler);
+        }
+        if (pid < 0)
+            std::cerr << "fork failed: " << std::strerror(errno) << std::endl;
+        close(conn);
+    }
+}
+
+int connect_server(const std::string &socket_path) {
+    if (socket_path.size() >= sizeof(sockaddr_un::sun_path))
+        return -1;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    auto addr = make_address(socket_path);
+    if (fd < 0 or
+        connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool send_request(int fd, const CompileRequest &request) {
+    std::string args;
+    for (auto &arg : request.args) {
+        args += arg;
+        args += '\0';
+    }
+    if (not args.empty())
+        args.pop_back();
+    return send_std_fds(fd) and send_frame(fd, request.cwd) and
+           send_frame(fd, args) and send_frame(fd, request.source);
+}
+
+bool recv_response(int fd, CompileResponse &response) {
+    std::string status;
+    if (not recv_frame(fd, status) or
+        not recv_frame(fd, response.output_file) or
+        not recv_frame(fd, response.output))
+        return false;
+    response.status = std::atoi(status.c_str());
+    return true;
+}
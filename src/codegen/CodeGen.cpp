@@ -66,14 +66,14 @@ void CodeGen::load_to_greg(Value *val, const Reg &reg) {
     assert(val->get_type()->is_integer_type() ||
            val->get_type()->is_pointer_type());
 
-    if (auto *constant = dynamic_cast<ConstantInt *>(val)) {
+    if (auto *constant = dyn_cast<ConstantInt>(val)) {
         int32_t val = constant->get_value();
         if (IS_IMM_12(val)) {
             append_inst(ADDI WORD, {reg.print(), "$zero", std::to_string(val)});
         } else {
             load_large_int32(val, reg);
         }
-    } else if (auto *global = dynamic_cast<GlobalVariable *>(val)) {
+    } else if (auto *global = dyn_cast<GlobalVariable>(val)) {
         append_inst(LOAD_ADDR, {reg.print(), global->get_name()});
     } else {
         load_from_stack_to_greg(val, reg);
@@ -152,7 +152,7 @@ void CodeGen::store_from_greg(Value *val, const Reg &reg) {
 
 void CodeGen::load_to_freg(Value *val, const FReg &freg) {
     assert(val->get_type()->is_float_type());
-    if (auto *constant = dynamic_cast<ConstantFP *>(val)) {
+    if (auto *constant = dyn_cast<ConstantFP>(val)) {
         float val = constant->get_value();
         load_float_imm(val, freg);
     } else {
@@ -613,6 +613,7 @@ void CodeGen::run() {
             // 更新 context
             context.clear();
             context.func = &func;
+            context.label_prefix = "." + func.get_name() + "_";
 
             // 函数信息
             append_inst(".globl", {func.get_name()}, ASMInstruction::Atrribute);
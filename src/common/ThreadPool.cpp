@@ -0,0 +1,86 @@
+#include "ThreadPool.hpp"
+
+ThreadPool::ThreadPool(unsigned num_threads) {
+    if (num_threads == 0)
+        num_threads = 1;
+    for (unsigned i = 0; i < num_threads; i++)
+        queues_.emplace_back(std::make_unique<WorkQueue>());
+    for (unsigned i = 0; i < num_threads; i++)
+        threads_.emplace_back([this, i]() { worker_loop(i); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto &thread : threads_)
+        thread.join();
+}
+
+void ThreadPool::submit(Task task) {
+    // 入队前计数，保证任务完成时 pending_ 不会先于计数减到 0
+    pending_++;
+    auto &queue = *queues_[next_queue_++ % queues_.size()];
+    {
+        // 任务入队后才计入 queued_，与出队时的减少同在队列锁内，
+        // 被唤醒的线程看到 queued_ > 0 时一定能取到任务
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+        queued_++;
+    }
+    // 工作线程在 mutex_ 内检查 queued_ 后才睡眠，
+    // 先获取一次 mutex_ 再通知，避免通知落在检查和睡眠之间而丢失
+    { std::lock_guard<std::mutex> lock(mutex_); }
+    work_cv_.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this]() { return pending_ == 0; });
+}
+
+bool ThreadPool::try_pop(unsigned id, Task &task) {
+    // 先取自己队列的头部
+    {
+        auto &own = *queues_[id];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (not own.tasks.empty()) {
+            task = std::move(own.tasks.front());
+            own.tasks.pop_front();
+            queued_--;
+            return true;
+        }
+    }
+    // 再从其他队列的尾部窃取
+    for (unsigned i = 1; i < queues_.size(); i++) {
+        auto &victim = *queues_[(id + i) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (not victim.tasks.empty()) {
+            task = std::move(victim.tasks.back());
+            victim.tasks.pop_back();
+            queued_--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::worker_loop(unsigned id) {
+    while (true) {
+        Task task;
+        if (try_pop(id, task)) {
+            task(id);
+            if (--pending_ == 0) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                done_cv_.notify_all();
+            }
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        work_cv_.wait(lock, [this]() { return stop_ or queued_ > 0; });
+        if (stop_ and queued_ == 0)
+            return;
+    }
+}
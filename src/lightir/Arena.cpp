@@ -0,0 +1,30 @@
+#include "Arena.hpp"
+
+#include <cstdint>
+
+static char *align_up(char *ptr, size_t align) {
+    auto addr = reinterpret_cast<uintptr_t>(ptr);
+    return reinterpret_cast<char *>((addr + align - 1) & ~(align - 1));
+}
+
+void *Arena::allocate(size_t size, size_t align) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (cur_) {
+        auto ptr = align_up(cur_, align);
+        if (ptr + size <= end_) {
+            cur_ = ptr + size;
+            return ptr;
+        }
+    }
+
+    // large objects get a slab of their own, the current slab stays in use
+    if (size + align > slab_size / 4) {
+        slabs_.emplace_back(new char[size + align]);
+        return align_up(slabs_.back().get(), align);
+    }
+    slabs_.emplace_back(new char[slab_size]);
+    auto ptr = align_up(slabs_.back().get(), align);
+    cur_ = ptr + size;
+    end_ = slabs_.back().get() + slab_size;
+    return ptr;
+}
@@ -8,11 +8,52 @@
 
 BasicBlock::BasicBlock(Module *m, const std::string &name = "",
                        Function *parent = nullptr)
-    : Value(m->get_label_type(), name), parent_(parent) {
+    : Value(BasicBlockVal, m->get_label_type(), name), parent_(parent) {
     assert(parent && "currently parent should not be nullptr");
     parent_->add_basic_block(this);
 }
 
+BasicBlock::~BasicBlock() {
+    // the branches to this block drop their edges while it is still whole,
+    // ~Value would only get to them after pre_bbs_ is gone
+    replace_all_use_with(nullptr);
+}
+
+void BasicBlock::insert_edge(BasicBlock *from, unsigned idx, BasicBlock *to) {
+    from->succ_bbs_.insert(from->succ_bbs_.begin() + idx, to);
+    from->succ_mates_.insert(from->succ_mates_.begin() + idx,
+                             to->pre_bbs_.size());
+    to->pre_bbs_.push_back(from);
+    to->pre_mates_.push_back(idx);
+    renumber_succs(from, idx + 1);
+}
+
+void BasicBlock::erase_edge(BasicBlock *from, unsigned idx) {
+    auto to = from->succ_bbs_[idx];
+    unsigned pre_idx = from->succ_mates_[idx];
+
+    // the last predecessor of to takes the place of the edge
+    unsigned last = to->pre_bbs_.size() - 1;
+    if (pre_idx != last) {
+        auto moved = to->pre_bbs_[last];
+        to->pre_bbs_[pre_idx] = moved;
+        to->pre_mates_[pre_idx] = to->pre_mates_[last];
+        moved->succ_mates_[to->pre_mates_[pre_idx]] = pre_idx;
+    }
+    to->pre_bbs_.pop_back();
+    to->pre_mates_.pop_back();
+
+    from->succ_bbs_.erase(from->succ_bbs_.begin() + idx);
+    from->succ_mates_.erase(from->succ_mates_.begin() + idx);
+    renumber_succs(from, idx);
+}
+
+// the successors from idx on have moved, a block has at most two of them
+void BasicBlock::renumber_succs(BasicBlock *from, unsigned idx) {
+    for (unsigned i = idx; i < from->succ_bbs_.size(); i++)
+        from->succ_bbs_[i]->pre_mates_[from->succ_mates_[i]] = i;
+}
+
 Module *BasicBlock::get_module() { return get_parent()->get_parent(); }
 void BasicBlock::erase_from_parent() { this->get_parent()->remove(this); }
 
@@ -35,14 +76,26 @@ Instruction *BasicBlock::get_terminator() {
     return &instr_list_.back();
 }
 
+void BasicBlock::take_index(Instruction *instr) {
+    // an instruction moved to another block of the function keeps its index
+    if (instr->index_ == Instruction::no_index)
+        instr->index_ = parent_->num_inst_indices_++;
+}
+
 void BasicBlock::add_instruction(Instruction *instr) {
     assert(not is_terminated() && "Inserting instruction to terminated bb");
+    take_index(instr);
     instr_list_.push_back(instr);
 }
 
+void BasicBlock::add_instr_begin(Instruction *instr) {
+    take_index(instr);
+    instr_list_.push_front(instr);
+}
+
 std::string BasicBlock::print() {
     std::string bb_ir;
-    bb_ir += this->get_name();
+    this->append_name(bb_ir);
     bb_ir += ":";
     // print prebb
     if (!this->get_pre_basic_blocks().empty()) {
@@ -69,3 +122,5 @@ std::string BasicBlock::print() {
 
     return bb_ir;
 }
+
+void BasicBlock::print(std::ostream &os) { os << print(); }
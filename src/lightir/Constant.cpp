@@ -1,45 +1,21 @@
 #include "Constant.hpp"
 #include "Module.hpp"
 
+#include <cstring>
 #include <iostream>
-#include <memory>
 #include <sstream>
-#include <unordered_map>
-
-struct pair_hash {
-    template <typename T>
-    std::size_t operator()(const std::pair<T, Module *> val) const {
-        auto lhs = std::hash<T>()(val.first);
-        auto rhs =
-            std::hash<uintptr_t>()(reinterpret_cast<uintptr_t>(val.second));
-        return lhs ^ rhs;
-    }
-};
-
-static std::unordered_map<std::pair<int, Module *>,
-                          std::unique_ptr<ConstantInt>, pair_hash>
-    cached_int;
-static std::unordered_map<std::pair<bool, Module *>,
-                          std::unique_ptr<ConstantInt>, pair_hash>
-    cached_bool;
-static std::unordered_map<std::pair<float, Module *>,
-                          std::unique_ptr<ConstantFP>, pair_hash>
-    cached_float;
-static std::unordered_map<Type *, std::unique_ptr<ConstantZero>> cached_zero;
 
 ConstantInt *ConstantInt::get(int val, Module *m) {
-    if (cached_int.find(std::make_pair(val, m)) != cached_int.end())
-        return cached_int[std::make_pair(val, m)].get();
-    return (cached_int[std::make_pair(val, m)] = std::unique_ptr<ConstantInt>(
-                new ConstantInt(m->get_int32_type(), val)))
-        .get();
+    auto ty = m->get_int32_type();
+    return static_cast<ConstantInt *>(m->get_constants().get(
+        {ConstantIntVal, ty, uint32_t(val), nullptr},
+        [&]() { return new (m) ConstantInt(ty, val); }));
 }
 ConstantInt *ConstantInt::get(bool val, Module *m) {
-    if (cached_bool.find(std::make_pair(val, m)) != cached_bool.end())
-        return cached_bool[std::make_pair(val, m)].get();
-    return (cached_bool[std::make_pair(val, m)] = std::unique_ptr<ConstantInt>(
-                new ConstantInt(m->get_int1_type(), val ? 1 : 0)))
-        .get();
+    auto ty = m->get_int1_type();
+    return static_cast<ConstantInt *>(m->get_constants().get(
+        {ConstantIntVal, ty, val ? 1u : 0u, nullptr},
+        [&]() { return new (m) ConstantInt(ty, val ? 1 : 0); }));
 }
 std::string ConstantInt::print() {
     std::string const_ir;
@@ -56,9 +32,9 @@ std::string ConstantInt::print() {
 }
 
 ConstantArray::ConstantArray(ArrayType *ty, const std::vector<Constant *> &val)
-    : Constant(ty, "") {
-    for (unsigned i = 0; i < val.size(); i++)
-        set_operand(i, val[i]);
+    : Constant(ConstantArrayVal, ty, "") {
+    for (auto element : val)
+        add_operand(element);
     this->const_array.assign(val.begin(), val.end());
 }
 
@@ -68,7 +44,10 @@ Constant *ConstantArray::get_element_value(int index) {
 
 ConstantArray *ConstantArray::get(ArrayType *ty,
                                   const std::vector<Constant *> &val) {
-    return new ConstantArray(ty, val);
+    auto m = ty->get_module();
+    return static_cast<ConstantArray *>(m->get_constants().get(
+        {ConstantArrayVal, ty, 0, &val},
+        [&]() { return new (m) ConstantArray(ty, val); }));
 }
 
 std::string ConstantArray::print() {
@@ -78,7 +57,7 @@ std::string ConstantArray::print() {
     const_ir += "[";
     for (unsigned i = 0; i < this->get_size_of_array(); i++) {
         Constant *element = get_element_value(i);
-        if (!dynamic_cast<ConstantArray *>(get_element_value(i))) {
+        if (!dyn_cast<ConstantArray>(get_element_value(i))) {
             const_ir += element->get_type()->print();
         }
         const_ir += element->print();
@@ -91,11 +70,12 @@ std::string ConstantArray::print() {
 }
 
 ConstantFP *ConstantFP::get(float val, Module *m) {
-    if (cached_float.find(std::make_pair(val, m)) != cached_float.end())
-        return cached_float[std::make_pair(val, m)].get();
-    return (cached_float[std::make_pair(val, m)] = std::unique_ptr<ConstantFP>(
-                new ConstantFP(m->get_float_type(), val)))
-        .get();
+    auto ty = m->get_float_type();
+    uint32_t bits;
+    std::memcpy(&bits, &val, sizeof(bits));
+    return static_cast<ConstantFP *>(m->get_constants().get(
+        {ConstantFPVal, ty, bits, nullptr},
+        [&]() { return new (m) ConstantFP(ty, val); }));
 }
 
 std::string ConstantFP::print() {
@@ -108,9 +88,9 @@ std::string ConstantFP::print() {
 }
 
 ConstantZero *ConstantZero::get(Type *ty, Module *m) {
-    if (not cached_zero[ty])
-        cached_zero[ty] = std::unique_ptr<ConstantZero>(new ConstantZero(ty));
-    return cached_zero[ty].get();
+    return static_cast<ConstantZero *>(m->get_constants().get(
+        {ConstantZeroVal, ty, 0, nullptr},
+        [&]() { return new (m) ConstantZero(ty); }));
 }
 
 std::string ConstantZero::print() { return "zeroinitializer"; }
@@ -0,0 +1,41 @@
+#include "ConstantTable.hpp"
+#include "Constant.hpp"
+
+#include <cstring>
+
+uint64_t ConstantKeyInfo::hash(const ConstantKey &key) {
+    auto h = hash_mix(reinterpret_cast<uintptr_t>(key.type) ^ key.kind);
+    h = hash_mix(h ^ key.bits);
+    if (key.elements) {
+        for (auto element : *key.elements)
+            h = hash_mix(h ^ reinterpret_cast<uintptr_t>(element));
+    }
+    return h;
+}
+
+bool ConstantKeyInfo::matches(Constant *constant, const ConstantKey &key) {
+    if (constant->get_value_kind() != key.kind or
+        constant->get_type() != key.type)
+        return false;
+    switch (key.kind) {
+    case Value::ConstantIntVal:
+        return uint32_t(constant->as<ConstantInt>()->get_value()) == key.bits;
+    case Value::ConstantFPVal: {
+        float val = constant->as<ConstantFP>()->get_value();
+        uint32_t bits;
+        std::memcpy(&bits, &val, sizeof(bits));
+        return bits == key.bits;
+    }
+    case Value::ConstantArrayVal:
+        return constant->as<ConstantArray>()->get_elements() == *key.elements;
+    default:
+        return true;
+    }
+}
+
+void ConstantTable::clear() {
+    // arrays use other constants, drop those edges before any is destroyed
+    for_each([](Constant *constant) { constant->drop_all_references(); });
+    for_each([](Constant *constant) { delete constant; });
+    reset();
+}
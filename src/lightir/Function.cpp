@@ -2,8 +2,13 @@
 #include "IRprinter.hpp"
 #include "Module.hpp"
 
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
 Function::Function(FunctionType *ty, const std::string &name, Module *parent)
-    : Value(ty, name), parent_(parent), seq_cnt_(0) {
+    : Value(FunctionVal, ty, name), parent_(parent), seq_cnt_(0) {
+    set_module_level();
     // num_args_ = ty->getNumParams();
     parent->add_function(this);
     // build args
@@ -13,7 +18,7 @@ Function::Function(FunctionType *ty, const std::string &name, Module *parent)
 }
 Function *Function::create(FunctionType *ty, const std::string &name,
                            Module *parent) {
-    return new Function(ty, name, parent);
+    return new (parent) Function(ty, name, parent);
 }
 
 FunctionType *Function::get_function_type() const {
@@ -32,100 +37,107 @@ unsigned Function::get_num_basic_blocks() const { return basic_blocks_.size(); }
 
 Module *Function::get_parent() const { return parent_; }
 
-void Function::remove(BasicBlock *bb) {
-    basic_blocks_.remove(bb);
-    for (auto pre : bb->get_pre_basic_blocks()) {
-        pre->remove_succ_basic_block(bb);
-    }
-    for (auto succ : bb->get_succ_basic_blocks()) {
-        succ->remove_pre_basic_block(bb);
-    }
+// the edges of bb stay until its branches, or those to it, are deleted
+void Function::remove(BasicBlock *bb) { basic_blocks_.remove(bb); }
+
+void Function::add_basic_block(BasicBlock *bb) {
+    bb->index_ = num_block_indices_++;
+    basic_blocks_.push_back(bb);
 }
 
-void Function::add_basic_block(BasicBlock *bb) { basic_blocks_.push_back(bb); }
+void Function::renumber() {
+    num_block_indices_ = 0;
+    num_inst_indices_ = 0;
+    for (auto &bb : basic_blocks_) {
+        bb.index_ = num_block_indices_++;
+        for (auto &instr : bb.get_instructions())
+            instr.index_ = num_inst_indices_++;
+    }
+}
 
 void Function::set_instr_name() {
-    std::map<Value *, int> seq;
+    // the numbers are kept in the names, their text is made when printed
     for (auto &arg : this->get_args()) {
-        if (seq.find(&arg) == seq.end()) {
-            auto seq_num = seq.size() + seq_cnt_;
-            if (arg.set_name("arg" + std::to_string(seq_num))) {
-                seq.insert({&arg, seq_num});
-            }
-        }
+        if (arg.set_name(Symbol::numbered(Symbol::Arg, seq_cnt_)))
+            seq_cnt_++;
     }
-    for (auto &bb1 : basic_blocks_) {
-        auto bb = &bb1;
-        if (seq.find(bb) == seq.end()) {
-            auto seq_num = seq.size() + seq_cnt_;
-            if (bb->set_name("label" + std::to_string(seq_num))) {
-                seq.insert({bb, seq_num});
-            }
-        }
-        for (auto &instr : bb->get_instructions()) {
-            if (!instr.is_void() && seq.find(&instr) == seq.end()) {
-                auto seq_num = seq.size() + seq_cnt_;
-                if (instr.set_name("op" + std::to_string(seq_num))) {
-                    seq.insert({&instr, seq_num});
-                }
-            }
+    for (auto &bb : basic_blocks_) {
+        if (bb.set_name(Symbol::numbered(Symbol::Label, seq_cnt_)))
+            seq_cnt_++;
+        for (auto &instr : bb.get_instructions()) {
+            if (!instr.is_void() and
+                instr.set_name(Symbol::numbered(Symbol::Op, seq_cnt_)))
+                seq_cnt_++;
         }
     }
-    seq_cnt_ += seq.size();
+}
+
+void Function::set_printed_name(Value *v, std::string_view name) {
+    Symbol::Prefix prefix;
+    uintptr_t num;
+    if (Symbol::parse_numbered(name, prefix, num) and
+        num < std::numeric_limits<unsigned>::max()) {
+        v->set_name(Symbol::numbered(prefix, num));
+        seq_cnt_ = std::max(seq_cnt_, unsigned(num) + 1);
+    } else {
+        v->set_name(std::string(name));
+    }
 }
 
 std::string Function::print() {
+    std::ostringstream func_ir;
+    print(func_ir);
+    return func_ir.str();
+}
+
+void Function::print(std::ostream &os) {
     set_instr_name();
-    std::string func_ir;
     if (this->is_declaration()) {
-        func_ir += "declare ";
+        os << "declare ";
     } else {
-        func_ir += "define ";
+        os << "define ";
     }
 
-    func_ir += this->get_return_type()->print();
-    func_ir += " ";
-    func_ir += print_as_op(this, false);
-    func_ir += "(";
+    os << this->get_return_type()->print();
+    os << " ";
+    os << print_as_op(this, false);
+    os << "(";
 
     // print arg
     if (this->is_declaration()) {
         for (unsigned i = 0; i < this->get_num_of_args(); i++) {
             if (i)
-                func_ir += ", ";
-            func_ir += static_cast<FunctionType *>(this->get_type())
-                           ->get_param_type(i)
-                           ->print();
+                os << ", ";
+            os << static_cast<FunctionType *>(this->get_type())
+                      ->get_param_type(i)
+                      ->print();
         }
     } else {
         for (auto &arg : get_args()) {
             if (&arg != &*get_args().begin())
-                func_ir += ", ";
-            func_ir += arg.print();
+                os << ", ";
+            os << arg.print();
         }
     }
-    func_ir += ")";
+    os << ")";
 
     // print bb
     if (this->is_declaration()) {
-        func_ir += "\n";
+        os << "\n";
     } else {
-        func_ir += " {";
-        func_ir += "\n";
-        for (auto &bb1 : this->get_basic_blocks()) {
-            auto bb = &bb1;
-            func_ir += bb->print();
+        os << " {";
+        os << "\n";
+        for (auto &bb : this->get_basic_blocks()) {
+            bb.print(os);
         }
-        func_ir += "}";
+        os << "}";
     }
-
-    return func_ir;
 }
 
 std::string Argument::print() {
     std::string arg_ir;
     arg_ir += this->get_type()->print();
     arg_ir += " %";
-    arg_ir += this->get_name();
+    this->append_name(arg_ir);
     return arg_ir;
 }
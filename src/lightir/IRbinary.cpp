@@ -0,0 +1,742 @@
+#include "IRbinary.hpp"
+#include "BasicBlock.hpp"
+#include "Constant.hpp"
+#include "Function.hpp"
+#include "GlobalVariable.hpp"
+#include "Instruction.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <list>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+const char binary_magic[4] = {'L', 'I', 'R', 'B'};
+const unsigned binary_version = 1;
+
+enum OperandTag : unsigned { DefinedRef, ConstantRef, ForwardRef };
+
+uint64_t zigzag(int64_t v) { return (uint64_t(v) << 1) ^ uint64_t(v >> 63); }
+int64_t unzigzag(uint64_t v) { return int64_t(v >> 1) ^ -int64_t(v & 1); }
+
+void put(std::string &buf, uint64_t v) {
+    while (v >= 0x80) {
+        buf += char(v | 0x80);
+        v >>= 7;
+    }
+    buf += char(v);
+}
+
+class BinaryWriter {
+  public:
+    explicit BinaryWriter(Module *m) : m_(m) {}
+    void write(std::ostream &os);
+
+  private:
+    unsigned get_string(const std::string &s);
+    unsigned get_type(Type *ty);
+    unsigned get_constant(Constant *c);
+    void put_operand(Value *v);
+    void write_body(Function &func);
+
+    Module *m_;
+    // sections are built separately, strings, types and constants are
+    // collected while the globals and functions are written
+    std::string strings_, types_, constants_, body_;
+    unsigned num_strings_{1}, num_types_{0}, num_constants_{0};
+    std::unordered_map<std::string, unsigned> string_ids_;
+    std::unordered_map<Type *, unsigned> type_ids_;
+    std::unordered_map<Constant *, unsigned> constant_ids_;
+    // globals and functions, then the values of the current function
+    std::unordered_map<Value *, unsigned> value_ids_;
+    std::unordered_map<Value *, unsigned> local_ids_;
+    // id of the instruction being written, larger ids are forward refs
+    unsigned cur_id_{0};
+};
+
+unsigned BinaryWriter::get_string(const std::string &s) {
+    if (s.empty())
+        return 0;
+    auto [iter, inserted] = string_ids_.emplace(s, num_strings_);
+    if (inserted) {
+        num_strings_++;
+        put(strings_, s.size());
+        strings_ += s;
+    }
+    return iter->second;
+}
+
+unsigned BinaryWriter::get_type(Type *ty) {
+    if (auto iter = type_ids_.find(ty); iter != type_ids_.end())
+        return iter->second;
+    // contained types first
+    std::string record;
+    put(record, ty->get_type_id());
+    switch (ty->get_type_id()) {
+    case Type::IntegerTyID:
+        put(record, static_cast<IntegerType *>(ty)->get_num_bits());
+        break;
+    case Type::PointerTyID:
+        put(record, get_type(ty->get_pointer_element_type()));
+        break;
+    case Type::ArrayTyID: {
+        auto *array_ty = static_cast<ArrayType *>(ty);
+        put(record, get_type(array_ty->get_element_type()));
+        put(record, array_ty->get_num_of_elements());
+        break;
+    }
+    case Type::FunctionTyID: {
+        auto *func_ty = static_cast<FunctionType *>(ty);
+        put(record, get_type(func_ty->get_return_type()));
+        put(record, func_ty->get_num_of_args());
+        for (unsigned i = 0; i < func_ty->get_num_of_args(); i++)
+            put(record, get_type(func_ty->get_param_type(i)));
+        break;
+    }
+    default:
+        break;
+    }
+    types_ += record;
+    return type_ids_[ty] = num_types_++;
+}
+
+unsigned BinaryWriter::get_constant(Constant *c) {
+    if (auto iter = constant_ids_.find(c); iter != constant_ids_.end())
+        return iter->second;
+    std::string record;
+    put(record, c->get_value_kind());
+    put(record, get_type(c->get_type()));
+    if (auto *int_val = dyn_cast<ConstantInt>(c)) {
+        put(record, zigzag(int_val->get_value()));
+    } else if (auto *fp_val = dyn_cast<ConstantFP>(c)) {
+        float val = fp_val->get_value();
+        uint32_t bits;
+        std::memcpy(&bits, &val, sizeof(bits));
+        put(record, bits);
+    } else if (auto *array = dyn_cast<ConstantArray>(c)) {
+        put(record, array->get_size_of_array());
+        for (unsigned i = 0; i < array->get_size_of_array(); i++)
+            put(record, get_constant(array->get_element_value(i)));
+    }
+    constants_ += record;
+    return constant_ids_[c] = num_constants_++;
+}
+
+void BinaryWriter::put_operand(Value *v) {
+    if (auto *c = dyn_cast<Constant>(v)) {
+        put(body_, get_constant(c) << 2 | ConstantRef);
+        return;
+    }
+    auto iter = local_ids_.find(v);
+    auto id = iter != local_ids_.end() ? iter->second : value_ids_.at(v);
+    if (id < cur_id_) {
+        put(body_, id << 2 | DefinedRef);
+    } else {
+        put(body_, id << 2 | ForwardRef);
+        put(body_, get_type(v->get_type()));
+    }
+}
+
+void BinaryWriter::write_body(Function &func) {
+    // args and blocks are numbered before any instruction is read back
+    local_ids_.clear();
+    auto id = value_ids_.size();
+    for (auto &arg : func.get_args())
+        local_ids_[&arg] = id++;
+    for (auto &bb : func.get_basic_blocks())
+        local_ids_[&bb] = id++;
+    auto first_inst = id;
+    for (auto &bb : func.get_basic_blocks()) {
+        for (auto &inst : bb.get_instructions())
+            local_ids_[&inst] = id++;
+    }
+
+    put(body_, func.get_num_basic_blocks());
+    for (auto &arg : func.get_args())
+        put(body_, get_string(arg.get_name()));
+    for (auto &bb : func.get_basic_blocks()) {
+        put(body_, get_string(bb.get_name()));
+        put(body_, bb.get_num_of_instr());
+    }
+    cur_id_ = first_inst;
+    for (auto &bb : func.get_basic_blocks()) {
+        for (auto &inst : bb.get_instructions()) {
+            put(body_, inst.get_instr_type());
+            put(body_, get_string(inst.get_name()));
+            put(body_, get_type(inst.get_type()));
+            put(body_, inst.get_num_operand());
+            for (auto *op : inst.get_operands())
+                put_operand(op);
+            cur_id_++;
+        }
+    }
+}
+
+void BinaryWriter::write(std::ostream &os) {
+    // the names given by the printer are kept, so the module prints the same
+    // after it is read back
+    m_->set_print_name();
+    // every global and function is numbered before the bodies refer to them
+    for (auto &global : m_->get_global_variable())
+        value_ids_.emplace(&global, value_ids_.size());
+    for (auto &func : m_->get_functions())
+        value_ids_.emplace(&func, value_ids_.size());
+
+    put(body_, m_->get_global_variable().size());
+    for (auto &global : m_->get_global_variable()) {
+        put(body_, get_string(global.get_name()));
+        put(body_, get_type(global.get_type()->get_pointer_element_type()));
+        put(body_, global.is_const());
+        put(body_, global.get_init() ? get_constant(global.get_init()) + 1 : 0);
+    }
+    put(body_, m_->get_functions().size());
+    for (auto &func : m_->get_functions()) {
+        put(body_, get_string(func.get_name()));
+        put(body_, get_type(func.get_function_type()));
+    }
+    for (auto &func : m_->get_functions())
+        write_body(func);
+
+    std::string header(binary_magic, sizeof(binary_magic));
+    put(header, binary_version);
+    put(header, num_strings_ - 1);
+    os << header << strings_;
+    header.clear();
+    put(header, num_types_);
+    os << header << types_;
+    header.clear();
+    put(header, num_constants_);
+    os << header << constants_ << body_;
+}
+
+/*
+ * Reads the sections in order. Malformed input only sets failed_ and makes
+ * the lookups return nullptr, so read() checks it before building anything
+ * from what it has read.
+ */
+class BinaryReader {
+  public:
+    BinaryReader(const char *data, size_t size)
+        : cur_(data), end_(data + size) {}
+    std::unique_ptr<Module> read();
+
+  private:
+    uint64_t get();
+    // a count of items that take at least one byte each
+    uint64_t get_count();
+    std::string get_string();
+    Type *get_type();
+    Constant *get_constant(uint64_t id);
+    Value *get_operand();
+    void read_type();
+    void read_constant();
+    void read_body(Function *func);
+    Instruction *create_inst(Instruction::OpID op, Type *ty,
+                             const std::vector<Value *> &ops, BasicBlock *bb);
+
+    template <typename T> T *check(Value *v) {
+        auto *res = dyn_cast<T>(v);
+        failed_ |= res == nullptr;
+        return res;
+    }
+
+    const char *cur_;
+    const char *end_;
+    bool failed_{false};
+    std::unique_ptr<Module> m_;
+    std::vector<std::string> strings_;
+    std::vector<Type *> types_;
+    std::vector<Constant *> constants_;
+    std::vector<Value *> values_;
+    // placeholders for instructions used before they are read, replaced
+    // once the instruction is created
+    std::list<Argument> placeholders_;
+    std::unordered_map<unsigned, Argument *> forward_;
+};
+
+uint64_t BinaryReader::get() {
+    uint64_t v = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (cur_ == end_) {
+            failed_ = true;
+            return 0;
+        }
+        auto byte = static_cast<uint8_t>(*cur_++);
+        v |= uint64_t(byte & 0x7f) << shift;
+        if (not(byte & 0x80))
+            return v;
+    }
+    failed_ = true;
+    return 0;
+}
+
+uint64_t BinaryReader::get_count() {
+    auto num = get();
+    if (num > uint64_t(end_ - cur_)) {
+        failed_ = true;
+        return 0;
+    }
+    return num;
+}
+
+std::string BinaryReader::get_string() {
+    auto id = get();
+    if (id >= strings_.size()) {
+        failed_ = true;
+        return "";
+    }
+    return strings_[id];
+}
+
+Type *BinaryReader::get_type() {
+    auto id = get();
+    if (id >= types_.size()) {
+        failed_ = true;
+        return nullptr;
+    }
+    return types_[id];
+}
+
+Constant *BinaryReader::get_constant(uint64_t id) {
+    if (id >= constants_.size()) {
+        failed_ = true;
+        return nullptr;
+    }
+    return constants_[id];
+}
+
+void BinaryReader::read_type() {
+    Type *ty = nullptr;
+    switch (get()) {
+    case Type::VoidTyID:
+        ty = m_->get_void_type();
+        break;
+    case Type::LabelTyID:
+        ty = m_->get_label_type();
+        break;
+    case Type::IntegerTyID: {
+        auto bits = get();
+        if (bits == 1)
+            ty = m_->get_int1_type();
+        else if (bits == 32)
+            ty = m_->get_int32_type();
+        break;
+    }
+    case Type::FloatTyID:
+        ty = m_->get_float_type();
+        break;
+    case Type::PointerTyID: {
+        auto *elem = get_type();
+        if (elem and not(elem->is_void_type() or elem->is_label_type() or
+                         elem->is_function_type()))
+            ty = m_->get_pointer_type(elem);
+        break;
+    }
+    case Type::ArrayTyID: {
+        auto *elem = get_type();
+        auto num = get();
+        if (elem and ArrayType::is_valid_element_type(elem) and
+            num <= UINT32_MAX)
+            ty = m_->get_array_type(elem, num);
+        break;
+    }
+    case Type::FunctionTyID: {
+        auto *result = get_type();
+        std::vector<Type *> params(get_count());
+        for (auto &param : params) {
+            param = get_type();
+            if (param and not FunctionType::is_valid_argument_type(param))
+                failed_ = true;
+        }
+        if (not failed_ and FunctionType::is_valid_return_type(result))
+            ty = m_->get_function_type(result, params);
+        break;
+    }
+    }
+    failed_ |= ty == nullptr;
+    types_.push_back(ty);
+}
+
+void BinaryReader::read_constant() {
+    auto kind = get();
+    auto *ty = get_type();
+    Constant *c = nullptr;
+    switch (kind) {
+    case Value::ConstantIntVal: {
+        int val = unzigzag(get());
+        if (ty == m_->get_int1_type())
+            c = ConstantInt::get(val != 0, m_.get());
+        else if (ty == m_->get_int32_type())
+            c = ConstantInt::get(val, m_.get());
+        break;
+    }
+    case Value::ConstantFPVal: {
+        uint32_t bits = get();
+        float val;
+        std::memcpy(&val, &bits, sizeof(val));
+        if (ty == m_->get_float_type())
+            c = ConstantFP::get(val, m_.get());
+        break;
+    }
+    case Value::ConstantZeroVal:
+        if (ty and (ty->is_integer_type() or ty->is_float_type() or
+                    ty->is_array_type()))
+            c = ConstantZero::get(ty, m_.get());
+        break;
+    case Value::ConstantArrayVal: {
+        std::vector<Constant *> elems(get_count());
+        for (auto &elem : elems)
+            elem = get_constant(get());
+        if (failed_ or not ty or not ty->is_array_type())
+            break;
+        // as many elements as the array type, each of its element type
+        auto *array_ty = static_cast<ArrayType *>(ty);
+        bool matches = elems.size() == array_ty->get_num_of_elements();
+        for (auto *elem : elems)
+            matches &= elem->get_type() == array_ty->get_element_type();
+        if (matches)
+            c = ConstantArray::get(array_ty, elems);
+        break;
+    }
+    }
+    failed_ |= c == nullptr;
+    constants_.push_back(c);
+}
+
+Value *BinaryReader::get_operand() {
+    auto ref = get();
+    auto id = ref >> 2;
+    switch (ref & 3) {
+    case DefinedRef:
+        if (id < values_.size())
+            return values_[id];
+        break;
+    case ConstantRef:
+        return get_constant(id);
+    case ForwardRef: {
+        auto *ty = get_type();
+        if (id < values_.size() or not ty)
+            break;
+        auto &placeholder = forward_[id];
+        if (not placeholder)
+            placeholder = &placeholders_.emplace_back(ty);
+        return placeholder;
+    }
+    }
+    failed_ = true;
+    return nullptr;
+}
+
+/*
+ * Checks the operands of an instruction as IRparser does and creates it, or
+ * returns nullptr if they do not fit the opcode. The instruction
+ * constructors only assert on their operand types, so nothing reaches them
+ * unchecked.
+ */
+Instruction *BinaryReader::create_inst(Instruction::OpID op, Type *ty,
+                                       const std::vector<Value *> &ops,
+                                       BasicBlock *bb) {
+    auto num_ops = ops.size();
+    auto *int1_ty = m_->get_int1_type();
+    auto *int32_ty = m_->get_int32_type();
+    auto *float_ty = m_->get_float_type();
+    auto type_of = [&](unsigned i) { return ops[i]->get_type(); };
+    // two operands of type op_ty
+    auto binary = [&](Type *op_ty, auto create) -> Instruction * {
+        if (num_ops != 2 or type_of(0) != op_ty or type_of(1) != op_ty)
+            return nullptr;
+        return create(ops[0], ops[1], bb);
+    };
+    // one operand, converted to ty
+    auto is_cast = [&](bool src_ok, bool dest_ok) {
+        return num_ops == 1 and src_ok and dest_ok;
+    };
+    auto is_value_type = [](Type *val_ty) {
+        return val_ty->is_integer_type() or val_ty->is_float_type() or
+               val_ty->is_pointer_type();
+    };
+
+    switch (op) {
+    case Instruction::ret: {
+        auto *ret_ty = bb->get_parent()->get_return_type();
+        if (num_ops == 0 and ret_ty->is_void_type())
+            return ReturnInst::create_void_ret(bb);
+        if (num_ops != 1 or ret_ty->is_void_type() or type_of(0) != ret_ty)
+            return nullptr;
+        return ReturnInst::create_ret(ops[0], bb);
+    }
+    case Instruction::br: {
+        if (num_ops == 1 and check<BasicBlock>(ops[0]))
+            return BranchInst::create_br(ops[0]->as<BasicBlock>(), bb);
+        if (num_ops != 3 or type_of(0) != int1_ty or
+            not check<BasicBlock>(ops[1]) or not check<BasicBlock>(ops[2]))
+            return nullptr;
+        return BranchInst::create_cond_br(ops[0], ops[1]->as<BasicBlock>(),
+                                          ops[2]->as<BasicBlock>(), bb);
+    }
+    case Instruction::add:
+        return binary(int32_ty, IBinaryInst::create_add);
+    case Instruction::sub:
+        return binary(int32_ty, IBinaryInst::create_sub);
+    case Instruction::mul:
+        return binary(int32_ty, IBinaryInst::create_mul);
+    case Instruction::sdiv:
+        return binary(int32_ty, IBinaryInst::create_sdiv);
+    case Instruction::fadd:
+        return binary(float_ty, FBinaryInst::create_fadd);
+    case Instruction::fsub:
+        return binary(float_ty, FBinaryInst::create_fsub);
+    case Instruction::fmul:
+        return binary(float_ty, FBinaryInst::create_fmul);
+    case Instruction::fdiv:
+        return binary(float_ty, FBinaryInst::create_fdiv);
+    case Instruction::alloca: {
+        if (num_ops != 0 or not ty->is_pointer_type())
+            return nullptr;
+        auto *elem_ty = ty->get_pointer_element_type();
+        if (not(is_value_type(elem_ty) or elem_ty->is_array_type()))
+            return nullptr;
+        return AllocaInst::create_alloca(elem_ty, bb);
+    }
+    case Instruction::load:
+        if (num_ops != 1 or not type_of(0)->is_pointer_type() or
+            not is_value_type(type_of(0)->get_pointer_element_type()))
+            return nullptr;
+        return LoadInst::create_load(ops[0], bb);
+    case Instruction::store:
+        if (num_ops != 2 or not type_of(1)->is_pointer_type() or
+            type_of(1)->get_pointer_element_type() != type_of(0))
+            return nullptr;
+        return StoreInst::create_store(ops[0], ops[1], bb);
+    case Instruction::ge:
+        return binary(int32_ty, ICmpInst::create_ge);
+    case Instruction::gt:
+        return binary(int32_ty, ICmpInst::create_gt);
+    case Instruction::le:
+        return binary(int32_ty, ICmpInst::create_le);
+    case Instruction::lt:
+        return binary(int32_ty, ICmpInst::create_lt);
+    case Instruction::eq:
+        return binary(int32_ty, ICmpInst::create_eq);
+    case Instruction::ne:
+        return binary(int32_ty, ICmpInst::create_ne);
+    case Instruction::fge:
+        return binary(float_ty, FCmpInst::create_fge);
+    case Instruction::fgt:
+        return binary(float_ty, FCmpInst::create_fgt);
+    case Instruction::fle:
+        return binary(float_ty, FCmpInst::create_fle);
+    case Instruction::flt:
+        return binary(float_ty, FCmpInst::create_flt);
+    case Instruction::feq:
+        return binary(float_ty, FCmpInst::create_feq);
+    case Instruction::fne:
+        return binary(float_ty, FCmpInst::create_fne);
+    case Instruction::phi: {
+        if (num_ops % 2 != 0 or not is_value_type(ty))
+            return nullptr;
+        std::vector<Value *> vals;
+        std::vector<BasicBlock *> val_bbs;
+        for (unsigned i = 0; i < num_ops; i += 2) {
+            vals.push_back(ops[i]);
+            val_bbs.push_back(check<BasicBlock>(ops[i + 1]));
+            failed_ |= type_of(i) != ty;
+        }
+        if (failed_)
+            return nullptr;
+        // create_phi does not insert the phi into bb
+        auto *phi = PhiInst::create_phi(ty, bb, vals, val_bbs);
+        bb->add_instruction(phi);
+        return phi;
+    }
+    case Instruction::call: {
+        auto *func = check<Function>(ops[0]);
+        if (not func or func->get_num_of_args() != num_ops - 1)
+            return nullptr;
+        auto *func_ty = func->get_function_type();
+        for (unsigned i = 1; i < num_ops; i++) {
+            if (type_of(i) != func_ty->get_param_type(i - 1))
+                return nullptr;
+        }
+        return CallInst::create_call(
+            func, std::vector<Value *>(ops.begin() + 1, ops.end()), bb);
+    }
+    case Instruction::getelementptr: {
+        if (not type_of(0)->is_pointer_type())
+            return nullptr;
+        auto *elem_ty = type_of(0)->get_pointer_element_type();
+        if (not(elem_ty->is_array_type() or elem_ty->is_integer_type() or
+                elem_ty->is_float_type()))
+            return nullptr;
+        for (unsigned i = 1; i < num_ops; i++) {
+            if (not type_of(i)->is_integer_type())
+                return nullptr;
+            // every index but the first steps into an array
+            if (i > 1) {
+                if (not elem_ty->is_array_type())
+                    return nullptr;
+                elem_ty = elem_ty->get_array_element_type();
+            }
+        }
+        return GetElementPtrInst::create_gep(
+            ops[0], std::vector<Value *>(ops.begin() + 1, ops.end()), bb);
+    }
+    case Instruction::zext:
+        if (not is_cast(type_of(0) == int1_ty, ty == int32_ty))
+            return nullptr;
+        return ZextInst::create_zext(ops[0], ty, bb);
+    case Instruction::fptosi:
+        if (not is_cast(type_of(0) == float_ty, ty->is_integer_type()))
+            return nullptr;
+        return FpToSiInst::create_fptosi(ops[0], ty, bb);
+    case Instruction::sitofp:
+        if (not is_cast(type_of(0)->is_integer_type(), ty == float_ty))
+            return nullptr;
+        return SiToFpInst::create_sitofp(ops[0], bb);
+    }
+    return nullptr;
+}
+
+void BinaryReader::read_body(Function *func) {
+    auto num_bbs = get_count();
+    for (auto &arg : func->get_args()) {
+        func->set_printed_name(&arg, get_string());
+        values_.push_back(&arg);
+    }
+    std::vector<std::pair<BasicBlock *, uint64_t>> bbs;
+    for (uint64_t i = 0; i < num_bbs and not failed_; i++) {
+        auto name = get_string();
+        auto *bb = BasicBlock::create(m_.get(), "", func);
+        func->set_printed_name(bb, name);
+        bbs.emplace_back(bb, get());
+        values_.push_back(bb);
+    }
+
+    for (auto [bb, num_insts] : bbs) {
+        for (uint64_t i = 0; i < num_insts and not failed_; i++) {
+            auto op = get();
+            auto name = get_string();
+            auto *ty = get_type();
+            std::vector<Value *> ops(get_count());
+            for (auto &val : ops)
+                val = get_operand();
+            // every opcode but alloca and ret void has an operand, and
+            // nothing follows the terminator
+            if (failed_ or op > Instruction::sitofp or
+                (ops.empty() and op != Instruction::alloca and
+                 op != Instruction::ret) or
+                bb->is_terminated()) {
+                failed_ = true;
+                return;
+            }
+            auto *inst = create_inst(static_cast<Instruction::OpID>(op), ty,
+                                     ops, bb);
+            if (not inst or inst->get_type() != ty) {
+                failed_ = true;
+                return;
+            }
+            func->set_printed_name(inst, name);
+            if (auto iter = forward_.find(values_.size());
+                iter != forward_.end()) {
+                // the users were checked against the type of the placeholder
+                if (iter->second->get_type() != ty) {
+                    failed_ = true;
+                    return;
+                }
+                iter->second->replace_all_use_with(inst);
+                forward_.erase(iter);
+            }
+            values_.push_back(inst);
+        }
+        failed_ |= not bb->is_terminated();
+    }
+    // a forward ref past the last instruction of the function
+    failed_ |= not forward_.empty();
+    forward_.clear();
+    placeholders_.clear();
+}
+
+std::unique_ptr<Module> BinaryReader::read() {
+    if (end_ - cur_ < long(sizeof(binary_magic)) or
+        std::memcmp(cur_, binary_magic, sizeof(binary_magic)) != 0)
+        return nullptr;
+    cur_ += sizeof(binary_magic);
+    if (get() != binary_version)
+        return nullptr;
+    m_ = std::make_unique<Module>();
+
+    strings_.resize(get_count() + 1);
+    for (size_t i = 1; i < strings_.size() and not failed_; i++) {
+        auto len = get_count();
+        strings_[i].assign(cur_, len);
+        cur_ += len;
+    }
+    for (auto num = get_count(); num > 0 and not failed_; num--)
+        read_type();
+    for (auto num = get_count(); num > 0 and not failed_; num--)
+        read_constant();
+    for (auto num = get_count(); num > 0 and not failed_; num--) {
+        auto name = get_string();
+        auto *ty = get_type();
+        bool is_const = get();
+        auto init = get();
+        auto *init_val = init ? get_constant(init - 1) : nullptr;
+        // the printer needs an initializer, as the .ll syntax does
+        if (failed_ or not init_val or init_val->get_type() != ty) {
+            failed_ = true;
+            break;
+        }
+        values_.push_back(
+            GlobalVariable::create(name, m_.get(), ty, is_const, init_val));
+    }
+    for (auto num = get_count(); num > 0 and not failed_; num--) {
+        auto name = get_string();
+        auto *ty = get_type();
+        if (failed_ or not ty->is_function_type()) {
+            failed_ = true;
+            break;
+        }
+        values_.push_back(
+            Function::create(static_cast<FunctionType *>(ty), name, m_.get()));
+    }
+    auto num_module_values = values_.size();
+    for (auto &func : m_->get_functions()) {
+        if (failed_)
+            break;
+        values_.resize(num_module_values);
+        read_body(&func);
+    }
+    if (failed_ or cur_ != end_)
+        return nullptr;
+    return std::move(m_);
+}
+} // namespace
+
+void write_binary(Module *m, std::ostream &os) { BinaryWriter(m).write(os); }
+
+std::unique_ptr<Module> read_binary(const char *data, size_t size) {
+    return BinaryReader(data, size).read();
+}
+
+std::unique_ptr<Module> read_binary_file(const std::string &file) {
+    int fd = open(file.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+    struct stat st;
+    if (fstat(fd, &st) != 0 or st.st_size == 0) {
+        close(fd);
+        return nullptr;
+    }
+    auto *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return nullptr;
+    auto m = read_binary(static_cast<const char *>(data), st.st_size);
+    munmap(data, st.st_size);
+    return m;
+}
@@ -0,0 +1,733 @@
+#include "IRparser.hpp"
+#include "BasicBlock.hpp"
+#include "Constant.hpp"
+#include "Function.hpp"
+#include "GlobalVariable.hpp"
+#include "Instruction.hpp"
+
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <sstream>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+struct ParseError {
+    std::string msg;
+};
+
+const std::unordered_map<std::string_view, Instruction::OpID> binary_ops = {
+    {"add", Instruction::add},   {"sub", Instruction::sub},
+    {"mul", Instruction::mul},   {"sdiv", Instruction::sdiv},
+    {"fadd", Instruction::fadd}, {"fsub", Instruction::fsub},
+    {"fmul", Instruction::fmul}, {"fdiv", Instruction::fdiv},
+};
+
+const std::unordered_map<std::string_view, Instruction::OpID> icmp_conds = {
+    {"sge", Instruction::ge}, {"sgt", Instruction::gt},
+    {"sle", Instruction::le}, {"slt", Instruction::lt},
+    {"eq", Instruction::eq},  {"ne", Instruction::ne},
+};
+
+const std::unordered_map<std::string_view, Instruction::OpID> fcmp_conds = {
+    {"uge", Instruction::fge}, {"ugt", Instruction::fgt},
+    {"ule", Instruction::fle}, {"ult", Instruction::flt},
+    {"ueq", Instruction::feq}, {"une", Instruction::fne},
+};
+
+bool is_ident_char(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) or c == '_' or
+           c == '.' or c == '$';
+}
+
+/*
+ * Names are looked up as views into the text, which outlives the parser.
+ * Locals that are used before their definition get a placeholder of the
+ * type given at the use, replaced when the definition is reached.
+ */
+class IRParser {
+  public:
+    IRParser(const char *data, size_t size) : cur_(data), end_(data + size) {}
+    std::unique_ptr<Module> parse();
+    unsigned get_line() const { return line_; }
+
+  private:
+    [[noreturn]] void error(const std::string &msg) { throw ParseError{msg}; }
+
+    void skip_space();
+    bool at_end();
+    bool try_punct(char c);
+    void expect(char c);
+    std::string_view get_ident();
+    bool try_keyword(std::string_view kw);
+    void expect_keyword(std::string_view kw);
+    void skip_string();
+
+    Type *parse_type();
+    Constant *parse_constant(Type *ty);
+    Value *parse_value(Type *ty);
+    Value *parse_typed_value();
+    BasicBlock *parse_label();
+    void expect_type(Value *v, Type *ty);
+
+    void parse_global();
+    void parse_function(bool is_define);
+    void parse_body();
+    void parse_instruction(std::string_view name, std::string_view op);
+    Instruction *parse_call();
+
+    Function *get_function(std::string_view name, FunctionType *ty);
+    BasicBlock *get_block(std::string_view name);
+    void define_local(std::string_view name, Value *v);
+
+    const char *cur_;
+    const char *end_;
+    unsigned line_{1};
+    std::unique_ptr<Module> m_;
+
+    std::unordered_map<std::string_view, GlobalVariable *> globals_;
+    std::unordered_map<std::string_view, Function *> functions_;
+    // functions in the order of their define/declare
+    std::vector<Function *> func_order_;
+    std::unordered_set<Function *> declared_;
+
+    Function *func_{nullptr};
+    BasicBlock *bb_{nullptr};
+    std::unordered_map<std::string_view, Value *> locals_;
+    std::unordered_map<std::string_view, BasicBlock *> blocks_;
+    std::vector<BasicBlock *> block_order_;
+    std::list<Argument> placeholders_;
+    std::unordered_map<std::string_view, Argument *> forward_;
+};
+
+void IRParser::skip_space() {
+    while (cur_ != end_) {
+        if (*cur_ == '\n') {
+            line_++;
+            cur_++;
+        } else if (std::isspace(static_cast<unsigned char>(*cur_))) {
+            cur_++;
+        } else if (*cur_ == ';') {
+            while (cur_ != end_ and *cur_ != '\n')
+                cur_++;
+        } else {
+            break;
+        }
+    }
+}
+
+bool IRParser::at_end() {
+    skip_space();
+    return cur_ == end_;
+}
+
+bool IRParser::try_punct(char c) {
+    skip_space();
+    if (cur_ != end_ and *cur_ == c) {
+        cur_++;
+        return true;
+    }
+    return false;
+}
+
+void IRParser::expect(char c) {
+    if (not try_punct(c))
+        error(std::string("expected \'") + c + "\'");
+}
+
+std::string_view IRParser::get_ident() {
+    skip_space();
+    auto begin = cur_;
+    while (cur_ != end_ and is_ident_char(*cur_))
+        cur_++;
+    if (begin == cur_)
+        error("expected a name");
+    return std::string_view(begin, cur_ - begin);
+}
+
+bool IRParser::try_keyword(std::string_view kw) {
+    skip_space();
+    if (size_t(end_ - cur_) < kw.size() or
+        std::string_view(cur_, kw.size()) != kw or
+        (cur_ + kw.size() != end_ and is_ident_char(cur_[kw.size()])))
+        return false;
+    cur_ += kw.size();
+    return true;
+}
+
+void IRParser::expect_keyword(std::string_view kw) {
+    if (not try_keyword(kw))
+        error("expected \'" + std::string(kw) + "\'");
+}
+
+void IRParser::skip_string() {
+    expect('"');
+    while (cur_ != end_ and *cur_ != '"') {
+        if (*cur_ == '\\' and cur_ + 1 != end_)
+            cur_++;
+        cur_++;
+    }
+    expect('"');
+}
+
+Type *IRParser::parse_type() {
+    Type *ty = nullptr;
+    if (try_punct('[')) {
+        skip_space();
+        unsigned num = 0;
+        auto [ptr, ec] = std::from_chars(cur_, end_, num);
+        if (ec != std::errc())
+            error("expected the number of array elements");
+        cur_ = ptr;
+        expect_keyword("x");
+        auto *elem = parse_type();
+        if (not ArrayType::is_valid_element_type(elem))
+            error("invalid array element type");
+        expect(']');
+        ty = m_->get_array_type(elem, num);
+    } else {
+        auto name = get_ident();
+        if (name == "void")
+            ty = m_->get_void_type();
+        else if (name == "label")
+            ty = m_->get_label_type();
+        else if (name == "i1")
+            ty = m_->get_int1_type();
+        else if (name == "i32")
+            ty = m_->get_int32_type();
+        else if (name == "float")
+            ty = m_->get_float_type();
+        else
+            error("unknown type \'" + std::string(name) + "\'");
+    }
+    while (try_punct('*')) {
+        if (ty->is_void_type() or ty->is_label_type())
+            error("invalid pointer element type");
+        ty = m_->get_pointer_type(ty);
+    }
+    return ty;
+}
+
+Constant *IRParser::parse_constant(Type *ty) {
+    if (try_keyword("zeroinitializer"))
+        return ConstantZero::get(ty, m_.get());
+    if (ty->is_int1_type()) {
+        if (try_keyword("true"))
+            return ConstantInt::get(true, m_.get());
+        if (try_keyword("false"))
+            return ConstantInt::get(false, m_.get());
+    }
+    skip_space();
+    auto begin = cur_;
+    if (cur_ != end_ and *cur_ == '-')
+        cur_++;
+    while (cur_ != end_ and is_ident_char(*cur_))
+        cur_++;
+    std::string_view token(begin, cur_ - begin);
+    if (token.empty())
+        error("expected a constant");
+    if (ty->is_float_type()) {
+        // printed as the hex bits of the value widened to double
+        if (token.size() > 2 and token.substr(0, 2) == "0x") {
+            uint64_t bits = 0;
+            auto [ptr, ec] = std::from_chars(
+                token.data() + 2, token.data() + token.size(), bits, 16);
+            if (ec != std::errc() or ptr != token.data() + token.size())
+                error("bad float constant");
+            double val;
+            std::memcpy(&val, &bits, sizeof(val));
+            return ConstantFP::get(val, m_.get());
+        }
+        std::string str(token);
+        char *str_end;
+        float val = std::strtof(str.c_str(), &str_end);
+        if (*str_end != '\0')
+            error("bad float constant");
+        return ConstantFP::get(val, m_.get());
+    }
+    if (ty->is_integer_type()) {
+        int val = 0;
+        auto [ptr, ec] =
+            std::from_chars(token.data(), token.data() + token.size(), val);
+        if (ec != std::errc() or ptr != token.data() + token.size())
+            error("bad integer constant");
+        if (ty->is_int1_type())
+            return ConstantInt::get(val != 0, m_.get());
+        return ConstantInt::get(val, m_.get());
+    }
+    error("expected a value of type " + ty->print());
+}
+
+void IRParser::expect_type(Value *v, Type *ty) {
+    if (v->get_type() != ty)
+        error("expected a value of type " + ty->print() + ", got " +
+              v->get_type()->print());
+}
+
+Value *IRParser::parse_value(Type *ty) {
+    if (try_punct('%')) {
+        auto name = get_ident();
+        if (auto iter = locals_.find(name); iter != locals_.end()) {
+            expect_type(iter->second, ty);
+            return iter->second;
+        }
+        auto &placeholder = forward_[name];
+        if (not placeholder)
+            placeholder = &placeholders_.emplace_back(ty);
+        expect_type(placeholder, ty);
+        return placeholder;
+    }
+    if (try_punct('@')) {
+        auto name = get_ident();
+        auto iter = globals_.find(name);
+        if (iter == globals_.end())
+            error("use of undefined global @" + std::string(name));
+        expect_type(iter->second, ty);
+        return iter->second;
+    }
+    return parse_constant(ty);
+}
+
+Value *IRParser::parse_typed_value() { return parse_value(parse_type()); }
+
+BasicBlock *IRParser::parse_label() {
+    expect('%');
+    return get_block(get_ident());
+}
+
+BasicBlock *IRParser::get_block(std::string_view name) {
+    auto &bb = blocks_[name];
+    if (not bb) {
+        // defined later, moved to its place at the end of the function
+        bb = BasicBlock::create(m_.get(), "", func_);
+        func_->set_printed_name(bb, name);
+    }
+    return bb;
+}
+
+void IRParser::define_local(std::string_view name, Value *v) {
+    if (not locals_.emplace(name, v).second)
+        error("redefinition of %" + std::string(name));
+    func_->set_printed_name(v, name);
+    if (auto iter = forward_.find(name); iter != forward_.end()) {
+        expect_type(iter->second, v->get_type());
+        iter->second->replace_all_use_with(v);
+        forward_.erase(iter);
+    }
+}
+
+Function *IRParser::get_function(std::string_view name, FunctionType *ty) {
+    auto &func = functions_[name];
+    if (not func)
+        func = Function::create(ty, std::string(name), m_.get());
+    else if (func->get_function_type() != ty)
+        error("@" + std::string(name) + " used with another type");
+    return func;
+}
+
+void IRParser::parse_global() {
+    auto name = get_ident();
+    expect('=');
+    bool is_const = try_keyword("constant");
+    if (not is_const)
+        expect_keyword("global");
+    auto *ty = parse_type();
+    auto *init = parse_constant(ty);
+    if (globals_.count(name) or functions_.count(name))
+        error("redefinition of @" + std::string(name));
+    globals_[name] =
+        GlobalVariable::create(std::string(name), m_.get(), ty, is_const, init);
+}
+
+void IRParser::parse_function(bool is_define) {
+    auto *ret_ty = parse_type();
+    if (not FunctionType::is_valid_return_type(ret_ty))
+        error("invalid return type");
+    expect('@');
+    auto name = get_ident();
+    expect('(');
+    std::vector<Type *> params;
+    std::vector<std::string_view> arg_names;
+    while (not try_punct(')')) {
+        if (not params.empty())
+            expect(',');
+        params.push_back(parse_type());
+        if (not FunctionType::is_valid_argument_type(params.back()))
+            error("invalid argument type");
+        arg_names.emplace_back();
+        if (try_punct('%'))
+            arg_names.back() = get_ident();
+    }
+    if (globals_.count(name))
+        error("redefinition of @" + std::string(name));
+    auto *func = get_function(name, m_->get_function_type(ret_ty, params));
+    if (not declared_.insert(func).second)
+        error("redefinition of @" + std::string(name));
+    func_order_.push_back(func);
+    if (not is_define)
+        return;
+
+    func_ = func;
+    bb_ = nullptr;
+    unsigned i = 0;
+    for (auto &arg : func->get_args()) {
+        if (not arg_names[i].empty())
+            define_local(arg_names[i], &arg);
+        i++;
+    }
+    expect('{');
+    parse_body();
+
+    if (not forward_.empty())
+        error("use of undefined value %" +
+              std::string(forward_.begin()->first));
+    // blocks created by a forward branch were appended early
+    auto &bbs = func->get_basic_blocks();
+    for (auto *bb : block_order_) {
+        bbs.remove(bb);
+        bbs.push_back(bb);
+    }
+    locals_.clear();
+    blocks_.clear();
+    block_order_.clear();
+    placeholders_.clear();
+    func_ = nullptr;
+}
+
+void IRParser::parse_body() {
+    std::unordered_set<BasicBlock *> defined;
+    while (not try_punct('}')) {
+        if (at_end())
+            error("expected \'}\'");
+        std::string_view name;
+        if (try_punct('%')) {
+            name = get_ident();
+            expect('=');
+        }
+        auto op = get_ident();
+        if (name.empty() and try_punct(':')) {
+            // a label
+            auto *bb = get_block(op);
+            if (not defined.insert(bb).second)
+                error("redefinition of block %" + std::string(op));
+            if (bb_ and not bb_->is_terminated())
+                error("block %" + bb_->get_name() + " is not terminated");
+            block_order_.push_back(bb);
+            bb_ = bb;
+            continue;
+        }
+        if (not bb_) {
+            // the entry block may have no label
+            bb_ = BasicBlock::create(m_.get(), "", func_);
+            defined.insert(bb_);
+            block_order_.push_back(bb_);
+        } else if (bb_->is_terminated()) {
+            error("instruction after the terminator of %" + bb_->get_name());
+        }
+        parse_instruction(name, op);
+    }
+    if (bb_ and not bb_->is_terminated())
+        error("block %" + bb_->get_name() + " is not terminated");
+    for (auto &[bb_name, bb] : blocks_) {
+        if (not defined.count(bb))
+            error("use of undefined block %" + std::string(bb_name));
+    }
+}
+
+Instruction *IRParser::parse_call() {
+    auto *ret_ty = parse_type();
+    expect('@');
+    auto name = get_ident();
+    expect('(');
+    std::vector<Type *> params;
+    std::vector<Value *> args;
+    while (not try_punct(')')) {
+        if (not args.empty())
+            expect(',');
+        args.push_back(parse_typed_value());
+        params.push_back(args.back()->get_type());
+        if (not FunctionType::is_valid_argument_type(params.back()))
+            error("invalid argument type");
+    }
+    if (not FunctionType::is_valid_return_type(ret_ty))
+        error("invalid return type");
+    if (globals_.count(name))
+        error("@" + std::string(name) + " is not a function");
+    auto *func = get_function(name, m_->get_function_type(ret_ty, params));
+    return CallInst::create_call(func, args, bb_);
+}
+
+void IRParser::parse_instruction(std::string_view name, std::string_view op) {
+    Type *int32_ty = m_->get_int32_type();
+    Type *float_ty = m_->get_float_type();
+    Instruction *inst = nullptr;
+
+    if (auto iter = binary_ops.find(op); iter != binary_ops.end()) {
+        auto id = iter->second;
+        auto is_float = id >= Instruction::fadd;
+        auto *ty = parse_type();
+        if (ty != (is_float ? float_ty : int32_ty))
+            error("bad operand type of " + std::string(op));
+        auto *lhs = parse_value(ty);
+        expect(',');
+        auto *rhs = parse_value(ty);
+        switch (id) {
+        case Instruction::add:
+            inst = IBinaryInst::create_add(lhs, rhs, bb_);
+            break;
+        case Instruction::sub:
+            inst = IBinaryInst::create_sub(lhs, rhs, bb_);
+            break;
+        case Instruction::mul:
+            inst = IBinaryInst::create_mul(lhs, rhs, bb_);
+            break;
+        case Instruction::sdiv:
+            inst = IBinaryInst::create_sdiv(lhs, rhs, bb_);
+            break;
+        case Instruction::fadd:
+            inst = FBinaryInst::create_fadd(lhs, rhs, bb_);
+            break;
+        case Instruction::fsub:
+            inst = FBinaryInst::create_fsub(lhs, rhs, bb_);
+            break;
+        case Instruction::fmul:
+            inst = FBinaryInst::create_fmul(lhs, rhs, bb_);
+            break;
+        default:
+            inst = FBinaryInst::create_fdiv(lhs, rhs, bb_);
+            break;
+        }
+    } else if (op == "icmp" or op == "fcmp") {
+        auto &conds = op == "icmp" ? icmp_conds : fcmp_conds;
+        auto cond = get_ident();
+        auto iter = conds.find(cond);
+        if (iter == conds.end())
+            error("unknown condition \'" + std::string(cond) + "\'");
+        auto *ty = parse_type();
+        if (ty != (op == "icmp" ? int32_ty : float_ty))
+            error("bad operand type of " + std::string(op));
+        auto *lhs = parse_value(ty);
+        expect(',');
+        auto *rhs = parse_value(ty);
+        switch (iter->second) {
+        case Instruction::ge:
+            inst = ICmpInst::create_ge(lhs, rhs, bb_);
+            break;
+        case Instruction::gt:
+            inst = ICmpInst::create_gt(lhs, rhs, bb_);
+            break;
+        case Instruction::le:
+            inst = ICmpInst::create_le(lhs, rhs, bb_);
+            break;
+        case Instruction::lt:
+            inst = ICmpInst::create_lt(lhs, rhs, bb_);
+            break;
+        case Instruction::eq:
+            inst = ICmpInst::create_eq(lhs, rhs, bb_);
+            break;
+        case Instruction::ne:
+            inst = ICmpInst::create_ne(lhs, rhs, bb_);
+            break;
+        case Instruction::fge:
+            inst = FCmpInst::create_fge(lhs, rhs, bb_);
+            break;
+        case Instruction::fgt:
+            inst = FCmpInst::create_fgt(lhs, rhs, bb_);
+            break;
+        case Instruction::fle:
+            inst = FCmpInst::create_fle(lhs, rhs, bb_);
+            break;
+        case Instruction::flt:
+            inst = FCmpInst::create_flt(lhs, rhs, bb_);
+            break;
+        case Instruction::feq:
+            inst = FCmpInst::create_feq(lhs, rhs, bb_);
+            break;
+        default:
+            inst = FCmpInst::create_fne(lhs, rhs, bb_);
+            break;
+        }
+    } else if (op == "ret") {
+        auto *ret_ty = func_->get_return_type();
+        if (try_keyword("void")) {
+            if (not ret_ty->is_void_type())
+                error("ret void in a function returning a value");
+            inst = ReturnInst::create_void_ret(bb_);
+        } else {
+            auto *ty = parse_type();
+            if (ty != ret_ty)
+                error("ret type does not match the function");
+            inst = ReturnInst::create_ret(parse_value(ty), bb_);
+        }
+    } else if (op == "br") {
+        if (try_keyword("label")) {
+            inst = BranchInst::create_br(parse_label(), bb_);
+        } else {
+            auto *ty = parse_type();
+            if (not ty->is_int1_type())
+                error("br condition is not i1");
+            auto *cond = parse_value(ty);
+            expect(',');
+            expect_keyword("label");
+            auto *if_true = parse_label();
+            expect(',');
+            expect_keyword("label");
+            auto *if_false = parse_label();
+            inst = BranchInst::create_cond_br(cond, if_true, if_false, bb_);
+        }
+    } else if (op == "alloca") {
+        auto *ty = parse_type();
+        if (not(ty->is_integer_type() or ty->is_float_type() or
+                ty->is_array_type() or ty->is_pointer_type()))
+            error("invalid alloca type");
+        inst = AllocaInst::create_alloca(ty, bb_);
+    } else if (op == "load") {
+        auto *ty = parse_type();
+        if (not(ty->is_integer_type() or ty->is_float_type() or
+                ty->is_pointer_type()))
+            error("invalid load type");
+        expect(',');
+        auto *ptr = parse_value(parse_type());
+        expect_type(ptr, m_->get_pointer_type(ty));
+        inst = LoadInst::create_load(ptr, bb_);
+    } else if (op == "store") {
+        auto *val = parse_typed_value();
+        expect(',');
+        auto *ptr = parse_value(parse_type());
+        expect_type(ptr, m_->get_pointer_type(val->get_type()));
+        inst = StoreInst::create_store(val, ptr, bb_);
+    } else if (op == "getelementptr") {
+        auto *ty = parse_type();
+        expect(',');
+        auto *ptr = parse_value(parse_type());
+        if (not(ty->is_array_type() or ty->is_integer_type() or
+                ty->is_float_type()))
+            error("invalid getelementptr type");
+        expect_type(ptr, m_->get_pointer_type(ty));
+        std::vector<Value *> idxs;
+        while (try_punct(',')) {
+            idxs.push_back(parse_typed_value());
+            if (not idxs.back()->get_type()->is_integer_type())
+                error("getelementptr index is not an integer");
+            // every index but the first steps into an array
+            if (idxs.size() > 1) {
+                if (not ty->is_array_type())
+                    error("getelementptr index into a non-array type");
+                ty = ty->get_array_element_type();
+            }
+        }
+        inst = GetElementPtrInst::create_gep(ptr, idxs, bb_);
+    } else if (op == "zext" or op == "fptosi" or op == "sitofp") {
+        auto *val = parse_typed_value();
+        expect_keyword("to");
+        auto *ty = parse_type();
+        auto *src_ty = val->get_type();
+        if (op == "zext") {
+            if (not src_ty->is_int1_type() or not ty->is_int32_type())
+                error("zext is only supported from i1 to i32");
+            inst = ZextInst::create_zext(val, ty, bb_);
+        } else if (op == "fptosi") {
+            if (not src_ty->is_float_type() or not ty->is_integer_type())
+                error("fptosi needs a float operand and an integer type");
+            inst = FpToSiInst::create_fptosi(val, ty, bb_);
+        } else {
+            if (not src_ty->is_integer_type() or not ty->is_float_type())
+                error("sitofp needs an integer operand and a float type");
+            inst = SiToFpInst::create_sitofp(val, bb_);
+        }
+    } else if (op == "phi") {
+        auto *ty = parse_type();
+        if (not(ty->is_integer_type() or ty->is_float_type() or
+                ty->is_pointer_type()))
+            error("invalid phi type");
+        std::vector<Value *> vals;
+        std::vector<BasicBlock *> val_bbs;
+        do {
+            expect('[');
+            if (try_keyword("undef")) {
+                // predecessor not listed by the phi, see PhiInst::print
+                expect(',');
+                parse_label();
+            } else {
+                vals.push_back(parse_value(ty));
+                expect(',');
+                val_bbs.push_back(parse_label());
+            }
+            expect(']');
+        } while (try_punct(','));
+        inst = PhiInst::create_phi(ty, bb_, vals, val_bbs);
+        bb_->add_instruction(inst);
+    } else if (op == "call") {
+        inst = parse_call();
+    } else {
+        error("unknown instruction \'" + std::string(op) + "\'");
+    }
+
+    if (name.empty() != inst->is_void())
+        error(inst->is_void() ? "a void instruction has no name"
+                              : "instruction needs a name");
+    if (not name.empty())
+        define_local(name, inst);
+}
+
+std::unique_ptr<Module> IRParser::parse() {
+    m_ = std::make_unique<Module>();
+    while (not at_end()) {
+        if (try_punct('@')) {
+            parse_global();
+            continue;
+        }
+        auto keyword = get_ident();
+        if (keyword == "define" or keyword == "declare") {
+            parse_function(keyword == "define");
+        } else if (keyword == "source_filename") {
+            expect('=');
+            skip_string();
+        } else {
+            error("unexpected \'" + std::string(keyword) + "\'");
+        }
+    }
+    for (auto &[name, func] : functions_) {
+        if (not declared_.count(func))
+            error("call to undeclared function @" + std::string(name));
+    }
+    // functions first called before their declaration were appended early
+    auto &funcs = m_->get_functions();
+    for (auto *func : func_order_) {
+        funcs.remove(func);
+        funcs.push_back(func);
+    }
+    return std::move(m_);
+}
+} // namespace
+
+std::unique_ptr<Module> parse_ir(const char *data, size_t size,
+                                 std::string &err) {
+    IRParser parser(data, size);
+    try {
+        return parser.parse();
+    } catch (const ParseError &e) {
+        err = "line " + std::to_string(parser.get_line()) + ": " + e.msg;
+        return nullptr;
+    }
+}
+
+std::unique_ptr<Module> parse_ir_file(const std::string &file,
+                                      std::string &err) {
+    std::ifstream stream(file);
+    if (not stream) {
+        err = "cannot open file";
+        return nullptr;
+    }
+    std::ostringstream text;
+    text << stream.rdbuf();
+    auto str = text.str();
+    return parse_ir(str.data(), str.size(), err);
+}
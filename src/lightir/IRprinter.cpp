@@ -10,14 +10,17 @@ std::string print_as_op(Value *v, bool print_ty) {
         op_ir += " ";
     }
 
-    if (dynamic_cast<GlobalVariable *>(v)) {
-        op_ir += "@" + v->get_name();
-    } else if (dynamic_cast<Function *>(v)) {
-        op_ir += "@" + v->get_name();
-    } else if (dynamic_cast<Constant *>(v)) {
+    if (dyn_cast<GlobalVariable>(v)) {
+        op_ir += "@";
+        v->append_name(op_ir);
+    } else if (dyn_cast<Function>(v)) {
+        op_ir += "@";
+        v->append_name(op_ir);
+    } else if (dyn_cast<Constant>(v)) {
         op_ir += v->print();
     } else {
-        op_ir += "%" + v->get_name();
+        op_ir += "%";
+        v->append_name(op_ir);
     }
 
     return op_ir;
@@ -94,7 +97,7 @@ std::string print_instr_op_name(Instruction::OpID id) {
 template <class BinInst> std::string print_binary_inst(const BinInst &inst) {
     std::string instr_ir;
     instr_ir += "%";
-    instr_ir += inst.get_name();
+    inst.append_name(instr_ir);
     instr_ir += " = ";
     instr_ir += inst.get_instr_op_name();
     instr_ir += " ";
@@ -122,7 +125,7 @@ template <class CMP> std::string print_cmp_inst(const CMP &inst) {
         assert(false && "Unexpected case");
     std::string instr_ir;
     instr_ir += "%";
-    instr_ir += inst.get_name();
+    inst.append_name(instr_ir);
     instr_ir += " = " + cmp_type + " ";
     instr_ir += inst.get_instr_op_name();
     instr_ir += " ";
@@ -144,7 +147,7 @@ std::string CallInst::print() {
     std::string instr_ir;
     if (!this->is_void()) {
         instr_ir += "%";
-        instr_ir += this->get_name();
+        this->append_name(instr_ir);
         instr_ir += " = ";
     }
     instr_ir += get_instr_op_name();
@@ -152,7 +155,7 @@ std::string CallInst::print() {
     instr_ir += this->get_function_type()->get_return_type()->print();
 
     instr_ir += " ";
-    assert(dynamic_cast<Function *>(this->get_operand(0)) &&
+    assert(dyn_cast<Function>(this->get_operand(0)) &&
            "Wrong call operand function");
     instr_ir += print_as_op(this->get_operand(0), false);
     instr_ir += "(";
@@ -199,7 +202,7 @@ std::string ReturnInst::print() {
 std::string GetElementPtrInst::print() {
     std::string instr_ir;
     instr_ir += "%";
-    instr_ir += this->get_name();
+    this->append_name(instr_ir);
     instr_ir += " = ";
     instr_ir += get_instr_op_name();
     instr_ir += " ";
@@ -232,7 +235,7 @@ std::string StoreInst::print() {
 std::string LoadInst::print() {
     std::string instr_ir;
     instr_ir += "%";
-    instr_ir += this->get_name();
+    this->append_name(instr_ir);
     instr_ir += " = ";
     instr_ir += get_instr_op_name();
     instr_ir += " ";
@@ -248,7 +251,7 @@ std::string LoadInst::print() {
 std::string AllocaInst::print() {
     std::string instr_ir;
     instr_ir += "%";
-    instr_ir += this->get_name();
+    this->append_name(instr_ir);
     instr_ir += " = ";
     instr_ir += get_instr_op_name();
     instr_ir += " ";
@@ -259,7 +262,7 @@ std::string AllocaInst::print() {
 std::string ZextInst::print() {
     std::string instr_ir;
     instr_ir += "%";
-    instr_ir += this->get_name();
+    this->append_name(instr_ir);
     instr_ir += " = ";
     instr_ir += get_instr_op_name();
     instr_ir += " ";
@@ -274,7 +277,7 @@ std::string ZextInst::print() {
 std::string FpToSiInst::print() {
     std::string instr_ir;
     instr_ir += "%";
-    instr_ir += this->get_name();
+    this->append_name(instr_ir);
     instr_ir += " = ";
     instr_ir += get_instr_op_name();
     instr_ir += " ";
@@ -289,7 +292,7 @@ std::string FpToSiInst::print() {
 std::string SiToFpInst::print() {
     std::string instr_ir;
     instr_ir += "%";
-    instr_ir += this->get_name();
+    this->append_name(instr_ir);
     instr_ir += " = ";
     instr_ir += get_instr_op_name();
     instr_ir += " ";
@@ -304,7 +307,7 @@ std::string SiToFpInst::print() {
 std::string PhiInst::print() {
     std::string instr_ir;
     instr_ir += "%";
-    instr_ir += this->get_name();
+    this->append_name(instr_ir);
     instr_ir += " = ";
     instr_ir += get_instr_op_name();
     instr_ir += " ";
@@ -12,7 +12,7 @@
 #include <vector>
 
 Instruction::Instruction(Type *ty, OpID id, BasicBlock *parent)
-    : User(ty, ""), op_id_(id), parent_(parent) {
+    : User(InstructionVal, ty, ""), op_id_(id), parent_(parent) {
     if (parent)
         parent->add_instruction(this);
 }
@@ -150,37 +150,35 @@ BranchInst::BranchInst(Value *cond, BasicBlock *if_true, BasicBlock *if_false,
     if (cond == nullptr) { // conditionless jump
         assert(if_false == nullptr && "Given false-bb on conditionless jump");
         add_operand(if_true);
-        // prev/succ
-        if_true->add_pre_basic_block(bb);
-        bb->add_succ_basic_block(if_true);
     } else {
         assert(cond->get_type()->is_int1_type() &&
                "BranchInst condition is not i1");
         add_operand(cond);
         add_operand(if_true);
         add_operand(if_false);
-        // prev/succ
-        if_true->add_pre_basic_block(bb);
-        if_false->add_pre_basic_block(bb);
-        bb->add_succ_basic_block(if_true);
-        bb->add_succ_basic_block(if_false);
     }
 }
 
-BranchInst::~BranchInst() {
-    std::list<BasicBlock *> succs;
-    if (is_cond_br()) {
-        succs.push_back(static_cast<BasicBlock *>(get_operand(1)));
-        succs.push_back(static_cast<BasicBlock *>(get_operand(2)));
-    } else {
-        succs.push_back(static_cast<BasicBlock *>(get_operand(0)));
-    }
-    for (auto succ_bb : succs) {
-        if (succ_bb) {
-            succ_bb->remove_pre_basic_block(get_parent());
-            get_parent()->remove_succ_basic_block(succ_bb);
-        }
+// ~User would not reach on_set_operand any more. Operands dropped by
+// Module::~Module are already gone, the whole CFG goes away with them
+BranchInst::~BranchInst() { remove_all_operands(); }
+
+unsigned BranchInst::succ_index(unsigned i) const {
+    unsigned idx = 0;
+    for (unsigned j = 0; j < i; j++) {
+        if (dyn_cast<BasicBlock>(get_operand(j)))
+            idx++;
     }
+    return idx;
+}
+
+void BranchInst::on_set_operand(unsigned i, Value *old_val) {
+    // the successors of the parent are the targets in operand order, so
+    // the edges follow the operands: added, moved in place or removed
+    if (dyn_cast<BasicBlock>(old_val))
+        BasicBlock::erase_edge(get_parent(), succ_index(i));
+    if (auto new_bb = dyn_cast<BasicBlock>(get_operand(i)))
+        BasicBlock::insert_edge(get_parent(), succ_index(i), new_bb);
 }
 
 BranchInst *BranchInst::create_cond_br(Value *cond, BasicBlock *if_true,
@@ -227,7 +225,7 @@ GetElementPtrInst::GetElementPtrInst(Value *ptr, std::vector<Value *> idxs,
 }
 
 Type *GetElementPtrInst::get_element_type(Value *ptr,
-                                          std::vector<Value *> idxs) {
+                                          const std::vector<Value *> &idxs) {
     assert(ptr->get_type()->is_pointer_type() &&
            "GetElementPtrInst ptr is not a pointer");
 
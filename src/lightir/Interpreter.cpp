@@ -0,0 +1,448 @@
+#include "Interpreter.hpp"
+#include "BasicBlock.hpp"
+#include "Constant.hpp"
+#include "Function.hpp"
+#include "GlobalVariable.hpp"
+#include "IRprinter.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <stdexcept>
+
+namespace {
+// thrown by neg_idx_except, which exits the program
+struct ProgramExit {
+    int code;
+};
+} // namespace
+
+Interpreter::Interpreter(Module *m, std::istream &in, std::ostream &out)
+    : m_(m), in_(in), out_(out) {
+    for (auto &global : m_->get_global_variable()) {
+        auto size = global.get_type()->get_pointer_element_type()->get_size();
+        auto &mem = globals_[&global];
+        mem.reset(new char[size]());
+        init_global(mem.get(), global.get_init());
+    }
+}
+
+Interpreter::~Interpreter() = default;
+
+void Interpreter::init_global(char *mem, Constant *init) {
+    if (auto *int_val = dyn_cast<ConstantInt>(init)) {
+        int32_t val = int_val->get_value();
+        std::memcpy(mem, &val, init->get_type()->get_size());
+    } else if (auto *fp_val = dyn_cast<ConstantFP>(init)) {
+        float val = fp_val->get_value();
+        std::memcpy(mem, &val, sizeof(val));
+    } else if (auto *array = dyn_cast<ConstantArray>(init)) {
+        auto elem_size = init->get_type()->get_array_element_type()->get_size();
+        for (unsigned i = 0; i < array->get_size_of_array(); i++)
+            init_global(mem + i * elem_size, array->get_element_value(i));
+    }
+    // ConstantZero and no initializer: the memory is already zeroed
+}
+
+Interpreter::Operand
+Interpreter::get_operand(Value *v, const std::map<Value *, unsigned> &slots) {
+    Operand op{-1, {}};
+    if (auto iter = slots.find(v); iter != slots.end()) {
+        op.slot = iter->second;
+    } else if (auto *int_val = dyn_cast<ConstantInt>(v)) {
+        op.imm.i = int_val->get_value();
+    } else if (auto *fp_val = dyn_cast<ConstantFP>(v)) {
+        op.imm.f = fp_val->get_value();
+    } else if (auto *global = dyn_cast<GlobalVariable>(v)) {
+        op.imm.p = globals_.at(global).get();
+    } else if (dyn_cast<ConstantZero>(v)) {
+        op.imm.p = nullptr;
+    } else {
+        assert(false and "Interpreter: unexpected operand");
+    }
+    return op;
+}
+
+// lays out the frame of func, like CodeGen::allocate()
+Interpreter::FuncState *Interpreter::get_func_state(Function *func) {
+    auto &state = funcs_[func];
+    if (state)
+        return state.get();
+    state = std::make_unique<FuncState>();
+    state->func = func;
+
+    std::map<Value *, unsigned> slots;
+    std::map<BasicBlock *, BlockState *> block_states;
+    for (auto &arg : func->get_args())
+        slots[&arg] = state->num_slots++;
+    for (auto &bb : func->get_basic_blocks()) {
+        state->blocks.push_back(std::make_unique<BlockState>());
+        state->blocks.back()->bb = &bb;
+        block_states[&bb] = state->blocks.back().get();
+        for (auto &inst : bb.get_instructions())
+            if (not inst.is_void())
+                slots[&inst] = state->num_slots++;
+    }
+
+    auto operand = [&](Value *v) { return get_operand(v, slots); };
+    // the phi moves from bb along the edge to succ
+    auto get_moves = [&](BasicBlock *bb, BasicBlock *succ) {
+        std::vector<PhiMove> moves;
+        for (auto &inst : succ->get_instructions()) {
+            if (not inst.is_phi())
+                break;
+            auto &phi = static_cast<PhiInst &>(inst);
+            for (auto &[val, pre_bb] : phi.get_phi_pairs())
+                if (pre_bb == bb) {
+                    moves.push_back({slots.at(&inst), operand(val)});
+                    break;
+                }
+        }
+        return moves;
+    };
+
+    for (auto &block : state->blocks) {
+        auto *bb = block->bb;
+        block->num_phis = 0;
+        for (auto &inst : bb->get_instructions()) {
+            InstState inst_state{};
+            inst_state.op = inst.get_instr_type();
+            inst_state.dest = inst.is_void() ? -1 : slots.at(&inst);
+            switch (inst.get_instr_type()) {
+            case Instruction::phi:
+                block->num_phis++;
+                break;
+            case Instruction::alloca: {
+                auto &alloca = static_cast<AllocaInst &>(inst);
+                auto size = alloca.get_alloca_type()->get_size();
+                inst_state.size = state->frame_size;
+                state->frame_size += (size + 7) / 8 * 8;
+                break;
+            }
+            case Instruction::load:
+                inst_state.size = inst.get_type()->get_size();
+                inst_state.ops.push_back(operand(inst.get_operand(0)));
+                break;
+            case Instruction::store:
+                inst_state.size = inst.get_operand(0)->get_type()->get_size();
+                inst_state.ops.push_back(operand(inst.get_operand(0)));
+                inst_state.ops.push_back(operand(inst.get_operand(1)));
+                break;
+            case Instruction::getelementptr: {
+                auto *ptr_type = inst.get_operand(0)->get_type();
+                auto *ty = ptr_type->get_pointer_element_type();
+                for (unsigned i = 0; i < inst.get_num_operand(); i++) {
+                    inst_state.ops.push_back(operand(inst.get_operand(i)));
+                    if (i == 0)
+                        continue;
+                    if (i > 1)
+                        ty = ty->get_array_element_type();
+                    inst_state.scales.push_back(ty->get_size());
+                }
+                break;
+            }
+            case Instruction::call:
+                inst_state.callee = inst.get_operand(0)->as<Function>();
+                for (unsigned i = 1; i < inst.get_num_operand(); i++)
+                    inst_state.ops.push_back(operand(inst.get_operand(i)));
+                break;
+            case Instruction::br: {
+                auto &br = static_cast<BranchInst &>(inst);
+                unsigned first_target = 0;
+                if (br.is_cond_br()) {
+                    inst_state.ops.push_back(operand(br.get_condition()));
+                    first_target = 1;
+                }
+                for (unsigned i = first_target; i < br.get_num_operand(); i++) {
+                    auto *succ = br.get_operand(i)->as<BasicBlock>();
+                    auto target = i - first_target;
+                    inst_state.targets[target] = block_states.at(succ);
+                    inst_state.moves[target] = get_moves(bb, succ);
+                }
+                break;
+            }
+            default:
+                for (auto *op : inst.get_operands())
+                    inst_state.ops.push_back(operand(op));
+                break;
+            }
+            block->insts.push_back(std::move(inst_state));
+        }
+    }
+    return state.get();
+}
+
+Interpreter::RtValue
+Interpreter::call_builtin(Function *func, const std::vector<RtValue> &args) {
+    RtValue result{};
+    auto name = func->get_name();
+    if (name == "input") {
+        result.i = 0;
+        in_ >> result.i;
+    } else if (name == "output") {
+        out_ << args[0].i << "\n";
+    } else if (name == "outputFloat") {
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "%f\n", args[0].f);
+        out_ << buf;
+    } else if (name == "neg_idx_except") {
+        out_ << "negative index exception\n";
+        throw ProgramExit{0};
+    } else {
+        throw std::runtime_error("call to undefined function " + name);
+    }
+    return result;
+}
+
+Interpreter::RtValue Interpreter::call(Function *func,
+                                       const std::vector<RtValue> &args) {
+    if (func->is_declaration())
+        return call_builtin(func, args);
+    return execute(get_func_state(func), args);
+}
+
+Interpreter::RtValue Interpreter::execute(FuncState *state,
+                                          const std::vector<RtValue> &args) {
+    state->calls++;
+    std::vector<RtValue> slots(state->num_slots);
+    std::copy(args.begin(), args.end(), slots.begin());
+    std::unique_ptr<char[]> frame(new char[state->frame_size]());
+    auto value = [&](const Operand &op) {
+        return op.slot < 0 ? op.imm : slots[op.slot];
+    };
+
+    std::vector<RtValue> moved;
+    BlockState *block = state->blocks.front().get();
+    while (true) {
+        BlockState *next = nullptr;
+        // the phis of the block were executed on the incoming edge
+        block->entries++;
+        block->count += block->num_phis;
+        state->count += block->num_phis;
+        op_counts_[Instruction::phi] += block->num_phis;
+
+        for (unsigned i = block->num_phis; i < block->insts.size(); i++) {
+            auto &inst = block->insts[i];
+            block->count++;
+            state->count++;
+            op_counts_[inst.op]++;
+
+            RtValue result{};
+            auto lhs = inst.ops.size() > 0 ? value(inst.ops[0]) : RtValue{};
+            auto rhs = inst.ops.size() > 1 ? value(inst.ops[1]) : RtValue{};
+            switch (inst.op) {
+            case Instruction::ret:
+                return lhs;
+            case Instruction::br: {
+                unsigned target = 0;
+                if (not inst.ops.empty() and lhs.i == 0)
+                    target = 1;
+                // phis read their operands before any of them is written
+                auto &moves = inst.moves[target];
+                moved.resize(moves.size());
+                for (unsigned j = 0; j < moves.size(); j++)
+                    moved[j] = value(moves[j].src);
+                for (unsigned j = 0; j < moves.size(); j++)
+                    slots[moves[j].dest] = moved[j];
+                next = inst.targets[target];
+                break;
+            }
+            // wrap around instead of signed overflow
+            case Instruction::add:
+                result.i = uint32_t(lhs.i) + uint32_t(rhs.i);
+                break;
+            case Instruction::sub:
+                result.i = uint32_t(lhs.i) - uint32_t(rhs.i);
+                break;
+            case Instruction::mul:
+                result.i = uint32_t(lhs.i) * uint32_t(rhs.i);
+                break;
+            case Instruction::sdiv:
+                if (rhs.i == 0)
+                    throw std::runtime_error("division by zero");
+                result.i = (lhs.i == INT_MIN and rhs.i == -1) ? INT_MIN
+                                                               : lhs.i / rhs.i;
+                break;
+            case Instruction::fadd:
+                result.f = lhs.f + rhs.f;
+                break;
+            case Instruction::fsub:
+                result.f = lhs.f - rhs.f;
+                break;
+            case Instruction::fmul:
+                result.f = lhs.f * rhs.f;
+                break;
+            case Instruction::fdiv:
+                result.f = lhs.f / rhs.f;
+                break;
+            case Instruction::alloca:
+                result.p = frame.get() + inst.size;
+                break;
+            case Instruction::load:
+                std::memcpy(&result, lhs.p, inst.size);
+                break;
+            case Instruction::store:
+                std::memcpy(rhs.p, &lhs, inst.size);
+                break;
+            case Instruction::ge:
+                result.i = lhs.i >= rhs.i;
+                break;
+            case Instruction::gt:
+                result.i = lhs.i > rhs.i;
+                break;
+            case Instruction::le:
+                result.i = lhs.i <= rhs.i;
+                break;
+            case Instruction::lt:
+                result.i = lhs.i < rhs.i;
+                break;
+            case Instruction::eq:
+                result.i = lhs.i == rhs.i;
+                break;
+            case Instruction::ne:
+                result.i = lhs.i != rhs.i;
+                break;
+            case Instruction::fge:
+                result.i = lhs.f >= rhs.f;
+                break;
+            case Instruction::fgt:
+                result.i = lhs.f > rhs.f;
+                break;
+            case Instruction::fle:
+                result.i = lhs.f <= rhs.f;
+                break;
+            case Instruction::flt:
+                result.i = lhs.f < rhs.f;
+                break;
+            case Instruction::feq:
+                result.i = lhs.f == rhs.f;
+                break;
+            case Instruction::fne:
+                result.i = lhs.f != rhs.f;
+                break;
+            case Instruction::phi:
+                assert(false and "phi after the head of a basic block");
+                break;
+            case Instruction::call: {
+                std::vector<RtValue> call_args;
+                for (auto &op : inst.ops)
+                    call_args.push_back(value(op));
+                result = call(inst.callee, call_args);
+                break;
+            }
+            case Instruction::getelementptr:
+                result.p = lhs.p;
+                for (unsigned j = 1; j < inst.ops.size(); j++)
+                    result.p += static_cast<int64_t>(value(inst.ops[j]).i) *
+                                inst.scales[j - 1];
+                break;
+            case Instruction::zext:
+                result.i = lhs.i;
+                break;
+            case Instruction::fptosi:
+                // out of range conversions give INT_MIN, as on x86
+                if (lhs.f >= -2147483648.0f and lhs.f < 2147483648.0f)
+                    result.i = static_cast<int32_t>(lhs.f);
+                else
+                    result.i = INT_MIN;
+                break;
+            case Instruction::sitofp:
+                result.f = static_cast<float>(lhs.i);
+                break;
+            }
+            if (inst.dest >= 0)
+                slots[inst.dest] = result;
+        }
+        if (not next)
+            throw std::runtime_error("basic block without terminator");
+        block = next;
+    }
+}
+
+int Interpreter::run() {
+    Function *main_func = nullptr;
+    for (auto &func : m_->get_functions())
+        if (func.get_name() == "main")
+            main_func = &func;
+    if (not main_func or main_func->is_declaration()) {
+        std::cerr << "interpreter: no main function" << std::endl;
+        return -1;
+    }
+
+    int code;
+    try {
+        code = call(main_func, {}).i;
+    } catch (ProgramExit &exit) {
+        code = exit.code;
+    } catch (std::runtime_error &err) {
+        out_.flush();
+        std::cerr << "interpreter: " << err.what() << std::endl;
+        code = -1;
+    }
+    out_.flush();
+    return code;
+}
+
+uint64_t Interpreter::get_total_count() const {
+    uint64_t total = 0;
+    for (auto count : op_counts_)
+        total += count;
+    return total;
+}
+
+void Interpreter::print_stats(std::ostream &os) const {
+    m_->set_print_name();
+    auto total = get_total_count();
+    auto percent = [total](uint64_t count) {
+        return total ? count * 100.0 / total : 0.0;
+    };
+
+    auto old_flags = os.flags();
+    auto old_precision = os.precision();
+    os << std::fixed << std::setprecision(2);
+    os << "===== Dynamic instruction counts =====\n";
+    os << "Total: " << total << "\n";
+
+    os << "----- per opcode -----\n";
+    std::vector<std::pair<uint64_t, Instruction::OpID>> ops;
+    for (unsigned op = 0; op < op_counts_.size(); op++)
+        if (op_counts_[op])
+            ops.push_back({op_counts_[op], static_cast<Instruction::OpID>(op)});
+    std::stable_sort(ops.begin(), ops.end(),
+                     [](auto &a, auto &b) { return a.first > b.first; });
+    for (auto &[count, op] : ops) {
+        os << std::setw(14) << count << std::setw(8) << percent(count) << "  "
+           << print_instr_op_name(op) << "\n";
+    }
+
+    std::vector<const FuncState *> funcs;
+    std::vector<std::pair<const FuncState *, const BlockState *>> blocks;
+    for (auto &[func, state] : funcs_) {
+        funcs.push_back(state.get());
+        for (auto &block : state->blocks)
+            if (block->entries)
+                blocks.push_back({state.get(), block.get()});
+    }
+    std::stable_sort(funcs.begin(), funcs.end(),
+                     [](auto *a, auto *b) { return a->count > b->count; });
+    std::stable_sort(blocks.begin(), blocks.end(), [](auto &a, auto &b) {
+        return a.second->count > b.second->count;
+    });
+
+    os << "----- per function (count, %, calls) -----\n";
+    for (auto *state : funcs)
+        os << std::setw(14) << state->count << std::setw(8)
+           << percent(state->count) << std::setw(12) << state->calls << "  "
+           << state->func->get_name() << "\n";
+
+    os << "----- per basic block (count, %, entries) -----\n";
+    for (auto &[func, block] : blocks)
+        os << std::setw(14) << block->count << std::setw(8)
+           << percent(block->count) << std::setw(12) << block->entries << "  "
+           << func->func->get_name() << ":" << block->bb->get_name() << "\n";
+
+    os.flags(old_flags);
+    os.precision(old_precision);
+}
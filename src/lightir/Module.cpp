@@ -1,8 +1,10 @@
 #include "Module.hpp"
+#include "Constant.hpp"
 #include "Function.hpp"
 #include "GlobalVariable.hpp"
 
 #include <memory>
+#include <sstream>
 #include <string>
 
 Module::Module() {
@@ -13,6 +15,23 @@ Module::Module() {
     float32_ty_ = std::make_unique<FloatType>(this);
 }
 
+Module::~Module() {
+    // every value dies with the module, so drop the def-use edges in one
+    // linear walk instead of unlinking each use in the destructors
+    for (auto &func : function_list_) {
+        for (auto &bb : func.get_basic_blocks()) {
+            for (auto &inst : bb.get_instructions())
+                inst.drop_all_references();
+        }
+    }
+    for (auto &global : global_list_)
+        global.drop_all_references();
+    // instructions still use the cached constants, free them first
+    function_list_.clear();
+    global_list_.clear();
+    constants_.clear();
+}
+
 Type *Module::get_void_type() { return void_ty_.get(); }
 Type *Module::get_label_type() { return label_ty_.get(); }
 IntegerType *Module::get_int1_type() { return int1_ty_.get(); }
@@ -26,27 +45,22 @@ PointerType *Module::get_float_ptr_type() {
 }
 
 PointerType *Module::get_pointer_type(Type *contained) {
-    if (pointer_map_.find(contained) == pointer_map_.end()) {
-        pointer_map_[contained] = std::make_unique<PointerType>(contained);
-    }
-    return pointer_map_[contained].get();
+    return static_cast<PointerType *>(
+        types_.get({Type::PointerTyID, contained, 0, nullptr},
+                   [&]() { return new PointerType(contained); }));
 }
 
 ArrayType *Module::get_array_type(Type *contained, unsigned num_elements) {
-    if (array_map_.find({contained, num_elements}) == array_map_.end()) {
-        array_map_[{contained, num_elements}] =
-            std::make_unique<ArrayType>(contained, num_elements);
-    }
-    return array_map_[{contained, num_elements}].get();
+    return static_cast<ArrayType *>(
+        types_.get({Type::ArrayTyID, contained, num_elements, nullptr},
+                   [&]() { return new ArrayType(contained, num_elements); }));
 }
 
 FunctionType *Module::get_function_type(Type *retty,
-                                        std::vector<Type *> &args) {
-    if (not function_map_.count({retty, args})) {
-        function_map_[{retty, args}] =
-            std::make_unique<FunctionType>(retty, args);
-    }
-    return function_map_[{retty, args}].get();
+                                        const std::vector<Type *> &args) {
+    return static_cast<FunctionType *>(
+        types_.get({Type::FunctionTyID, retty, 0, &args},
+                   [&]() { return new FunctionType(retty, args); }));
 }
 
 void Module::add_function(Function *f) { function_list_.push_back(f); }
@@ -66,15 +80,19 @@ void Module::set_print_name() {
 }
 
 std::string Module::print() {
+    std::ostringstream module_ir;
+    print(module_ir);
+    return module_ir.str();
+}
+
+void Module::print(std::ostream &os) {
     set_print_name();
-    std::string module_ir;
     for (auto &global_val : this->global_list_) {
-        module_ir += global_val.print();
-        module_ir += "\n";
+        os << global_val.print();
+        os << "\n";
     }
     for (auto &func : this->function_list_) {
-        module_ir += func.print();
-        module_ir += "\n";
+        func.print(os);
+        os << "\n";
     }
-    return module_ir;
 }
@@ -0,0 +1,49 @@
+#include "StringInterner.hpp"
+
+#include <charconv>
+#include <cstring>
+#include <new>
+
+void Symbol::append_to(std::string &out) const {
+    if (not(bits_ & 1)) {
+        if (bits_)
+            out += reinterpret_cast<const InternedString *>(bits_)->view();
+        return;
+    }
+    static const char *const prefixes[] = {"arg", "label", "op"};
+    out += prefixes[bits_ >> 1 & 3];
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), bits_ >> 3);
+    out.append(buf, res.ptr);
+}
+
+bool Symbol::parse_numbered(std::string_view str, Prefix &prefix,
+                            uintptr_t &num) {
+    static const std::string_view prefixes[] = {"arg", "label", "op"};
+    for (unsigned i = 0; i < 3; i++) {
+        if (str.substr(0, prefixes[i].size()) != prefixes[i])
+            continue;
+        auto digits = str.substr(prefixes[i].size());
+        if (digits.empty() or (digits[0] == '0' and digits.size() > 1))
+            return false;
+        auto end = digits.data() + digits.size();
+        auto res = std::from_chars(digits.data(), end, num);
+        if (res.ec != std::errc() or res.ptr != end or num >> 61)
+            return false;
+        prefix = Prefix(i);
+        return true;
+    }
+    return false;
+}
+
+Symbol StringInterner::intern(std::string_view str) {
+    if (str.empty())
+        return Symbol();
+    return Symbol(table_.get(str, [&]() {
+        auto mem = static_cast<char *>(arena_.allocate(
+            sizeof(InternedString) + str.size(), alignof(InternedString)));
+        auto interned = new (mem) InternedString{str.size()};
+        std::memcpy(mem + sizeof(InternedString), str.data(), str.size());
+        return interned;
+    }));
+}
@@ -8,6 +8,16 @@
 Type::Type(TypeID tid, Module *m) {
     tid_ = tid;
     m_ = m;
+    // void and label have no class of their own to do it
+    if (tid == VoidTyID or tid == LabelTyID)
+        init_cache();
+}
+
+void Type::init_cache() {
+    sized_ = tid_ != VoidTyID and tid_ != LabelTyID and tid_ != FunctionTyID;
+    if (sized_)
+        size_ = compute_size();
+    print_ = compute_print();
 }
 
 bool Type::is_int1_type() const {
@@ -31,7 +41,7 @@ Type *Type::get_array_element_type() const {
     assert(false and "get_array_element_type() called on non-array type");
 }
 
-unsigned Type::get_size() const {
+unsigned Type::compute_size() const {
     switch (get_type_id()) {
     case IntegerTyID: {
         if (is_int1_type())
@@ -59,7 +69,7 @@ unsigned Type::get_size() const {
     assert(false && "unreachable");
 }
 
-std::string Type::print() const {
+std::string Type::compute_print() const {
     std::string type_ir;
     switch (this->get_type_id()) {
     case VoidTyID:
@@ -111,12 +121,14 @@ std::string Type::print() const {
 }
 
 IntegerType::IntegerType(unsigned num_bits, Module *m)
-    : Type(Type::IntegerTyID, m), num_bits_(num_bits) {}
+    : Type(Type::IntegerTyID, m), num_bits_(num_bits) {
+    init_cache();
+}
 
 unsigned IntegerType::get_num_bits() const { return num_bits_; }
 
-FunctionType::FunctionType(Type *result, std::vector<Type *> params)
-    : Type(Type::FunctionTyID, nullptr) {
+FunctionType::FunctionType(Type *result, const std::vector<Type *> &params)
+    : Type(Type::FunctionTyID, result->get_module()) {
     assert(is_valid_return_type(result) && "Invalid return type for function!");
     result_ = result;
 
@@ -125,6 +137,7 @@ FunctionType::FunctionType(Type *result, std::vector<Type *> params)
                "Not a valid type for function argument!");
         args_.push_back(p);
     }
+    init_cache();
 }
 
 bool FunctionType::is_valid_return_type(Type *ty) {
@@ -136,7 +149,8 @@ bool FunctionType::is_valid_argument_type(Type *ty) {
            ty->is_float_type();
 }
 
-FunctionType *FunctionType::get(Type *result, std::vector<Type *> params) {
+FunctionType *FunctionType::get(Type *result,
+                                const std::vector<Type *> &params) {
     return result->get_module()->get_function_type(result, params);
 }
 
@@ -152,6 +166,7 @@ ArrayType::ArrayType(Type *contained, unsigned num_elements)
     assert(is_valid_element_type(contained) &&
            "Not a valid type for array element!");
     contained_ = contained;
+    init_cache();
 }
 
 bool ArrayType::is_valid_element_type(Type *ty) {
@@ -170,12 +185,13 @@ PointerType::PointerType(Type *contained)
     assert(std::find(allowed_elem_type.begin(), allowed_elem_type.end(),
                      elem_type_id) != allowed_elem_type.end() &&
            "Not allowed type for pointer");
+    init_cache();
 }
 
 PointerType *PointerType::get(Type *contained) {
     return contained->get_module()->get_pointer_type(contained);
 }
 
-FloatType::FloatType(Module *m) : Type(Type::FloatTyID, m) {}
+FloatType::FloatType(Module *m) : Type(Type::FloatTyID, m) { init_cache(); }
 
 FloatType *FloatType::get(Module *m) { return m->get_float_type(); }
@@ -0,0 +1,51 @@
+#include "TypeTable.hpp"
+
+uint64_t TypeKeyInfo::hash(const TypeKey &key) {
+    auto h = hash_mix(reinterpret_cast<uintptr_t>(key.contained) ^ key.tid);
+    h = hash_mix(h ^ key.num_elements);
+    if (key.params) {
+        for (auto param : *key.params)
+            h = hash_mix(h ^ reinterpret_cast<uintptr_t>(param));
+    }
+    return h;
+}
+
+bool TypeKeyInfo::matches(Type *type, const TypeKey &key) {
+    if (type->get_type_id() != key.tid)
+        return false;
+    switch (key.tid) {
+    case Type::PointerTyID:
+        return type->get_pointer_element_type() == key.contained;
+    case Type::ArrayTyID: {
+        auto array_type = static_cast<ArrayType *>(type);
+        return array_type->get_element_type() == key.contained and
+               array_type->get_num_of_elements() == key.num_elements;
+    }
+    case Type::FunctionTyID: {
+        auto func_type = static_cast<FunctionType *>(type);
+        return func_type->get_return_type() == key.contained and
+               func_type->get_params() == *key.params;
+    }
+    default:
+        return false;
+    }
+}
+
+TypeTable::~TypeTable() {
+    // Type has no virtual destructor, free each one as its own class
+    for_each([](Type *type) {
+        switch (type->get_type_id()) {
+        case Type::PointerTyID:
+            delete static_cast<PointerType *>(type);
+            break;
+        case Type::ArrayTyID:
+            delete static_cast<ArrayType *>(type);
+            break;
+        case Type::FunctionTyID:
+            delete static_cast<FunctionType *>(type);
+            break;
+        default:
+            delete type;
+        }
+    });
+}
@@ -1,41 +1,90 @@
 #include "User.hpp"
+#include "Module.hpp"
 
 #include <cassert>
+#include <memory>
 
 void User::set_operand(unsigned i, Value *v) {
-    assert(i < operands_.size() && "set_operand out of index");
-    if (operands_[i]) { // old operand
-        operands_[i]->remove_use(this, i);
+    assert(i < num_operands_ && "set_operand out of index");
+    auto &use = operands_[i];
+    auto old_val = use.value_;
+    if (old_val) { // old operand
+        old_val->remove_use(&use);
     }
+    use.value_ = v;
     if (v) { // new operand
-        v->add_use(this, i);
+        v->add_use(&use);
     }
-    operands_[i] = v;
+    if (old_val != v)
+        on_set_operand(i, old_val);
 }
 
 void User::add_operand(Value *v) {
     assert(v != nullptr && "bad use: add_operand(nullptr)");
-    v->add_use(this, operands_.size());
-    operands_.push_back(v);
+    if (num_operands_ == capacity_) {
+        // the nodes move to the new array, relink them in their use lists
+        capacity_ = capacity_ ? capacity_ * 2 : 4;
+        auto &arena = get_type()->get_module()->get_arena();
+        auto *operands = static_cast<Use *>(
+            arena.allocate(capacity_ * sizeof(Use), alignof(Use)));
+        std::uninitialized_default_construct_n(operands, capacity_);
+        for (unsigned i = 0; i != num_operands_; ++i)
+            move_use(operands_[i], operands[i], i);
+        operands_ = operands;
+    }
+    auto &use = operands_[num_operands_];
+    use.val_ = this;
+    use.arg_no_ = num_operands_++;
+    use.value_ = v;
+    v->add_use(&use);
+    on_set_operand(use.arg_no_, nullptr);
+}
+
+void User::move_use(Use &from, Use &to, unsigned arg_no) {
+    to.val_ = this;
+    to.arg_no_ = arg_no;
+    to.value_ = from.value_;
+    if (from.value_) {
+        from.value_->remove_use(&from);
+        to.value_->add_use(&to);
+    }
+    from.value_ = nullptr;
 }
 
 void User::remove_all_operands() {
-    for (unsigned i = 0; i != operands_.size(); ++i) {
-        if (operands_[i]) {
-            operands_[i]->remove_use(this, i);
+    // last to first, so on_set_operand sees the operands before i unchanged
+    for (unsigned i = num_operands_; i-- > 0;) {
+        auto &use = operands_[i];
+        if (auto old_val = use.value_) {
+            old_val->remove_use(&use);
+            use.value_ = nullptr;
+            on_set_operand(i, old_val);
         }
     }
-    operands_.clear();
+    num_operands_ = 0;
 }
 
-void User::remove_operand(unsigned idx) {
-    assert(idx < operands_.size() && "remove_operand out of index");
-    // influence on other operands
-    for (unsigned i = idx + 1; i < operands_.size(); ++i) {
-        operands_[i]->remove_use(this, i);
-        operands_[i]->add_use(this, i - 1);
+void User::drop_all_references() {
+    for (unsigned i = 0; i != num_operands_; ++i) {
+        auto &use = operands_[i];
+        if (use.value_) {
+            use.value_->drop_all_uses();
+            use.value_ = nullptr;
+        }
     }
+    num_operands_ = 0;
+}
+
+void User::remove_operand(unsigned idx) {
+    assert(idx < num_operands_ && "remove_operand out of index");
     // remove the designated operand
-    operands_[idx]->remove_use(this, idx);
-    operands_.erase(operands_.begin() + idx);
+    auto &use = operands_[idx];
+    auto old_val = use.value_;
+    old_val->remove_use(&use);
+    use.value_ = nullptr;
+    on_set_operand(idx, old_val);
+    // influence on other operands
+    for (unsigned i = idx + 1; i < num_operands_; ++i)
+        move_use(operands_[i], operands_[i - 1], i - 1);
+    num_operands_--;
 }
@@ -1,31 +1,76 @@
 #include "Value.hpp"
+#include "Module.hpp"
 #include "Type.hpp"
 #include "User.hpp"
 
+#include <array>
 #include <cassert>
+#include <cstdint>
+#include <mutex>
 
-bool Value::set_name(std::string name) {
-    if (name_ == "") {
+// striped locks for the use lists of module level values
+static std::mutex &use_list_mutex(const Value *v) {
+    static std::array<std::mutex, 64> stripes;
+    auto addr = reinterpret_cast<uintptr_t>(v);
+    return stripes[(addr >> 4) % stripes.size()];
+}
+
+void *Value::operator new(size_t size, Module *m) {
+    return m->get_arena().allocate(size);
+}
+
+Value::Value(ValueKind kind, Type *ty, const std::string &name)
+    : type_(ty), kind_(kind) {
+    if (not name.empty())
+        name_ = ty->get_module()->get_names().intern(name);
+}
+
+bool Value::set_name(const std::string &name) {
+    return set_name(type_->get_module()->get_names().intern(name));
+}
+
+bool Value::set_name(Symbol name) {
+    if (name_.empty()) {
         name_ = name;
         return true;
     }
     return false;
 }
 
-void Value::add_use(User *user, unsigned arg_no) {
-    use_list_.emplace_back(user, arg_no);
-};
+UseList::iterator &UseList::iterator::operator++() {
+    use_ = use_->next_;
+    return *this;
+}
+
+void Value::add_use(Use *use) {
+    std::unique_lock<std::mutex> lock;
+    if (module_level_)
+        lock = std::unique_lock<std::mutex>(use_list_mutex(this));
+    use->next_ = use_head_;
+    use->prev_ = &use_head_;
+    if (use_head_)
+        use_head_->prev_ = &use->next_;
+    use_head_ = use;
+    num_uses_++;
+}
 
-void Value::remove_use(User *user, unsigned arg_no) {
-    auto target_use = Use(user, arg_no);
-    use_list_.remove_if([&](const Use &use) { return use == target_use; });
+void Value::remove_use(Use *use) {
+    std::unique_lock<std::mutex> lock;
+    if (module_level_)
+        lock = std::unique_lock<std::mutex>(use_list_mutex(this));
+    *use->prev_ = use->next_;
+    if (use->next_)
+        use->next_->prev_ = use->prev_;
+    use->next_ = nullptr;
+    use->prev_ = nullptr;
+    num_uses_--;
 }
 
 void Value::replace_all_use_with(Value *new_val) {
     if (this == new_val)
         return;
-    while (use_list_.size()) {
-        auto use = use_list_.begin();
+    while (use_head_) {
+        auto use = use_head_;
         use->val_->set_operand(use->arg_no_, new_val);
     }
 }
@@ -34,10 +79,11 @@ void Value::replace_use_with_if(Value *new_val,
                                 std::function<bool(Use *)> should_replace) {
     if (this == new_val)
         return;
-    for (auto iter = use_list_.begin(); iter != use_list_.end();) {
-        auto use = *iter++;
-        if (not should_replace(&use))
-            continue;
-        use.val_->set_operand(use.arg_no_, new_val);
+    for (auto use = use_head_; use;) {
+        // set_operand unlinks the node, step past it first
+        auto next = use->next_;
+        if (should_replace(use))
+            use->val_->set_operand(use->arg_no_, new_val);
+        use = next;
     }
 }
@@ -4,17 +4,11 @@
 #include <syntax_analyzer.h>
 
 ///
-extern int lines;
-extern int pos_start;
-extern int pos_end;
-
-///
-extern FILE *yyin;
-extern char *yytext;
-extern int yylex();
-
-// Mac-only hack.
-YYSTYPE yylval;
+extern int yylex(YYSTYPE *yylval_param, yyscan_t scanner);
+extern int yylex_init_extra(struct lex_state *extra, yyscan_t *scanner);
+extern int yylex_destroy(yyscan_t scanner);
+extern void yyset_in(FILE *in, yyscan_t scanner);
+extern char *yyget_text(yyscan_t scanner);
 
 ///
 int main(int argc, const char **argv) {
@@ -24,18 +18,26 @@ int main(int argc, const char **argv) {
     }
 
     const char *input_file = argv[1];
-    yyin = fopen(input_file, "r");
-    if (!yyin) {
+    FILE *input = fopen(input_file, "r");
+    if (!input) {
         fprintf(stderr, "cannot open file: %s\n", input_file);
         return 1;
     }
 
+    struct lex_state state = {1, 1, 1};
+    yyscan_t scanner;
+    yylex_init_extra(&state, &scanner);
+    yyset_in(input, scanner);
+
+    YYSTYPE yylval;
     int token;
     printf("%5s\t%10s\t%s\t%s\n", "Token", "Text", "Line",
            "Column (Start,End)");
-    while ((token = yylex())) {
-        printf("%-5d\t%10s\t%d\t(%d,%d)\n", token, yytext, lines, pos_start,
-               pos_end);
+    while ((token = yylex(&yylval, scanner))) {
+        printf("%-5d\t%10s\t%d\t(%d,%d)\n", token, yyget_text(scanner),
+               state.lines, state.pos_start, state.pos_end);
     }
+    yylex_destroy(scanner);
+    fclose(input);
     return 0;
 }
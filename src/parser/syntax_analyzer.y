@@ -1,3 +1,19 @@
+%code requires {
+#include "syntax_tree.h"
+
+// 词法分析器的位置信息，每次 parse() 独立一份，保证多个线程可以同时分析不同的文件
+struct lex_state {
+    int lines;
+    int pos_start;
+    int pos_end;
+};
+
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void *yyscan_t;
+#endif
+}
+
 %{
 #include <stdio.h>
 #include <stdlib.h>
@@ -6,27 +22,28 @@
 
 #include "syntax_tree.h"
 
-// external functions from lex
-extern int yylex();
-extern int yyparse();
-extern int yyrestart();
-extern FILE * yyin;
+// Helper functions written for you with love
+syntax_tree_node *node(const char *node_name, int children_num, ...);
+%}
 
-// external variables from lexical_analyzer module
-extern int lines;
-extern char * yytext;
-extern int pos_end;
-extern int pos_start;
+%code {
+// external functions from the reentrant lexer
+extern int yylex(YYSTYPE *yylval_param, yyscan_t scanner);
+extern int yylex_init_extra(struct lex_state *extra, yyscan_t *scanner);
+extern int yylex_destroy(yyscan_t scanner);
+extern void yyset_in(FILE *in, yyscan_t scanner);
+extern struct lex_state *yyget_extra(yyscan_t scanner);
 
-// Global syntax tree
-syntax_tree *gt;
+syntax_tree *parse_file(FILE *input);
 
 // Error reporting
-void yyerror(const char *s);
+void yyerror(yyscan_t scanner, syntax_tree *gt, const char *s);
+}
 
-// Helper functions written for you with love
-syntax_tree_node *node(const char *node_name, int children_num, ...);
-%}
+/* 解析器与词法分析器都是可重入的，状态通过参数传递而不是全局变量 */
+%define api.pure full
+%lex-param {yyscan_t scanner}
+%parse-param {yyscan_t scanner} {syntax_tree *gt}
 
 /* Complete this definition.
    Hint: See pass_node(), node(), and syntax_tree.h.
@@ -190,32 +207,51 @@ arg-list 	: 	arg-list COMMA expression {$$ = node( "arg-list", 3, $1, $2, $3);}
 %%
 
 /// The error reporting function.
-void yyerror(const char * s)
+void yyerror(yyscan_t scanner, syntax_tree *gt, const char * s)
 {
     // TO STUDENTS: This is just an example.
     // You can customize it as you like.
-    fprintf(stderr, "error at line %d column %d: %s\n", lines, pos_start, s);
+    struct lex_state *state = yyget_extra(scanner);
+    fprintf(stderr, "error at line %d column %d: %s\n", state->lines,
+            state->pos_start, s);
 }
 
 /// Parse input from file `input_path`, and prints the parsing results
 /// to stdout.  If input_path is NULL, read from stdin.
-///
-/// This function initializes essential states before running yyparse().
 syntax_tree *parse(const char *input_path)
 {
+    FILE *input;
     if (input_path != NULL) {
-        if (!(yyin = fopen(input_path, "r"))) {
+        if (!(input = fopen(input_path, "r"))) {
             fprintf(stderr, "[ERR] Open input file %s failed.\n", input_path);
             exit(1);
         }
     } else {
-        yyin = stdin;
+        input = stdin;
     }
 
-    lines = pos_start = pos_end = 1;
-    gt = new_syntax_tree();
-    yyrestart(yyin);
-    yyparse();
+    syntax_tree *gt = parse_file(input);
+    if (input != stdin)
+        fclose(input);
+    return gt;
+}
+
+/// Parse an opened input stream, e.g. a source buffer from fmemopen().
+///
+/// This function initializes essential states before running yyparse().
+/// All states are local to this call, so it may run on several threads.
+syntax_tree *parse_file(FILE *input)
+{
+    struct lex_state state = {1, 1, 1};
+    yyscan_t scanner;
+    yylex_init_extra(&state, &scanner);
+    yyset_in(input, scanner);
+
+    syntax_tree *gt = new_syntax_tree();
+    gt->root = NULL;
+    yyparse(scanner, gt);
+
+    yylex_destroy(scanner);
     return gt;
 }
 
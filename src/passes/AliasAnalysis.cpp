@@ -0,0 +1,217 @@
+#include "AliasAnalysis.hpp"
+#include "Constant.hpp"
+#include "FuncInfo.hpp"
+#include "Function.hpp"
+#include "GlobalVariable.hpp"
+#include "Instruction.hpp"
+
+#include <algorithm>
+
+/**
+ *!@brief 找出地址逃逸的 alloca
+ * @param f 要分析的函数
+ *
+ * 被 store 作为值写出，或传给会把该形参写入内存的函数（见 FuncInfo）
+ * 的 alloca 才可能经由其它指针再被访问。
+ */
+void AliasAnalysis::run_on_func(Function *f) {
+    auto func_info = am_->get_result<FuncInfo>();
+    escaped_.clear();
+    auto escape = [this](Value *ptr) {
+        auto base = get_underlying_object(ptr);
+        if (dyn_cast<AllocaInst>(base))
+            escaped_.insert(base);
+    };
+    for (auto &bb : f->get_basic_blocks()) {
+        for (auto &inst : bb.get_instructions()) {
+            if (auto store = dyn_cast<StoreInst>(&inst)) {
+                if (store->get_rval()->get_type()->is_pointer_type())
+                    escape(store->get_rval());
+            } else if (inst.is_call()) {
+                auto callee = dyn_cast<Function>(inst.get_operand(0));
+                auto &summary = func_info->get_summary(callee);
+                for (unsigned i = 1; i < inst.get_num_operand(); i++) {
+                    if (summary.escaped_args[i - 1])
+                        escape(inst.get_operand(i));
+                }
+            }
+        }
+    }
+}
+
+/**
+ *!@brief 去掉 GEP 后指针指向的对象
+ * @param ptr 指针
+ *
+ * 未经 mem2reg 时数组形参先存入局部变量，使用时再读出；
+ * 局部变量只被 load 和 store 使用且存入的都指向同一对象时，
+ * 读出的指针也指向该对象。
+ */
+Value *AliasAnalysis::get_underlying_object(Value *ptr) {
+    while (true) {
+        if (auto gep = dyn_cast<GetElementPtrInst>(ptr)) {
+            ptr = gep->get_operand(0);
+            continue;
+        }
+        auto load = dyn_cast<LoadInst>(ptr);
+        auto slot = load ? dyn_cast<AllocaInst>(load->get_lval()) : nullptr;
+        auto stored = slot ? get_stored_object(slot) : nullptr;
+        if (not stored)
+            return ptr;
+        ptr = stored;
+    }
+}
+
+// slot 中存入的指针都指向的对象，不唯一或 slot 另有它用时返回 nullptr
+Value *AliasAnalysis::get_stored_object(AllocaInst *slot) {
+    Value *object = nullptr;
+    for (auto &use : slot->get_use_list()) {
+        if (dyn_cast<LoadInst>(use.val_))
+            continue;
+        auto store = dyn_cast<StoreInst>(use.val_);
+        if (not store or use.arg_no_ != 1)
+            return nullptr;
+        auto stored = get_underlying_object(store->get_rval());
+        if (object and object != stored)
+            return nullptr;
+        object = stored;
+    }
+    return object;
+}
+
+bool AliasAnalysis::is_identified_object(Value *base) {
+    return dyn_cast<AllocaInst>(base) or dyn_cast<GlobalVariable>(base);
+}
+
+// 两个基对象是否可能是同一个对象
+bool AliasAnalysis::may_be_same_object(Value *base1, Value *base2) {
+    if (base1 == base2)
+        return true;
+    if (is_identified_object(base1) and is_identified_object(base2))
+        return false;
+    // 未逃逸的 alloca 只能经由自身访问
+    for (auto base : {base1, base2}) {
+        if (dyn_cast<AllocaInst>(base) and escaped_.count(base) == 0)
+            return false;
+    }
+    return true;
+}
+
+/**
+ *!@brief 把指针拆成 基对象 + 常量偏移 + Σ 变量×步长
+ * @param ptr 要拆分的指针
+ *
+ * GEP 的第一个下标以指向类型的大小为步长，之后每个下标进入一层数组，
+ * 以该层元素的大小为步长。同一个变量出现多次时合并步长。
+ */
+AliasAnalysis::Location AliasAnalysis::decompose(Value *ptr) {
+    Location loc;
+    std::vector<GetElementPtrInst *> geps;
+    while (auto gep = dyn_cast<GetElementPtrInst>(ptr)) {
+        geps.push_back(gep);
+        ptr = gep->get_operand(0);
+    }
+    loc.base = ptr;
+    // 从最内层的 GEP 开始累加
+    for (auto it = geps.rbegin(); it != geps.rend(); ++it) {
+        auto gep = *it;
+        auto ty = gep->get_operand(0)->get_type()->get_pointer_element_type();
+        for (unsigned i = 1; i < gep->get_num_operand(); i++) {
+            if (i > 1)
+                ty = ty->get_array_element_type();
+            long scale = ty->get_size();
+            auto idx = gep->get_operand(i);
+            if (auto c = dyn_cast<ConstantInt>(idx)) {
+                loc.offset += c->get_value() * scale;
+                continue;
+            }
+            auto term = std::find_if(
+                loc.terms.begin(), loc.terms.end(),
+                [idx](const auto &term) { return term.first == idx; });
+            if (term == loc.terms.end())
+                loc.terms.emplace_back(idx, scale);
+            else
+                term->second += scale;
+        }
+    }
+    std::sort(loc.terms.begin(), loc.terms.end());
+    return loc;
+}
+
+/**
+ *!@brief 判断两个指针访问的内存是否重叠
+ * @param p1 第一个指针
+ * @param p2 第二个指针
+ *
+ * 访问大小为指针指向类型的大小。基对象相同且变量部分相同时，
+ * 两次访问为 [offset, offset + size) 的区间，据此给出三种结果。
+ */
+AliasResult AliasAnalysis::alias(Value *p1, Value *p2) {
+    if (p1 == p2)
+        return AliasResult::MustAlias;
+    auto loc1 = decompose(p1);
+    auto loc2 = decompose(p2);
+    if (loc1.base != loc2.base) {
+        return may_be_same_object(loc1.base, loc2.base)
+                   ? AliasResult::MayAlias
+                   : AliasResult::NoAlias;
+    }
+    if (loc1.terms != loc2.terms)
+        return AliasResult::MayAlias;
+    long size1 = p1->get_type()->get_pointer_element_type()->get_size();
+    long size2 = p2->get_type()->get_pointer_element_type()->get_size();
+    if (loc1.offset == loc2.offset and size1 == size2)
+        return AliasResult::MustAlias;
+    if (loc1.offset + size1 <= loc2.offset or
+        loc2.offset + size2 <= loc1.offset)
+        return AliasResult::NoAlias;
+    return AliasResult::MayAlias;
+}
+
+bool AliasAnalysis::may_modify(Instruction *inst, Value *ptr) {
+    if (auto store = dyn_cast<StoreInst>(inst))
+        return alias(store->get_lval(), ptr) != AliasResult::NoAlias;
+    return may_modify_object(inst, ptr);
+}
+
+/**
+ *!@brief 判断指令是否可能写指针所在对象的任意位置
+ * @param inst 指令
+ * @param ptr 指针
+ *
+ * 调用按被调函数的摘要判断：它写的全局变量、它写的形参对应的实参
+ * 所指对象，以及无法确定的内存（见 FuncInfo::Summary）。
+ */
+bool AliasAnalysis::may_modify_object(Instruction *inst, Value *ptr) {
+    auto base = get_underlying_object(ptr);
+    if (auto store = dyn_cast<StoreInst>(inst))
+        return may_be_same_object(get_underlying_object(store->get_lval()),
+                                  base);
+    if (not inst->is_call())
+        return false;
+    auto callee = dyn_cast<Function>(inst->get_operand(0));
+    auto &summary = am_->get_result<FuncInfo>()->get_summary(callee);
+    if (summary.writes_unknown)
+        return true;
+    for (auto global : summary.written_globals) {
+        if (may_be_same_object(global, base))
+            return true;
+    }
+    for (unsigned i = 1; i < inst->get_num_operand(); i++) {
+        if ((summary.args[i - 1] & FuncInfo::Mod) and
+            may_be_same_object(get_underlying_object(inst->get_operand(i)),
+                               base))
+            return true;
+    }
+    return false;
+}
+
+bool AliasAnalysis::is_dereferenceable(Value *ptr) {
+    auto loc = decompose(ptr);
+    if (not is_identified_object(loc.base) or not loc.terms.empty())
+        return false;
+    long object_size =
+        loc.base->get_type()->get_pointer_element_type()->get_size();
+    long size = ptr->get_type()->get_pointer_element_type()->get_size();
+    return loc.offset >= 0 and loc.offset + size <= object_size;
+}
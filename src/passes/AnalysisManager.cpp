@@ -0,0 +1,35 @@
+#include "AnalysisManager.hpp"
+#include "PassManager.hpp"
+
+AnalysisManager::~AnalysisManager() = default;
+
+void AnalysisManager::invalidate(Function *f, const PreservedAnalyses &pa) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &[id, results] : func_results_) {
+        if (not pa.is_preserved(id))
+            results.erase(f);
+    }
+}
+
+void AnalysisManager::invalidate(const PreservedAnalyses &pa) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &[id, results] : func_results_) {
+        if (not pa.is_preserved(id))
+            results.clear();
+    }
+    for (auto it = module_results_.begin(); it != module_results_.end();) {
+        if (not pa.is_preserved(it->first))
+            it = module_results_.erase(it);
+        else
+            ++it;
+    }
+    // pass 之间没有其他以编号为下标的表，函数不再缓存任何分析时，
+    // 压缩其中被删除的基本块和指令留下的编号空洞
+    for (auto &f : m_->get_functions()) {
+        bool cached = false;
+        for (auto &[id, results] : func_results_)
+            cached |= results.count(&f) != 0;
+        if (not cached)
+            f.renumber();
+    }
+}
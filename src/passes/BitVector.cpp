@@ -0,0 +1,169 @@
+#include "BitVector.hpp"
+
+#include <cassert>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// 一次处理 Lanes::words 个字的向量操作，目标不支持 SIMD 时逐字处理
+#if defined(__AVX2__)
+struct Lanes {
+    using Vec = __m256i;
+    static constexpr unsigned words = 4;
+    static Vec load(const uint64_t *p) {
+        return _mm256_loadu_si256(reinterpret_cast<const Vec *>(p));
+    }
+    static void store(uint64_t *p, Vec v) {
+        _mm256_storeu_si256(reinterpret_cast<Vec *>(p), v);
+    }
+    static Vec bit_or(Vec a, Vec b) { return _mm256_or_si256(a, b); }
+    static Vec bit_and(Vec a, Vec b) { return _mm256_and_si256(a, b); }
+    // a & ~b
+    static Vec and_not(Vec a, Vec b) { return _mm256_andnot_si256(b, a); }
+    static Vec bit_xor(Vec a, Vec b) { return _mm256_xor_si256(a, b); }
+    static Vec zero() { return _mm256_setzero_si256(); }
+    static bool is_zero(Vec v) { return _mm256_testz_si256(v, v); }
+};
+#elif defined(__SSE2__)
+struct Lanes {
+    using Vec = __m128i;
+    static constexpr unsigned words = 2;
+    static Vec load(const uint64_t *p) {
+        return _mm_loadu_si128(reinterpret_cast<const Vec *>(p));
+    }
+    static void store(uint64_t *p, Vec v) {
+        _mm_storeu_si128(reinterpret_cast<Vec *>(p), v);
+    }
+    static Vec bit_or(Vec a, Vec b) { return _mm_or_si128(a, b); }
+    static Vec bit_and(Vec a, Vec b) { return _mm_and_si128(a, b); }
+    static Vec and_not(Vec a, Vec b) { return _mm_andnot_si128(b, a); }
+    static Vec bit_xor(Vec a, Vec b) { return _mm_xor_si128(a, b); }
+    static Vec zero() { return _mm_setzero_si128(); }
+    static bool is_zero(Vec v) {
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) ==
+               0xffff;
+    }
+};
+#else
+struct Lanes {
+    using Vec = uint64_t;
+    static constexpr unsigned words = 1;
+    static Vec load(const uint64_t *p) { return *p; }
+    static void store(uint64_t *p, Vec v) { *p = v; }
+    static Vec bit_or(Vec a, Vec b) { return a | b; }
+    static Vec bit_and(Vec a, Vec b) { return a & b; }
+    static Vec and_not(Vec a, Vec b) { return a & ~b; }
+    static Vec bit_xor(Vec a, Vec b) { return a ^ b; }
+    static Vec zero() { return 0; }
+    static bool is_zero(Vec v) { return v == 0; }
+};
+#endif
+
+// 对 n 个字计算 dst[i] = op(dst[i], x[i], y[i], z[i])，op 分别给出
+// 按向量和按字的版本，返回 dst 是否发生变化
+template <typename VecOp, typename WordOp>
+bool apply(uint64_t *dst, const uint64_t *x, const uint64_t *y,
+           const uint64_t *z, unsigned n, VecOp vec_op, WordOp word_op) {
+    unsigned i = 0;
+    auto diff = Lanes::zero();
+    for (; i + Lanes::words <= n; i += Lanes::words) {
+        auto old_val = Lanes::load(dst + i);
+        auto new_val = vec_op(old_val, Lanes::load(x + i), Lanes::load(y + i),
+                              Lanes::load(z + i));
+        diff = Lanes::bit_or(diff, Lanes::bit_xor(old_val, new_val));
+        Lanes::store(dst + i, new_val);
+    }
+    uint64_t tail_diff = 0;
+    for (; i < n; i++) {
+        auto new_val = word_op(dst[i], x[i], y[i], z[i]);
+        tail_diff |= dst[i] ^ new_val;
+        dst[i] = new_val;
+    }
+    return not Lanes::is_zero(diff) or tail_diff != 0;
+}
+
+} // namespace
+
+void BitVector::set_all() {
+    for (auto &word : words_)
+        word = ~Word(0);
+    // 超出 size_ 的位保持为 0
+    if (size_ % word_bits)
+        words_.back() = (Word(1) << (size_ % word_bits)) - 1;
+}
+
+void BitVector::reset_all() {
+    for (auto &word : words_)
+        word = 0;
+}
+
+bool BitVector::any() const {
+    for (auto word : words_) {
+        if (word)
+            return true;
+    }
+    return false;
+}
+
+unsigned BitVector::count() const {
+    unsigned n = 0;
+    for (auto word : words_)
+        n += __builtin_popcountll(word);
+    return n;
+}
+
+unsigned BitVector::find_next(unsigned i) const {
+    if (i >= size_)
+        return size_;
+    unsigned w = i / word_bits;
+    // 去掉 i 之前的位
+    auto word = words_[w] & (~Word(0) << (i % word_bits));
+    while (word == 0) {
+        if (++w == words_.size())
+            return size_;
+        word = words_[w];
+    }
+    return w * word_bits + __builtin_ctzll(word);
+}
+
+bool BitVector::union_with(const BitVector &other) {
+    assert(size_ == other.size_);
+    auto o = other.words_.data();
+    return apply(
+        words_.data(), o, o, o, words_.size(),
+        [](auto d, auto x, auto, auto) { return Lanes::bit_or(d, x); },
+        [](Word d, Word x, Word, Word) { return d | x; });
+}
+
+bool BitVector::intersect_with(const BitVector &other) {
+    assert(size_ == other.size_);
+    auto o = other.words_.data();
+    return apply(
+        words_.data(), o, o, o, words_.size(),
+        [](auto d, auto x, auto, auto) { return Lanes::bit_and(d, x); },
+        [](Word d, Word x, Word, Word) { return d & x; });
+}
+
+bool BitVector::subtract(const BitVector &other) {
+    assert(size_ == other.size_);
+    auto o = other.words_.data();
+    return apply(
+        words_.data(), o, o, o, words_.size(),
+        [](auto d, auto x, auto, auto) { return Lanes::and_not(d, x); },
+        [](Word d, Word x, Word, Word) { return d & ~x; });
+}
+
+bool BitVector::assign_transfer(const BitVector &gen, const BitVector &in,
+                                const BitVector &kill) {
+    assert(size_ == gen.size_ and size_ == in.size_ and size_ == kill.size_);
+    return apply(
+        words_.data(), gen.words_.data(), in.words_.data(),
+        kill.words_.data(), words_.size(),
+        [](auto, auto g, auto i, auto k) {
+            return Lanes::bit_or(g, Lanes::and_not(i, k));
+        },
+        [](Word, Word g, Word i, Word k) { return g | (i & ~k); });
+}
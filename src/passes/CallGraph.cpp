@@ -0,0 +1,102 @@
+#include "CallGraph.hpp"
+#include "BasicBlock.hpp"
+#include "Function.hpp"
+#include "Instruction.hpp"
+
+#include <algorithm>
+#include <unordered_set>
+
+/**
+ *!@brief 构建模块的调用图
+ *
+ * 扫描每个函数中的调用指令得到调用点和被调函数，
+ * 再按函数在模块中的顺序得到调用者，最后求强连通分量。
+ */
+void CallGraph::run() {
+    for (auto &f : m_->get_functions()) {
+        auto &call_sites = call_sites_[&f];
+        auto &callees = callees_[&f];
+        callers_[&f];
+        for (auto &bb : f.get_basic_blocks()) {
+            for (auto &inst : bb.get_instructions()) {
+                auto call = dyn_cast<CallInst>(&inst);
+                if (not call)
+                    continue;
+                call_sites.push_back(call);
+                auto callee = dyn_cast<Function>(call->get_operand(0));
+                if (std::find(callees.begin(), callees.end(), callee) ==
+                    callees.end())
+                    callees.push_back(callee);
+            }
+        }
+    }
+    for (auto &f : m_->get_functions()) {
+        for (auto callee : callees_[&f])
+            callers_[callee].push_back(&f);
+    }
+    compute_sccs();
+}
+
+/**
+ *!@brief 用 Tarjan 算法求调用图的强连通分量
+ *
+ * 用显式栈代替递归。分量在其根结点完成时弹出，此时它调用的分量都已弹出，
+ * 因此 sccs_ 中被调函数所在的分量在前。
+ */
+void CallGraph::compute_sccs() {
+    std::unordered_map<Function *, unsigned> index, lowlink;
+    std::vector<Function *> scc_stack;
+    std::unordered_set<Function *> on_stack;
+    // 栈中每项为函数及其下一个待访问被调函数的下标
+    std::vector<std::pair<Function *, unsigned>> stack;
+    auto visit = [&](Function *func) {
+        unsigned i = index.size();
+        index[func] = lowlink[func] = i;
+        scc_stack.push_back(func);
+        on_stack.insert(func);
+        stack.emplace_back(func, 0);
+    };
+    for (auto &f : m_->get_functions()) {
+        if (index.count(&f))
+            continue;
+        visit(&f);
+        while (not stack.empty()) {
+            auto func = stack.back().first;
+            auto &next = stack.back().second;
+            auto &callees = callees_[func];
+            if (next < callees.size()) {
+                auto callee = callees[next++];
+                if (not index.count(callee))
+                    visit(callee);
+                else if (on_stack.count(callee))
+                    lowlink[func] = std::min(lowlink[func], index[callee]);
+                continue;
+            }
+            stack.pop_back();
+            if (not stack.empty()) {
+                auto caller = stack.back().first;
+                lowlink[caller] = std::min(lowlink[caller], lowlink[func]);
+            }
+            if (lowlink[func] != index[func])
+                continue;
+            auto &scc = sccs_.emplace_back();
+            Function *member;
+            do {
+                member = scc_stack.back();
+                scc_stack.pop_back();
+                on_stack.erase(member);
+                scc.push_back(member);
+                scc_index_[member] = sccs_.size() - 1;
+            } while (member != func);
+        }
+    }
+    for (auto &scc : sccs_) {
+        for (auto func : scc) {
+            auto &callees = callees_[func];
+            recursive_[func] =
+                scc.size() > 1 or
+                std::find(callees.begin(), callees.end(), func) !=
+                    callees.end();
+        }
+    }
+}
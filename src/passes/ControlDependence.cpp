@@ -0,0 +1,19 @@
+#include "ControlDependence.hpp"
+#include "Function.hpp"
+#include "PostDominators.hpp"
+
+/**
+ *!@brief 由后必经边界构建函数的控制依赖图
+ * @param f 要分析的函数
+ */
+void ControlDependence::run_on_func(Function *f) {
+    auto post_dominators = am_->get_result<PostDominators>(f);
+    auto num_blocks = f->get_num_block_indices();
+    controllers_.reset(num_blocks);
+    dependents_.reset(num_blocks);
+    for (auto &bb : f->get_basic_blocks()) {
+        controllers_[&bb] = post_dominators->get_post_dominance_frontier(&bb);
+        for (auto controller : controllers_[&bb])
+            dependents_[controller].push_back(&bb);
+    }
+}
@@ -1,20 +1,25 @@
 #include "DeadCode.hpp"
 #include "logging.hpp"
+#include <cassert>
 #include <vector>
 
 // 处理流程：两趟处理，mark 标记有用变量，sweep 删除无用指令
-void DeadCode::run() {
+void DeadCode::init() { func_info = am_->get_result<FuncInfo>(); }
+
+// 各函数的死代码互不影响，逐函数迭代到不动点
+void DeadCode::run_on_func(Function *func) {
     bool changed{};
-    func_info->run();
     do {
         changed = false;
-        for (auto &F : m_->get_functions()) {
-            auto func = &F;
-            changed |= clear_basic_blocks(func);
-            mark(func);
-            changed |= sweep(func);
-        }
+        changed |= clear_basic_blocks(func);
+        mark(func);
+        if (aggressive_)
+            changed |= redirect_dead_branches(func);
+        changed |= sweep(func);
     } while (changed);
+}
+
+void DeadCode::finish() {
     LOG_INFO << "dead code pass erased " << ins_count << " instructions";
 }
 
@@ -28,23 +33,33 @@ bool DeadCode::clear_basic_blocks(Function *func) {
             changed = 1;
         }
     }
+    // 删除的基本块都不可达，缓存的支配树可以增量更新
+    auto dominators = am_->get_cached_result<Dominators>(func);
     for (auto &bb : to_erase) {
+        if (dominators)
+            dominators->remove_block(bb);
         bb->erase_from_parent();
         delete bb;
     }
+    // CFG 发生变化，该函数缓存的循环信息不再有效
+    if (changed)
+        am_->invalidate(func, PreservedAnalyses::none().preserve<Dominators>());
     return changed;
 }
 
 void DeadCode::mark(Function *func) {
     work_list.clear();
-    marked.clear();
+    marked.reset(func->get_num_inst_indices());
+    if (aggressive_) {
+        post_dominators = am_->get_result<PostDominators>(func);
+        control_dependence = am_->get_result<ControlDependence>(func);
+        live_blocks.reset(func->get_num_block_indices());
+    }
 
     for (auto &bb : func->get_basic_blocks()) {
         for (auto &ins : bb.get_instructions()) {
-            if (is_critical(&ins)) {
-                marked[&ins] = true;
-                work_list.push_back(&ins);
-            }
+            if (is_critical(&ins))
+                mark_live(&ins);
         }
     }
 
@@ -58,16 +73,74 @@ void DeadCode::mark(Function *func) {
 
 void DeadCode::mark(Instruction *ins) {
     for (auto op : ins->get_operands()) {
-        auto def = dynamic_cast<Instruction *>(op);
-        if (def == nullptr)
+        // 有用的 phi 要求从各前驱进入的边不变，前驱末尾的分支也有用
+        if (auto pred = dyn_cast<BasicBlock>(op)) {
+            if (aggressive_ and ins->is_phi())
+                mark_live(pred->get_terminator());
             continue;
-        if (marked[def])
+        }
+        auto def = dyn_cast<Instruction>(op);
+        if (def == nullptr)
             continue;
+        // 编号只在函数内有意义，先排除其他函数的指令
         if (def->get_function() != ins->get_function())
             continue;
-        marked[def] = true;
-        work_list.push_back(def);
+        mark_live(def);
+    }
+    if (not aggressive_)
+        return;
+    // 基本块中有了有用指令，决定它是否执行的分支也有用
+    auto bb = ins->get_parent();
+    if (live_blocks[bb])
+        return;
+    live_blocks[bb] = true;
+    for (auto controller : control_dependence->get_controllers(bb))
+        mark_live(controller->get_terminator());
+}
+
+void DeadCode::mark_live(Instruction *ins) {
+    if (marked[ins])
+        return;
+    marked[ins] = true;
+    work_list.push_back(ins);
+}
+
+/**
+ *!@brief 将无用的分支改为跳转到最近的有用后必经结点
+ * @param func 要处理的函数
+ * @return CFG 是否发生变化
+ *
+ * 分支无用说明没有有用的基本块控制依赖于它，从它所在的基本块
+ * 到最近的含有用指令的后必经结点之间都是无用指令，可以直接跳过；
+ * 那个后必经结点的前驱都不在这段路径上，因此也没有需要补充的 phi。
+ * 跳过的基本块变为不可达，下一轮由 clear_basic_blocks 删除。
+ */
+bool DeadCode::redirect_dead_branches(Function *func) {
+    std::vector<std::pair<BasicBlock *, BasicBlock *>> jumps;
+    for (auto &bb : func->get_basic_blocks()) {
+        auto br = bb.get_terminator();
+        if (marked[br])
+            continue;
+        auto target = post_dominators->get_ipdom(&bb);
+        while (target != nullptr and not live_blocks[target])
+            target = post_dominators->get_ipdom(target);
+        assert(target != nullptr && "dead branch without live post-dominator");
+        auto &succs = bb.get_succ_basic_blocks();
+        if (succs.size() == 1 and succs[0] == target) {
+            marked[br] = true;
+            continue;
+        }
+        jumps.emplace_back(&bb, target);
     }
+    for (auto [bb, target] : jumps) {
+        bb->erase_instr(bb->get_terminator());
+        marked[BranchInst::create_br(target, bb)] = true;
+    }
+    if (jumps.empty())
+        return false;
+    // CFG 发生变化，该函数缓存的 CFG 分析都不再有效
+    am_->invalidate(func, PreservedAnalyses::none());
+    return true;
 }
 
 bool DeadCode::sweep(Function *func) {
@@ -94,16 +167,18 @@ bool DeadCode::sweep(Function *func) {
 }
 
 bool DeadCode::is_critical(Instruction *ins) {
-    // 对纯函数的无用调用也可以在删除之列
+    // 对没有副作用的函数（只读内存）的无用调用也可以在删除之列
     if (ins->is_call()) {
-        auto call_inst = dynamic_cast<CallInst *>(ins);
-        auto callee = dynamic_cast<Function *>(call_inst->get_operand(0));
-        if (func_info->is_pure_function(callee))
-            return false;
-        return true;
+        auto call_inst = dyn_cast<CallInst>(ins);
+        auto callee = dyn_cast<Function>(call_inst->get_operand(0));
+        return func_info->has_side_effect(callee);
     }
-    if (ins->is_br() || ins->is_ret())
+    if (ins->is_ret())
         return true;
+    // aggressive 模式下只保留死循环中的分支，其余分支按控制依赖标记
+    if (ins->is_br())
+        return not aggressive_ or
+               not post_dominators->reaches_exit(ins->get_parent());
     if (ins->is_store())
         return true;
     return false;
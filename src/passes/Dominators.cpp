@@ -1,157 +1,221 @@
 #include "../../include/passes/Dominators.hpp"
 #include "BasicBlock.hpp"
 #include "Function.hpp"
+#include <algorithm>
 #include <fstream>
+#include <queue>
 #include <vector>
 #include "logging.hpp"
 
-/**
- * @brief 支配器分析的入口函数
- * 
- *!遍历模块中的所有函数，对每个非声明的函数执行支配关系分析。
- */
-void Dominators::run() {
-    // printf("This is Dom run\n");
-    for(auto &f1 : m_->get_functions()) {
-        auto f = &f1;
-        if(f->is_declaration())
-            continue;
-        // printf("Dom run_on_func start\n");
-        run_on_func(f);
-        // printf("Dom run_on_func finished\n");
-        // print_idom(f);
-        // print_dominance_frontier(f);
-        // dump_cfg(f);
-        // printf("Done! Dom run\n");
-    }
-}
-
 /**
  *!@brief 对单个函数执行支配关系分析
  * @param f 要分析的函数
  * 
  * 该函数执行完整的支配关系分析流程：
- * 1. 初始化数据结构
- * 2. 创建反向后序遍历序列
- * 3. 计算直接支配者(idom)
- * 4. 计算支配边界
- * 5. 构建支配树的后继关系
- * 6. 创建支配树的DFS序
+ * 1. 按 f 的基本块编号初始化各表
+ * 2. 深度优先遍历 CFG，得到先序和后序编号
+ * 3. 计算直接支配者(idom)，基本块较多时使用 Semi-NCA 算法
+ * 4. 构建支配树的后继关系和各节点的层数
+ * 支配树的DFS序和支配边界在第一次查询时计算
  */
 void Dominators::run_on_func(Function *f) {
-    dom_post_order_.clear();
-    dom_dfs_order_.clear();
-    for(auto &bb1 : f->get_basic_blocks()) {
-        auto bb = &bb1;
-        idom_.insert({bb, nullptr});
-        dom_frontier_.insert({bb, {}});
-        dom_tree_succ_blocks_.insert({bb, {}});
+    func_ = f;
+    auto num_blocks = f->get_num_block_indices();
+    pre_order_.reset(num_blocks);
+    post_order_.reset(num_blocks);
+    idom_.reset(num_blocks);
+    dom_tree_succ_blocks_.reset(num_blocks);
+    dom_tree_level_.reset(num_blocks);
+    marked_.reset(num_blocks);
+    dom_order_valid_ = false;
+    frontier_valid_ = false;
+
+    auto entry = f->get_entry_block();
+    run_dfs(entry, [](BasicBlock *) { return true; });
+    bool use_semi_nca = algorithm_ == Algorithm::SemiNCA or
+                        (algorithm_ == Algorithm::Auto and
+                         post_order_vec_.size() >= semi_nca_threshold);
+    set_idom(entry, entry);
+    if (use_semi_nca) {
+        semi_nca();
+        for (unsigned w = 2; w <= pre_order_vec_.size(); w++)
+            set_idom(pre_order_vec_[w - 1], pre_order_vec_[semi_idom_[w] - 1]);
+    } else {
+        create_idom(f);
     }
-    create_reverse_post_order(f);
-    create_idom(f);
-    create_dominance_frontier(f);
+    clear_dfs();
     create_dom_tree_succ(f);
-    create_dom_dfs_order(f);
 }
 
 /**
  *!@brief 计算两个基本块的支配关系交集
- * @param b1 第一个基本块
- * @param b2 第二个基本块
- * @return 返回在支配树上最深的同时支配b1和b2的节点
+ * @param doms 以后序号为下标的直接支配者后序号
+ * @param b1 第一个基本块的后序号
+ * @param b2 第二个基本块的后序号
+ * @return 返回在支配树上最深的同时支配b1和b2的节点的后序号
  * 
  * 该函数使用后序号来查找两个节点的最近公共支配者。
  * 通过在支配树上向上遍历直到找到交点。
  */
-BasicBlock *Dominators::intersect(BasicBlock *b1, BasicBlock *b2) {
+unsigned Dominators::intersect(const std::vector<unsigned> &doms, unsigned b1,
+                               unsigned b2) {
     while (b1 != b2) {
-        while (get_post_order(b1) < get_post_order(b2)) {
-            b1 = get_idom(b1);
+        while (b1 < b2) {
+            b1 = doms[b1];
         }
-        while (get_post_order(b2) < get_post_order(b1)) {
-            b2 = get_idom(b2);
+        while (b2 < b1) {
+            b2 = doms[b2];
         }
     }
     return b1;
 }
 
 /**
- *!@brief 创建函数的反向后序遍历序列
- * @param f 要处理的函数
- * 
- * 通过DFS遍历CFG来构建基本块的后序遍历序列。
- * 这个序列用于后续的支配关系分析。
- */
-void Dominators::create_reverse_post_order(Function *f) {
-    BBSet visited;
-    dfs(f->get_entry_block(), visited);
-}
-
-/**
- *!@brief 深度优先搜索辅助函数
- * @param bb 当前遍历的基本块
- * @param visited 已访问的基本块集合
+ *!@brief 从 root 出发深度优先遍历 CFG
+ * @param root 遍历的起点
+ * @param descend 只进入 descend 返回 true 的后继
  * 
- * 执行DFS遍历，维护后序遍历序列和每个基本块的后序号。
+ * 用显式栈代替递归，长的 if/while 链不会耗尽调用栈。
+ * 访问顺序与递归实现相同：
+ * - pre_order_vec_/pre_order_：先序序列和从 1 开始的先序号，0 表示未访问
+ * - pre_order_parent_：DFS 树上父节点的先序号
+ * - post_order_vec_/post_order_：后序序列和后序号
+ * 使用完毕后由 clear_dfs 清除，以便增量更新时在子图上再次遍历。
  */
-void Dominators::dfs(BasicBlock *bb, std::set<BasicBlock *> &visited) {
-    visited.insert(bb);
-    for (auto &succ : bb->get_succ_basic_blocks()) {
-        if (visited.find(succ) == visited.end()) {
-            dfs(succ, visited);
+void Dominators::run_dfs(BasicBlock *root,
+                         const std::function<bool(BasicBlock *)> &descend) {
+    // 栈中每项为基本块及其下一个待访问后继的下标
+    std::vector<std::pair<BasicBlock *, unsigned>> stack;
+    auto visit = [&](BasicBlock *bb, unsigned parent) {
+        pre_order_vec_.push_back(bb);
+        pre_order_parent_.push_back(parent);
+        pre_order_[bb] = pre_order_vec_.size();
+        stack.emplace_back(bb, 0);
+    };
+    visit(root, 0);
+    while (not stack.empty()) {
+        auto &[bb, next] = stack.back();
+        auto &succs = bb->get_succ_basic_blocks();
+        if (next < succs.size()) {
+            auto succ = succs[next++];
+            if (pre_order_.at(succ) == 0 and descend(succ))
+                visit(succ, pre_order_[bb]);
+            continue;
         }
+        post_order_[bb] = post_order_vec_.size();
+        post_order_vec_.push_back(bb);
+        stack.pop_back();
     }
-    post_order_vec_.push_back(bb);
-    post_order_.insert({bb, post_order_.size()});
+}
+
+void Dominators::clear_dfs() {
+    for (auto bb : pre_order_vec_)
+        pre_order_[bb] = 0;
+    pre_order_vec_.clear();
+    pre_order_parent_.clear();
+    post_order_vec_.clear();
 }
 
 /**
  *!@brief 计算所有基本块的直接支配者(immediate dominator)
  * @param f 要分析的函数
  * 
- * 使用迭代算法计算每个基本块的直接支配者：
+ * 使用迭代算法(Cooper-Harvey-Kennedy)计算每个基本块的直接支配者：
  * 1. 将入口块的直接支配者设置为自身
- * 2. 重复遍历所有基本块，更新它们的直接支配者
+ * 2. 按逆后序重复遍历所有基本块，更新它们的直接支配者
  * 3. 当没有变化时算法终止
+ * 迭代过程中以后序号表示基本块，直接支配者存放在连续的数组中。
  */
 void Dominators::create_idom(Function *f) {
-    // TODO 分析得到 f 中各个基本块的 idom
-    // throw "Unimplemented create_idom";
     // ? 1. 将入口块的直接支配者设置为自身
-    auto entry_block = f->get_entry_block();
-    set_idom(entry_block, entry_block);
-    for (auto &bb : f->get_basic_blocks()){
-        if (&bb != entry_block)
-            set_idom(&bb, nullptr);
-    }
+    const unsigned undefined = ~0u;
+    unsigned entry = post_order_vec_.size() - 1;
+    std::vector<unsigned> doms(post_order_vec_.size(), undefined);
+    doms[entry] = entry;
     bool changed = true;
     // ? 2. 重复遍历所有基本块，更新它们的直接支配者
     // ? 3. 当没有变化时算法终止
-    std::vector<BasicBlock *> reverse_post_order;
-    reverse_post_order.assign(post_order_vec_.rbegin(), post_order_vec_.rend());
     while (changed){
         changed = false;
-        for (auto &bb : reverse_post_order){
-            if (bb == entry_block)
-                continue;
-            BasicBlock *new_idom = nullptr;
+        for (unsigned b = entry; b-- > 0;) {
+            unsigned new_idom = undefined;
             // 所有已经获得的idom
-            for (auto pred : bb->get_pre_basic_blocks()) {
-                if (get_idom(pred) != nullptr) {
-                    if (new_idom == nullptr) {
-                        new_idom = pred;
+            for (auto pred : post_order_vec_[b]->get_pre_basic_blocks()) {
+                if (pre_order_.at(pred) == 0)
+                    continue; // 不可达的前驱
+                unsigned p = post_order_[pred];
+                if (doms[p] != undefined) {
+                    if (new_idom == undefined) {
+                        new_idom = p;
                     } else {
-                        new_idom = intersect(new_idom, pred);
+                        new_idom = intersect(doms, new_idom, p);
                     }
                 }
             }
             
-            if (get_idom(bb) != new_idom){
-                set_idom(bb, new_idom);
+            if (doms[b] != new_idom){
+                doms[b] = new_idom;
                 changed = true;
             }
         }
     }
+    for (unsigned b = 0; b < entry; b++)
+        set_idom(post_order_vec_[b], post_order_vec_[doms[b]]);
+}
+
+/**
+ *!@brief 使用 Semi-NCA 算法计算 DFS 树上各节点的直接支配者
+ * 
+ * 与 Lengauer-Tarjan 算法一样先求半支配者，再沿 DFS 树
+ * 求半支配者与父节点的最近公共祖先作为直接支配者，
+ * 时间为 O(n log n)，与 CFG 的形状无关；迭代算法在基本块很多、
+ * 回边嵌套很深时需要多轮遍历。
+ * 只考虑上一次 run_dfs 访问到的基本块，以 DFS 的起点为根，
+ * 结果以先序号存放在 semi_idom_ 中，0 表示空。
+ */
+void Dominators::semi_nca() {
+    unsigned n = pre_order_vec_.size();
+    std::vector<unsigned> semi(n + 1), label(n + 1), ancestor(n + 1, 0);
+    std::vector<unsigned> path;
+    semi_idom_.assign(n + 1, 0);
+    for (unsigned v = 1; v <= n; v++)
+        semi[v] = label[v] = v;
+
+    // 带路径压缩的 eval：v 到其所在森林中树根（不含）路径上半支配者最小的点
+    auto eval = [&](unsigned v) {
+        if (ancestor[v] == 0)
+            return v;
+        path.clear();
+        for (auto u = v; ancestor[ancestor[u]] != 0; u = ancestor[u])
+            path.push_back(u);
+        // 从靠近树根的一端开始压缩
+        for (auto it = path.rbegin(); it != path.rend(); ++it) {
+            auto u = *it, a = ancestor[u];
+            if (semi[label[a]] < semi[label[u]])
+                label[u] = label[a];
+            ancestor[u] = ancestor[a];
+        }
+        return label[v];
+    };
+
+    // 按先序逆序求半支配者，处理完的点挂到 DFS 树的父节点下
+    for (unsigned w = n; w >= 2; w--) {
+        for (auto pred : pre_order_vec_[w - 1]->get_pre_basic_blocks()) {
+            unsigned v = pre_order_.at(pred);
+            if (v == 0)
+                continue; // 不在本次遍历范围内的前驱
+            semi[w] = std::min(semi[w], semi[eval(v)]);
+        }
+        ancestor[w] = pre_order_parent_[w - 1];
+    }
+
+    // 直接支配者是父节点沿支配树向上第一个先序号不大于半支配者的点
+    for (unsigned w = 2; w <= n; w++) {
+        auto &idom = semi_idom_[w];
+        idom = pre_order_parent_[w - 1];
+        while (idom > semi[w])
+            idom = semi_idom_[idom];
+    }
 }
 
 /**
@@ -161,11 +225,14 @@ void Dominators::create_idom(Function *f) {
  * 对于每个有多个前驱的基本块B：
  * 从每个前驱P开始，沿着支配树向上遍历直到遇到B的直接支配者，
  * 将B加入路径上所有节点的支配边界中。
+ * B 的处理集中在一轮内，已加入过 B 的边界以 B 结尾，借此去重。
  */
 void Dominators::create_dominance_frontier(Function *f) {
     // TODO 分析得到 f 中各个基本块的支配边界集合
     // throw "Unimplemented create_dominance_frontier";
     // printf("This is create_dominance_frontier\n");
+    dom_frontier_.reset(f->get_num_block_indices());
+    frontier_valid_ = true;
     for (auto &bb : f->get_basic_blocks()){
         // ? 对于每个有多个前驱的基本块B
         if (bb.get_pre_basic_blocks().size() >= 2){
@@ -176,7 +243,9 @@ void Dominators::create_dominance_frontier(Function *f) {
                 // LOG(DEBUG) << "Runner is \n" << runner->print() << "...\n";
                 while (runner != get_idom(&bb) && runner != &bb){
                     // ? 将B加入路径上所有节点的支配边界中
-                    dom_frontier_[runner].insert(&bb);
+                    auto &df = dom_frontier_[runner];
+                    if (df.empty() || df.back() != &bb)
+                        df.push_back(&bb);
                     // LOG(DEBUG) << "Add \n" << bb.print() << " to " << runner->print() << "'s dominance frontier\n";
                     if (get_idom(runner) == runner || get_idom(runner) == nullptr)
                         break;
@@ -193,6 +262,7 @@ void Dominators::create_dominance_frontier(Function *f) {
  * 
  * 基于已计算的直接支配者关系，构建支配树的子节点关系。
  * 如果A是B的直接支配者，则B是A在支配树上的后继。
+ * 同时按先序求出各节点在支配树上的层数，入口块为 0 层。
  */
 void Dominators::create_dom_tree_succ(Function *f) {
     // TODO 分析得到 f 中各个基本块的支配树后继
@@ -203,6 +273,7 @@ void Dominators::create_dom_tree_succ(Function *f) {
             add_dom_tree_succ_block(idom_bb, &bb);
         }
     }
+    update_levels(f->get_entry_block());
 }
 
 /**
@@ -219,23 +290,341 @@ void Dominators::create_dom_tree_succ(Function *f) {
  * 
  * 这些序号和顺序可用于快速判断支配关系：
  * 如果节点A支配节点B，则A的L值小于B的L值，且A的R值大于B的R值
+ * 与 CFG 的遍历一样使用显式栈。
  */
 void Dominators::create_dom_dfs_order(Function *f) {
     // 分析得到 f 中各个基本块的支配树上的dfs序L,R
+    dom_tree_L_.reset(f->get_num_block_indices());
+    dom_tree_R_.reset(f->get_num_block_indices());
+    dom_dfs_order_.clear();
+    dom_order_valid_ = true;
     unsigned int order = 0;
-    std::function<void(BasicBlock *)> dfs = [&](BasicBlock *bb) {
+    std::vector<std::pair<BasicBlock *, unsigned>> stack;
+    auto visit = [&](BasicBlock *bb) {
         dom_tree_L_[bb] = ++ order;
         dom_dfs_order_.push_back(bb);
-        for (auto &succ : dom_tree_succ_blocks_[bb]) {
-            dfs(succ);
+        stack.emplace_back(bb, 0);
+    };
+    visit(f->get_entry_block());
+    while (not stack.empty()) {
+        auto &[bb, next] = stack.back();
+        auto &succs = dom_tree_succ_blocks_[bb];
+        if (next < succs.size()) {
+            visit(succs[next++]);
+            continue;
         }
         dom_tree_R_[bb] = order;
-    };
-    dfs(f->get_entry_block());
+        stack.pop_back();
+    }
     dom_post_order_ =
         std::vector(dom_dfs_order_.rbegin(), dom_dfs_order_.rend());
 }
 
+/**
+ *!@brief 重新计算支配树上 root 子树中各节点的层数
+ * @param root 子树的根，其层数由直接支配者得到，入口块为 0 层
+ */
+void Dominators::update_levels(BasicBlock *root) {
+    auto idom = get_idom(root);
+    dom_tree_level_[root] = idom == root ? 0 : dom_tree_level_[idom] + 1;
+    std::vector<BasicBlock *> stack{root};
+    while (not stack.empty()) {
+        auto bb = stack.back();
+        stack.pop_back();
+        for (auto child : dom_tree_succ_blocks_[bb]) {
+            dom_tree_level_[child] = dom_tree_level_[bb] + 1;
+            stack.push_back(child);
+        }
+    }
+}
+
+/**
+ *!@brief 支配树上两个可达基本块的最近公共祖先
+ * 
+ * 沿直接支配者向上，每次移动层数较深的一方，
+ * 不依赖支配树的DFS序，增量更新的过程中也可以使用。
+ */
+BasicBlock *Dominators::nca(BasicBlock *b1, BasicBlock *b2) {
+    while (b1 != b2) {
+        if (dom_tree_level_.at(b1) < dom_tree_level_.at(b2))
+            std::swap(b1, b2);
+        b1 = get_idom(b1);
+    }
+    return b1;
+}
+
+/**
+ *!@brief 把 bb 从原来的直接支配者下移到 idom 下，不更新层数
+ */
+void Dominators::reparent(BasicBlock *bb, BasicBlock *idom) {
+    auto old_idom = get_idom(bb);
+    if (old_idom == idom)
+        return;
+    if (old_idom != nullptr && old_idom != bb) {
+        auto &siblings = dom_tree_succ_blocks_[old_idom];
+        siblings.erase(std::find(siblings.begin(), siblings.end(), bb));
+    }
+    set_idom(bb, idom);
+    add_dom_tree_succ_block(idom, bb);
+}
+
+/**
+ *!@brief CFG 中加入边 from->to 后更新支配树
+ * 
+ * from 不可达时支配关系不变；to 原本不可达时，
+ * 先对新变为可达的部分求支配树，再处理其中指向原可达部分的边。
+ */
+void Dominators::insert_edge(BasicBlock *from, BasicBlock *to) {
+    dom_order_valid_ = false;
+    frontier_valid_ = false;
+    if (not is_reachable(from))
+        return;
+    if (is_reachable(to))
+        insert_reachable_edge(from, to);
+    else
+        insert_unreachable_edge(from, to);
+}
+
+/**
+ *!@brief 加入两端都可达的边 from->to
+ * 
+ * 设 d 为 from 与 to 在支配树上的最近公共祖先，受影响的节点 v 满足：
+ * 层数大于 d 的层数加一，且存在一条从 to 到 v 的路径，
+ * 路径上每个节点的层数都不小于 v 的层数。
+ * 受影响节点的直接支配者都变为 d。
+ * 从 to 出发按层数从深到浅搜索这些节点(Georgiadis 等的 depth-based search)，
+ * 只访问 d 的子树中会变化的部分。
+ */
+void Dominators::insert_reachable_edge(BasicBlock *from, BasicBlock *to) {
+    auto d = nca(from, to);
+    if (d == to || d == get_idom(to))
+        return;
+    unsigned d_level = dom_tree_level_[d];
+
+    auto deeper = [this](BasicBlock *b1, BasicBlock *b2) {
+        return dom_tree_level_.at(b1) < dom_tree_level_.at(b2);
+    };
+    std::priority_queue<BasicBlock *, std::vector<BasicBlock *>,
+                        decltype(deeper)>
+        bucket(deeper);
+    std::vector<BasicBlock *> visited{to}, affected, unaffected;
+    marked_[to] = true;
+    bucket.push(to);
+    while (not bucket.empty()) {
+        auto bb = bucket.top();
+        bucket.pop();
+        affected.push_back(bb);
+        // 从 bb 出发，经过层数不小于 bb 的节点继续搜索
+        unsigned level = dom_tree_level_[bb];
+        while (true) {
+            for (auto succ : bb->get_succ_basic_blocks()) {
+                if (not is_reachable(succ) or marked_[succ] or
+                    dom_tree_level_[succ] <= d_level + 1)
+                    continue;
+                marked_[succ] = true;
+                visited.push_back(succ);
+                if (dom_tree_level_[succ] > level)
+                    unaffected.push_back(succ); // 本身不变，但可以经过它
+                else
+                    bucket.push(succ);
+            }
+            if (unaffected.empty())
+                break;
+            bb = unaffected.back();
+            unaffected.pop_back();
+        }
+    }
+    for (auto bb : visited)
+        marked_[bb] = false;
+
+    for (auto bb : affected)
+        reparent(bb, d);
+    for (auto bb : affected)
+        update_levels(bb);
+}
+
+/**
+ *!@brief 加入边 from->to，from 可达而 to 不可达
+ * 
+ * 以 to 为根，对原本不可达、现在经 to 可达的基本块求支配树，
+ * 再挂到 from 下；其中指向原可达部分的边按可达的边逐条加入。
+ */
+void Dominators::insert_unreachable_edge(BasicBlock *from, BasicBlock *to) {
+    run_dfs(to, [this](BasicBlock *bb) { return not is_reachable(bb); });
+    semi_nca();
+    std::vector<std::pair<BasicBlock *, BasicBlock *>> edges;
+    // 先序中直接支配者总在前面，可以依次求出层数
+    reparent(to, from);
+    dom_tree_level_[to] = dom_tree_level_[from] + 1;
+    for (unsigned w = 1; w <= pre_order_vec_.size(); w++) {
+        auto bb = pre_order_vec_[w - 1];
+        if (w >= 2) {
+            auto idom = pre_order_vec_[semi_idom_[w] - 1];
+            reparent(bb, idom);
+            dom_tree_level_[bb] = dom_tree_level_[idom] + 1;
+        }
+        for (auto succ : bb->get_succ_basic_blocks()) {
+            if (pre_order_.at(succ) == 0 and is_reachable(succ))
+                edges.emplace_back(bb, succ);
+        }
+    }
+    clear_dfs();
+    for (auto [src, dst] : edges)
+        insert_reachable_edge(src, dst);
+}
+
+/**
+ *!@brief CFG 中删除边 from->to 后更新支配树
+ * 
+ * 设 d 为 from 与 to 在支配树上的最近公共祖先。d 就是 to 时，
+ * 删除的是回到 to 的边，支配关系不变。
+ * to 仍有不被它支配的可达前驱，或 from 不是 to 的直接支配者时，
+ * to 仍然可达，只有 d 的子树可能变化；否则 to 变为不可达。
+ */
+void Dominators::delete_edge(BasicBlock *from, BasicBlock *to) {
+    dom_order_valid_ = false;
+    frontier_valid_ = false;
+    if (not is_reachable(from) or not is_reachable(to))
+        return;
+    auto d = nca(from, to);
+    if (d == to)
+        return;
+    bool supported = false;
+    for (auto pred : to->get_pre_basic_blocks())
+        supported |= is_reachable(pred) and not dominates(to, pred);
+    if (get_idom(to) != from or supported)
+        rebuild_subtree(d);
+    else
+        delete_unreachable(to);
+}
+
+/**
+ *!@brief 删除边后 to 变为不可达
+ * 
+ * to 的子树整体变为不可达。从 to 出发遍历子树时遇到的
+ * 子树外节点可能失去经过 to 的路径，它们与 to 的最近公共祖先中
+ * 最浅的一个为根的子树需要重建。
+ */
+void Dominators::delete_unreachable(BasicBlock *to) {
+    unsigned level = dom_tree_level_[to];
+    std::vector<BasicBlock *> affected;
+    run_dfs(to, [&](BasicBlock *bb) {
+        if (dom_tree_level_.at(bb) > level)
+            return true;
+        if (is_reachable(bb))
+            affected.push_back(bb);
+        return false;
+    });
+    auto top = to;
+    for (auto bb : affected) {
+        auto d = nca(bb, to);
+        if (d != bb and dom_tree_level_[d] < dom_tree_level_[top])
+            top = d;
+    }
+    if (get_idom(top) == top) {
+        // 需要从入口块重建
+        clear_dfs();
+        run_on_func(func_);
+        return;
+    }
+
+    auto &siblings = dom_tree_succ_blocks_[get_idom(to)];
+    siblings.erase(std::find(siblings.begin(), siblings.end(), to));
+    for (auto bb : pre_order_vec_) {
+        dom_tree_succ_blocks_[bb].clear();
+        set_idom(bb, nullptr);
+        dom_tree_level_[bb] = 0;
+    }
+    clear_dfs();
+    if (top != to)
+        rebuild_subtree(top);
+}
+
+/**
+ *!@brief 在 d 的子树内以 d 为根重新求直接支配者(Semi-NCA)
+ * 
+ * 从 d 出发只进入层数大于 d 的可达节点：从子树走到子树外的第一个节点
+ * 不被 d 支配，它的层数不超过 d，所以遍历不会离开子树；
+ * 进入子树的其他路径都经过 d，子树外的前驱可以忽略。
+ */
+void Dominators::rebuild_subtree(BasicBlock *d) {
+    unsigned level = dom_tree_level_[d];
+    run_dfs(d, [&](BasicBlock *bb) {
+        return is_reachable(bb) and dom_tree_level_.at(bb) > level;
+    });
+    semi_nca();
+    for (auto bb : pre_order_vec_)
+        dom_tree_succ_blocks_[bb].clear();
+    for (unsigned w = 2; w <= pre_order_vec_.size(); w++) {
+        auto bb = pre_order_vec_[w - 1];
+        auto idom = pre_order_vec_[semi_idom_[w] - 1];
+        set_idom(bb, idom);
+        add_dom_tree_succ_block(idom, bb);
+        dom_tree_level_[bb] = dom_tree_level_[idom] + 1;
+    }
+    clear_dfs();
+}
+
+/**
+ *!@brief 新建的基本块 bb 插入到其唯一后继之前后更新支配树
+ * 
+ * bb 以跳转到后继 succ 结尾，succ 的部分入边已改为进入 bb，
+ * 例如为循环插入 preheader。bb 的直接支配者是其可达前驱的最近公共祖先；
+ * 除 bb 外只有 succ 的直接支配者可能变化：succ 不是入口块，
+ * 且其他可达前驱都被 succ 支配时，succ 的直接支配者变为 bb。
+ */
+void Dominators::insert_block(BasicBlock *bb) {
+    assert(bb->get_succ_basic_blocks().size() == 1 &&
+           "the new block should jump to a single successor");
+    dom_order_valid_ = false;
+    frontier_valid_ = false;
+    auto succ = bb->get_succ_basic_blocks().front();
+    BasicBlock *idom = nullptr;
+    for (auto pred : bb->get_pre_basic_blocks()) {
+        if (is_reachable(pred))
+            idom = idom == nullptr ? pred : nca(idom, pred);
+    }
+    if (idom == nullptr)
+        return;
+    if (not is_reachable(succ)) {
+        // succ 与 bb 一起变为可达，按加入 idom->bb 处理
+        insert_unreachable_edge(idom, bb);
+        return;
+    }
+    reparent(bb, idom);
+    dom_tree_level_[bb] = dom_tree_level_[idom] + 1;
+    // 入口块可以有来自循环的前驱，但总是支配所有基本块
+    if (succ == get_idom(succ))
+        return;
+    for (auto pred : succ->get_pre_basic_blocks()) {
+        if (pred != bb and is_reachable(pred) and not dominates(succ, pred))
+            return;
+    }
+    reparent(succ, bb);
+    update_levels(succ);
+}
+
+/**
+ *!@brief 删除不可达的基本块 bb 之前，清除它的各项结果
+ * 
+ * 从不可达的基本块出发的边不影响可达部分的支配关系，
+ * bb 的出边随它一起删除即可。
+ */
+void Dominators::remove_block(BasicBlock *bb) {
+    assert(not is_reachable(bb) && "remove the edges into the block first");
+    frontier_valid_ = false;
+    dom_tree_succ_blocks_[bb].clear();
+}
+
+/**
+ *!@brief 不依赖DFS序判断 bb1 是否支配可达的 bb2
+ */
+bool Dominators::dominates(BasicBlock *bb1, BasicBlock *bb2) {
+    while (dom_tree_level_.at(bb2) > dom_tree_level_.at(bb1))
+        bb2 = get_idom(bb2);
+    return bb1 == bb2;
+}
+
 /**
  *!@brief 打印函数的直接支配关系
  * @param f 要打印的函数
@@ -248,7 +637,7 @@ void Dominators::create_dom_dfs_order(Function *f) {
 void Dominators::print_idom(Function *f) {
     f->get_parent()->set_print_name();
     int counter = 0;
-    std::map<BasicBlock *, std::string> bb_id;
+    DenseBlockMap<std::string> bb_id(f->get_num_block_indices());
     for (auto &bb1 : f->get_basic_blocks()) {
         auto bb = &bb1;
         if (bb->get_name().empty())
@@ -283,7 +672,7 @@ void Dominators::print_idom(Function *f) {
 void Dominators::print_dominance_frontier(Function *f) {
     f->get_parent()->set_print_name();
     int counter = 0;
-    std::map<BasicBlock *, std::string> bb_id;
+    DenseBlockMap<std::string> bb_id(f->get_num_block_indices());
     for (auto &bb1 : f->get_basic_blocks()) {
         auto bb = &bb1;
         if (bb->get_name().empty())
@@ -376,8 +765,8 @@ void Dominators::dump_dominator_tree(Function *f)
     bool has_edges = false; // 用于检查是否有边存在
 
     for (auto &b : f->get_basic_blocks()) {
-        if (idom_.find(&b) != idom_.end() && idom_[&b] != &b) {
-            edge_set.push_back('\t' + idom_[&b]->get_name() + "->" + b.get_name() + ";\n");
+        if (get_idom(&b) != nullptr && get_idom(&b) != &b) {
+            edge_set.push_back('\t' + get_idom(&b)->get_name() + "->" + b.get_name() + ";\n");
             has_edges = true; // 如果存在支配边，标记为 true
         }
     }
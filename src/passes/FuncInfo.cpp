@@ -1,110 +1,215 @@
 #include "FuncInfo.hpp"
+#include "AliasAnalysis.hpp"
+#include "CallGraph.hpp"
+#include "Constant.hpp"
 #include "Function.hpp"
+#include "Instruction.hpp"
 
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+
+bool FuncInfo::Summary::operator==(const Summary &other) const {
+    return args == other.args and escaped_args == other.escaped_args and
+           read_globals == other.read_globals and
+           written_globals == other.written_globals and
+           reads_unknown == other.reads_unknown and
+           writes_unknown == other.writes_unknown and
+           calls_io == other.calls_io and may_trap == other.may_trap;
+}
+
+/**
+ *!@brief 自底向上计算所有函数的摘要
+ *
+ * 按调用图的强连通分量扫描一遍，被调函数的摘要总在调用者之前算好。
+ * 分量内有递归时反复计算直到摘要不再变化，否则计算一次即可。
+ */
 void FuncInfo::run() {
-    for (auto &f : m_->get_functions()) {
-        auto func = &f;
-        trivial_mark(func);
-        if (not is_pure[func])
-            worklist.push_back(func);
-    }
-    while (worklist.empty() == false) {
-        auto now = worklist.front();
-        worklist.pop_front();
-        process(now);
+    auto call_graph = am_->get_result<CallGraph>();
+    for (auto &scc : call_graph->get_sccs()) {
+        for (auto func : scc) {
+            if (func->is_declaration()) {
+                summarize_declaration(func);
+                continue;
+            }
+            auto &summary = summaries[func];
+            summary.args.assign(func->get_num_of_args(), NoModRef);
+            summary.escaped_args.assign(func->get_num_of_args(), false);
+        }
+        bool recursive = call_graph->is_recursive(scc.front());
+        bool changed;
+        do {
+            changed = false;
+            for (auto func : scc) {
+                if (func->is_declaration())
+                    continue;
+                auto summary = summarize(func);
+                if (summary != summaries[func]) {
+                    summaries[func] = std::move(summary);
+                    changed = true;
+                }
+            }
+        } while (changed and recursive);
+        // 递归可能不终止
+        if (recursive) {
+            for (auto func : scc)
+                summaries[func].may_trap = true;
+        }
     }
     log();
 }
 
 void FuncInfo::log() {
-    for (auto it : is_pure) {
-        LOG_INFO << it.first->get_name() << " is pure? " << it.second;
+    for (auto &[func, summary] : summaries) {
+        LOG_INFO << func->get_name() << " is pure? " << is_pure_function(func)
+                 << ", has side effect? " << has_side_effect(func);
     }
 }
 
-// 有 store 操作的函数非纯函数来处理
-void FuncInfo::trivial_mark(Function *func) {
-    if (func->is_declaration() or func->get_name() == "main") {
-        is_pure[func] = false;
+bool FuncInfo::is_pure_function(Function *func) const {
+    auto &summary = summaries.at(func);
+    return not summary.calls_io and not summary.reads_unknown and
+           not summary.writes_unknown and summary.read_globals.empty() and
+           summary.written_globals.empty() and
+           std::all_of(summary.args.begin(), summary.args.end(),
+                       [](unsigned mod_ref) { return mod_ref == NoModRef; });
+}
+
+bool FuncInfo::has_side_effect(Function *func) const {
+    auto &summary = summaries.at(func);
+    return summary.calls_io or summary.writes_unknown or
+           not summary.written_globals.empty() or
+           std::any_of(summary.args.begin(), summary.args.end(),
+                       [](unsigned mod_ref) { return mod_ref & Mod; });
+}
+
+// 运行时库中的函数只做输入输出，不访问程序的内存；
+// 其余外部函数可能访问任何内存
+void FuncInfo::summarize_declaration(Function *func) {
+    static const std::set<std::string> runtime = {"input", "output",
+                                                  "outputFloat",
+                                                  "neg_idx_except"};
+    auto &summary = summaries[func];
+    auto num_args = func->get_num_of_args();
+    summary.calls_io = true;
+    // neg_idx_except 不返回，其余外部函数未知
+    summary.may_trap = func->get_name() != "input" and
+                       func->get_name() != "output" and
+                       func->get_name() != "outputFloat";
+    if (runtime.count(func->get_name())) {
+        summary.args.assign(num_args, NoModRef);
+        summary.escaped_args.assign(num_args, false);
         return;
     }
-    // 只要传入数组，都作为非纯函数处理
-    for (auto it = func->get_function_type()->param_begin();
-         it != func->get_function_type()->param_end(); ++it) {
-        auto arg_type = *it;
-        if (arg_type->is_integer_type() == false and
-            arg_type->is_float_type() == false) {
-            is_pure[func] = false;
-            return;
+    summary.args.assign(num_args, ModRef);
+    summary.escaped_args.assign(num_args, true);
+    summary.reads_unknown = summary.writes_unknown = true;
+}
+
+// CFG 中从入口可达的环，即函数含循环
+static bool has_cycle(Function *func) {
+    // 0: 未访问，1: 在 DFS 栈上，2: 已完成
+    std::unordered_map<BasicBlock *, int> state;
+    std::vector<std::pair<BasicBlock *, size_t>> stack;
+    auto entry = func->get_entry_block();
+    state[entry] = 1;
+    stack.emplace_back(entry, 0);
+    while (not stack.empty()) {
+        auto &[bb, next] = stack.back();
+        auto &succs = bb->get_succ_basic_blocks();
+        if (next == succs.size()) {
+            state[bb] = 2;
+            stack.pop_back();
+            continue;
         }
-    }
-    for (auto &bb : func->get_basic_blocks())
-        for (auto &inst : bb.get_instructions()) {
-            if (is_side_effect_inst(&inst)) {
-                is_pure[func] = false;
-                return;
-            }
+        auto succ = succs[next++];
+        if (state[succ] == 1)
+            return true;
+        if (state[succ] == 0) {
+            state[succ] = 1;
+            stack.emplace_back(succ, 0);
         }
-    is_pure[func] = true;
+    }
+    return false;
 }
 
-void FuncInfo::process(Function *func) {
-    for (auto &use : func->get_use_list()) {
-        LOG_INFO << use.val_->print() << " uses func: " << func->get_name();
-        if (auto inst = dynamic_cast<Instruction *>(use.val_)) {
-            auto func = (inst->get_parent()->get_parent());
-            if (is_pure[func]) {
-                is_pure[func] = false;
-                worklist.push_back(func);
+/**
+ *!@brief 根据函数体和被调函数当前的摘要计算函数的摘要
+ * @param func 要计算的函数
+ *
+ * 对局部变量（alloca）的访问不计入摘要；指针写入局部变量以外的内存时
+ * 其指向的形参逃逸。
+ */
+FuncInfo::Summary FuncInfo::summarize(Function *func) {
+    Summary summary;
+    summary.args.assign(func->get_num_of_args(), NoModRef);
+    summary.escaped_args.assign(func->get_num_of_args(), false);
+    summary.may_trap = has_cycle(func);
+    for (auto &bb : func->get_basic_blocks()) {
+        for (auto &inst : bb.get_instructions()) {
+            if (inst.is_div()) {
+                auto divisor = dyn_cast<ConstantInt>(inst.get_operand(1));
+                if (not divisor or divisor->get_value() == 0)
+                    summary.may_trap = true;
             }
-        } else
-            LOG_WARNING << "Value besides instruction uses a function";
+            if (auto load = dyn_cast<LoadInst>(&inst)) {
+                add_access(summary, load->get_lval(), Ref);
+            } else if (auto store = dyn_cast<StoreInst>(&inst)) {
+                add_access(summary, store->get_lval(), Mod);
+                if (not store->get_rval()->get_type()->is_pointer_type())
+                    continue;
+                auto lval = AliasAnalysis::get_underlying_object(
+                    store->get_lval());
+                auto rval = AliasAnalysis::get_underlying_object(
+                    store->get_rval());
+                auto arg = dyn_cast<Argument>(rval);
+                if (arg and not dyn_cast<AllocaInst>(lval))
+                    summary.escaped_args[arg->get_arg_no()] = true;
+            } else if (auto call = dyn_cast<CallInst>(&inst)) {
+                add_call(summary, call);
+            }
+        }
     }
+    return summary;
 }
 
-// 对局部变量进行 store 没有副作用
-bool FuncInfo::is_side_effect_inst(Instruction *inst) {
-    if (inst->is_store()) {
-        if (is_local_store(dynamic_cast<StoreInst *>(inst)))
-            return false;
-        return true;
-    }
-    if (inst->is_load()) {
-        if (is_local_load(dynamic_cast<LoadInst *>(inst)))
-            return false;
-        return true;
+// 把对 ptr 所指对象的访问记入摘要
+void FuncInfo::add_access(Summary &summary, Value *ptr, unsigned mod_ref) {
+    auto object = AliasAnalysis::get_underlying_object(ptr);
+    if (dyn_cast<AllocaInst>(object))
+        return;
+    if (auto arg = dyn_cast<Argument>(object)) {
+        summary.args[arg->get_arg_no()] |= mod_ref;
+    } else if (auto global = dyn_cast<GlobalVariable>(object)) {
+        if (mod_ref & Ref)
+            summary.read_globals.insert(global);
+        if (mod_ref & Mod)
+            summary.written_globals.insert(global);
+    } else {
+        summary.reads_unknown |= (mod_ref & Ref) != 0;
+        summary.writes_unknown |= (mod_ref & Mod) != 0;
     }
-    // call 指令的副作用会在后续 bfs 中计算
-    return false;
-}
-
-bool FuncInfo::is_local_load(LoadInst *inst) {
-    auto addr =
-        dynamic_cast<Instruction *>(get_first_addr(inst->get_operand(0)));
-    if (addr and addr->is_alloca())
-        return true;
-    return false;
 }
 
-bool FuncInfo::is_local_store(StoreInst *inst) {
-    auto addr = dynamic_cast<Instruction *>(get_first_addr(inst->get_lval()));
-    if (addr and addr->is_alloca())
-        return true;
-    return false;
-}
-Value *FuncInfo::get_first_addr(Value *val) {
-    if (auto inst = dynamic_cast<Instruction *>(val)) {
-        if (inst->is_alloca())
-            return inst;
-        if (inst->is_gep())
-            return get_first_addr(inst->get_operand(0));
-        if (inst->is_load())
-            return val;
-        LOG_WARNING << "FuncInfo: try to determine addr in operands";
-        for (auto op : inst->get_operands()) {
-            if (op->get_type()->is_pointer_type())
-                return get_first_addr(op);
-        }
+// 把被调函数的摘要映射到调用点的实参上，并入调用者的摘要
+void FuncInfo::add_call(Summary &summary, CallInst *call) {
+    auto callee = dyn_cast<Function>(call->get_operand(0));
+    auto &callee_summary = summaries.at(callee);
+    summary.calls_io |= callee_summary.calls_io;
+    summary.may_trap |= callee_summary.may_trap;
+    summary.reads_unknown |= callee_summary.reads_unknown;
+    summary.writes_unknown |= callee_summary.writes_unknown;
+    summary.read_globals.insert(callee_summary.read_globals.begin(),
+                                callee_summary.read_globals.end());
+    summary.written_globals.insert(callee_summary.written_globals.begin(),
+                                   callee_summary.written_globals.end());
+    for (unsigned i = 0; i < callee_summary.args.size(); i++) {
+        auto actual = call->get_operand(i + 1);
+        if (callee_summary.args[i] != NoModRef)
+            add_access(summary, actual, callee_summary.args[i]);
+        auto arg = dyn_cast<Argument>(
+            AliasAnalysis::get_underlying_object(actual));
+        if (callee_summary.escaped_args[i] and arg)
+            summary.escaped_args[arg->get_arg_no()] = true;
     }
-    return val;
 }
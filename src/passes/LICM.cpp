@@ -10,22 +10,32 @@
 #include <vector>
 
 /**
- *!@brief 循环不变式外提Pass的主入口函数
+ *!@brief 循环不变式外提Pass的模块级准备：分析纯函数
  * 
  */
-void LoopInvariantCodeMotion::run() {
+void LoopInvariantCodeMotion::init() {
+    func_info_ = am_->get_result<FuncInfo>();
+}
 
-    loop_detection_ = std::make_unique<LoopDetection>(m_);
-    loop_detection_->run();
-    func_info_ = std::make_unique<FuncInfo>(m_);
-    func_info_->run();
-    for (auto &loop : loop_detection_->get_loops()) {
+/**
+ *!@brief 对单个函数检测循环并执行不变式外提
+ * @param f 要处理的函数
+ * 
+ */
+void LoopInvariantCodeMotion::run_on_func(Function *f) {
+    // 复制一份循环列表，缓存的 LoopDetection 会在下面失效
+    auto loops = am_->get_result<LoopDetection>(f)->get_loops();
+    for (auto &loop : loops) {
         is_loop_done_[loop] = false;
     }
 
-    for (auto &loop : loop_detection_->get_loops()) {
+    for (auto &loop : loops) {
         traverse_loop(loop);
     }
+    // 每个循环都会插入 preheader，CFG 发生变化；
+    // 支配树已随 preheader 的插入增量更新
+    if (not loops.empty())
+        am_->invalidate(f, PreservedAnalyses::none().preserve<Dominators>());
 }
 
 /**
@@ -44,50 +54,117 @@ void LoopInvariantCodeMotion::traverse_loop(std::shared_ptr<Loop> loop) {
     run_on_loop(loop);
 }
 
-// TODO: 实现collect_loop_info函数
-// 1. 遍历当前循环及其子循环的所有指令
-// 2. 收集所有指令到loop_instructions中
-// 3. 检查store指令是否修改了全局变量，如果是则添加到updated_global中
-// 4. 检查是否包含非纯函数调用，如果有则设置contains_impure_call为true
+static Function *callee(Instruction *call) {
+    return dyn_cast<Function>(call->get_operand(0));
+}
+
+/**
+ *!@brief 收集循环及其子循环中的指令和可能写内存的指令
+ * @param loop 当前循环
+ * @param loop_instructions 循环中的所有指令
+ * @param memory_writes 循环中的 store 与有副作用的函数调用
+ *
+ * 子循环的基本块包含在 loop->get_blocks() 中。
+ */
 void LoopInvariantCodeMotion::collect_loop_info(
-    std::shared_ptr<Loop> loop,
-    std::set<Value *> &loop_instructions,
-    std::set<Value *> &updated_global,
-    bool &contains_impure_call) {
-    
-    // throw std::runtime_error("Lab4: 你有一个TODO需要完成！");
-    // ? 1. 遍历当前循环及其子循环的所有指令 2. 收集所有指令到loop_instructions中
+    std::shared_ptr<Loop> loop, std::set<Value *> &loop_instructions,
+    std::vector<Instruction *> &memory_writes) {
     for (auto &bb : loop->get_blocks()) {
         for (auto &inst : bb->get_instructions()) {
             loop_instructions.insert(&inst);
-            // ? 3. 检查store指令是否修改了全局变量，如果是则添加到updated_global中
-            if (inst.is_store()) {
-                if (auto *glv = dynamic_cast<GlobalVariable *>(inst.get_operand(1))) {
-                    updated_global.insert(glv);
-                }
-            }
-            // ? 4. 检查是否包含非纯函数调用，如果有则设置contains_impure_call为true
-            if (inst.is_call()) { // ! how? done.
-                auto call = dynamic_cast<Function *>(dynamic_cast<CallInst *>(&inst)->get_operand(0));
-                Function *callee = nullptr;
-                if (auto *func = dynamic_cast<Function *>(inst.get_operand(0))) {
-                    callee = func;
-                }
-                // ! 我tm手动标记input为impure
-                if (callee->get_name() == "input"){
-                    contains_impure_call = true;
-                    continue;
-                }
-                if (!func_info_->is_pure_function(call)) {
-                    contains_impure_call = true;
-                    continue;
-                }
-            }
+            if (inst.is_store() or
+                (inst.is_call() and func_info_->has_side_effect(callee(&inst))))
+                memory_writes.push_back(&inst);
         }
     }
-    // for (auto &sub_loop : loop->get_sub_loops()) {
-    //     collect_loop_info(sub_loop, loop_instructions, updated_global, contains_impure_call);
-    // }
+}
+
+/**
+ *!@brief 判断 load 能否外提
+ * @param load 循环中地址不变的 load
+ * @param memory_writes 循环中可能写内存的指令
+ * @param alias_analysis 所在函数的别名分析
+ *
+ * 循环中没有指令可能写 load 读的内存，且地址一定落在 alloca 或
+ * 全局变量之内：load 可能位于下标检查之后，外提后即使循环不执行
+ * 或下标越界也不会读到对象之外。
+ */
+static bool is_invariant_load(LoadInst *load,
+                              const std::vector<Instruction *> &memory_writes,
+                              AliasAnalysis *alias_analysis) {
+    auto ptr = load->get_lval();
+    if (not alias_analysis->is_dereferenceable(ptr))
+        return false;
+    for (auto inst : memory_writes) {
+        if (alias_analysis->may_modify(inst, ptr))
+            return false;
+    }
+    return true;
+}
+
+/**
+ *!@brief 判断进入循环后，离开循环前是否一定执行 bb
+ * @param bb 循环中的基本块
+ * @param loop 所在循环
+ * @param dominators 所在函数的支配树
+ *
+ * bb 支配循环中所有有循环外后继的基本块。没有出口的循环可能
+ * 一直在不经过 bb 的环上执行，不算在内。
+ */
+static bool is_executed_on_entry(BasicBlock *bb, std::shared_ptr<Loop> loop,
+                                 Dominators *dominators) {
+    auto &blocks = loop->get_blocks();
+    std::set<BasicBlock *> in_loop(blocks.begin(), blocks.end());
+    bool has_exit = false;
+    for (auto block : blocks) {
+        for (auto succ : block->get_succ_basic_blocks()) {
+            if (in_loop.count(succ))
+                continue;
+            if (not dominators->is_dominate(bb, block))
+                return false;
+            has_exit = true;
+        }
+    }
+    return has_exit;
+}
+
+/**
+ *!@brief 判断调用能否外提
+ * @param call 循环中参数不变的调用
+ * @param memory_writes 循环中可能写内存的指令
+ * @param func_info 函数摘要
+ * @param alias_analysis 所在函数的别名分析
+ * @param executed 进入循环后是否一定执行 call（见 is_executed_on_entry）
+ *
+ * 被调函数没有副作用，且循环中没有指令可能写它读的内存：
+ * 它读的全局变量，以及它读的形参对应的实参所指的对象。
+ * 可能陷入或不返回的函数（may_trap）只在循环中一定被调用时外提，
+ * 否则循环不执行时外提的调用会陷入。
+ */
+static bool is_invariant_call(CallInst *call,
+                              const std::vector<Instruction *> &memory_writes,
+                              FuncInfo *func_info,
+                              AliasAnalysis *alias_analysis, bool executed) {
+    if (func_info->has_side_effect(callee(call)))
+        return false;
+    auto &summary = func_info->get_summary(callee(call));
+    if (summary.may_trap and not executed)
+        return false;
+    if (summary.reads_unknown)
+        return memory_writes.empty();
+    std::vector<Value *> read_objects(summary.read_globals.begin(),
+                                      summary.read_globals.end());
+    for (unsigned i = 0; i < summary.args.size(); i++) {
+        if (summary.args[i] & FuncInfo::Ref)
+            read_objects.push_back(call->get_operand(i + 1));
+    }
+    for (auto inst : memory_writes) {
+        for (auto object : read_objects) {
+            if (alias_analysis->may_modify_object(inst, object))
+                return false;
+        }
+    }
+    return true;
 }
 
 /**
@@ -97,77 +174,60 @@ void LoopInvariantCodeMotion::collect_loop_info(
  */
 void LoopInvariantCodeMotion::run_on_loop(std::shared_ptr<Loop> loop) {
     std::set<Value *> loop_instructions;
-    std::set<Value *> updated_global;
-    bool contains_impure_call = false;
-    collect_loop_info(loop, loop_instructions, updated_global, contains_impure_call);
+    std::vector<Instruction *> memory_writes;
+    collect_loop_info(loop, loop_instructions, memory_writes);
+    auto func = loop->get_header()->get_parent();
+    auto alias_analysis = am_->get_result<AliasAnalysis>(func);
+    auto dominators = am_->get_result<Dominators>(func);
 
+    // 按发现的顺序排列，外提时操作数先于使用者
     std::vector<Value *> loop_invariant;
+    std::set<Value *> is_invariant;
 
-
-    // TODO: 识别循环不变式指令
-    //
-    // - 如果指令已被标记为不变式则跳过
-    // - 跳过 store、ret、br、phi 等指令与非纯函数调用
-    // - 特殊处理全局变量的 load 指令
-    // - 检查指令的所有操作数是否都是循环不变的
-    // - 如果有新的不变式被添加则注意更新 changed 标志，继续迭代
-
+    // 识别循环不变式指令：
+    // - 跳过 store、ret、br、phi
+    // - 调用需要被调函数没有副作用且读的内存不变，可能陷入的被调函数
+    //   还需要在循环中一定被调用（见 is_invariant_call）
+    // - 除数不是非零常数的 sdiv 可能陷入，不提前执行
+    // - load 需要循环中没有可能写同一内存的指令（见 is_invariant_load）
+    // - 所有操作数都在循环外定值，或已是循环不变式
+    // - 有新的不变式加入时继续迭代
     bool changed;
     do {
         changed = false;
-
-        // throw std::runtime_error("Lab4: 你有一个TODO需要完成！");
-        for (auto *inst : loop_instructions){
-            // ? - 如果指令已被标记为不变式则跳过
-            if (std::find(loop_invariant.begin(), loop_invariant.end(), inst) 
-                != loop_invariant.end()) {
+        for (auto *inst : loop_instructions) {
+            if (is_invariant.count(inst))
                 continue;
-            }
-            auto *inst_ = dynamic_cast<Instruction *>(inst);
-            if (!inst_) {
+            auto *inst_ = dyn_cast<Instruction>(inst);
+            if (inst_->is_store() or inst_->is_ret() or inst_->is_br() or
+                inst_->is_phi())
                 continue;
-            }
-            // ? - 跳过 store、ret、br、phi 等指令与非纯函数调用
-            // ! - "等"字 暗藏玄机
-            if (inst_->is_store() || 
-                inst_->is_ret() || 
-                inst_->is_br() || 
-                inst_->is_phi() || 
-                contains_impure_call) {
+            if (auto call = dyn_cast<CallInst>(inst_);
+                call and not is_invariant_call(
+                             call, memory_writes, func_info_, alias_analysis,
+                             is_executed_on_entry(call->get_parent(), loop,
+                                                  dominators)))
                 continue;
-                // Function *callee = nullptr;
-                // if (auto *func = dynamic_cast<Function *>(inst_->get_operand(0))) {
-                //     callee = func;
-                // }
-                // // ! 我tm手动标记input为impure
-                // if (callee && callee->get_name() == "input"){
-                //     contains_impure_call = true;
-                //     continue;
-                // }
-                // if (!callee || !func_info_->is_pure_function(callee)) {
-                //     contains_impure_call = true;
-                //     continue;
-                // }
-            }
-            // ? - 特殊处理全局变量的 load 指令
-            // ! difference
-            if (inst_->is_load()) {
-                // ? count方法：如果容器中存在元素，则返回1，否则返回0（本质是返回元素的个数）
-                if (dynamic_cast<GlobalVariable *>(dynamic_cast<LoadInst *>(inst)->get_lval())) {
-                    updated_global.insert(dynamic_cast<LoadInst *>(inst)->get_lval());
-                }
+            if (inst_->is_div()) {
+                auto divisor = dyn_cast<ConstantInt>(inst_->get_operand(1));
+                if (not divisor or divisor->get_value() == 0)
+                    continue;
             }
-            // ? - 检查指令的所有操作数是否都是循环不变的
+            if (auto load = dyn_cast<LoadInst>(inst_);
+                load and
+                not is_invariant_load(load, memory_writes, alias_analysis))
+                continue;
             bool all_invariant = true;
-            for (size_t i = 0; i < inst_->get_num_operand(); i++) {
-                auto *op = inst_->get_operand(i);
-                if (loop_instructions.find(op) != loop_instructions.end()) {
+            for (auto *op : inst_->get_operands()) {
+                if (loop_instructions.count(op) and
+                    not is_invariant.count(op)) {
                     all_invariant = false;
                     break;
                 }
             }
             if (all_invariant) {
                 loop_invariant.push_back(inst);
+                is_invariant.insert(inst);
                 changed = true;
             }
         }
@@ -191,7 +251,7 @@ void LoopInvariantCodeMotion::run_on_loop(std::shared_ptr<Loop> loop) {
         
         // throw std::runtime_error("Lab4: 你有一个TODO需要完成！");
         for (size_t i = 0; i < phi_inst_.get_num_operand(); i += 2) {
-            auto *incoming_bb = dynamic_cast<BasicBlock *>(phi_inst_.get_operand(i + 1));
+            auto *incoming_bb = dyn_cast<BasicBlock>(phi_inst_.get_operand(i + 1));
             if (!incoming_bb || loop->get_latches().find(incoming_bb) != loop->get_latches().end()){
                 continue;
             }
@@ -204,36 +264,25 @@ void LoopInvariantCodeMotion::run_on_loop(std::shared_ptr<Loop> loop) {
     // TODO: 用跳转指令重构控制流图 
     // 将所有非 latch 的 header 前驱块的跳转指向 preheader
     // 并将 preheader 的跳转指向 header
-    // 注意这里需要更新前驱块的后继和后继的前驱
-    std::vector<BasicBlock *> pred_to_remove;
-    for (auto &pred : loop->get_header()->get_pre_basic_blocks()) {
-        // throw std::runtime_error("Lab4: 你有一个TODO需要完成！");
-        // ? 将所有非 latch 的 header 前驱块的跳转指向 preheader
-        auto latches = loop->get_latches();
-        if (latches.find(pred) == latches.end()) {
-            pred->remove_succ_basic_block(loop->get_header());
-            pred->add_succ_basic_block(preheader);
-            preheader->add_pre_basic_block(pred);
-            pred_to_remove.push_back(pred);
-        }
-        preheader->add_succ_basic_block(loop->get_header());
-        for (auto &pre : preheader->get_pre_basic_blocks()) {
-            for (auto &inst : pre->get_instructions()) {
-                if (inst.is_br()) {
-                    inst.set_operand(0, static_cast<Value *>(preheader));
-                }
-            }
+    // 前驱块的后继和后继的前驱随跳转目标自动更新, 这里只需改写跳转指令
+    auto header = loop->get_header();
+    auto latches = loop->get_latches();
+    std::vector<BasicBlock *> preds(header->get_pre_basic_blocks().begin(),
+                                    header->get_pre_basic_blocks().end());
+    for (auto pred : preds) {
+        if (latches.find(pred) != latches.end())
+            continue;
+        auto br = pred->get_terminator();
+        for (unsigned i = 0; i < br->get_num_operand(); i++) {
+            if (br->get_operand(i) == header)
+                br->set_operand(i, preheader);
         }
     }
 
-    // for (auto &pred : pred_to_remove) {
-    //     loop->get_header()->remove_pre_basic_block(pred);
-    // }
-
     // TODO: 外提循环不变指令
     // throw std::runtime_error("Lab4: 你有一个TODO需要完成！");
     for (auto *inst : loop_invariant) {
-        auto *inst_ = dynamic_cast<Instruction *>(inst);
+        auto *inst_ = dyn_cast<Instruction>(inst);
         if (inst_){
             inst_->get_parent()->remove_instr(inst_);
             preheader->add_instruction(inst_);
@@ -241,6 +290,9 @@ void LoopInvariantCodeMotion::run_on_loop(std::shared_ptr<Loop> loop) {
     }
     // insert preheader br to header
     BranchInst::create_br(loop->get_header(), preheader);
+    if (auto dominators = am_->get_cached_result<Dominators>(
+            preheader->get_parent()))
+        dominators->insert_block(preheader);
 
     // insert preheader to parent loop
     if (loop->get_parent() != nullptr) {
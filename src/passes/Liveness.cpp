@@ -0,0 +1,64 @@
+#include "Liveness.hpp"
+#include "DataFlow.hpp"
+#include "Function.hpp"
+
+/**
+ *!@brief 对单个函数执行活跃变量分析
+ * @param f 要分析的函数
+ *
+ * 1. 为跨基本块使用的指令编号
+ * 2. 基本块的 gen 为向上暴露的使用，kill 为其中定值的指令；
+ *    后继中的 phi 对从该基本块流入的值的使用放入 edge_gen
+ * 3. 求解后向数据流方程
+ */
+void Liveness::run_on_func(Function *f) {
+    values_.clear();
+    bits_.reset(f->get_num_inst_indices());
+    // 编号只在函数内有意义，常量、参数和其他函数的值不参与分析
+    auto local_def = [f](Value *val) -> Instruction * {
+        auto inst = dyn_cast<Instruction>(val);
+        return inst and inst->get_function() == f ? inst : nullptr;
+    };
+    for (auto &bb : f->get_basic_blocks()) {
+        for (auto &inst : bb.get_instructions()) {
+            for (auto op : inst.get_operands()) {
+                auto def = local_def(op);
+                if (def == nullptr or bits_[def] != 0)
+                    continue;
+                if (inst.is_phi() or def->get_parent() != &bb) {
+                    values_.push_back(def);
+                    bits_[def] = values_.size();
+                }
+            }
+        }
+    }
+
+    BitVectorDataFlow<DataFlowDirection::Backward, DataFlowMeet::Union> solver(
+        f, values_.size());
+    for (auto &bb : f->get_basic_blocks()) {
+        auto &gen = solver.gen(&bb);
+        auto &kill = solver.kill(&bb);
+        for (auto &inst : bb.get_instructions()) {
+            if (inst.is_phi()) {
+                // 操作数依次为 (值, 前驱) 对
+                for (unsigned i = 0; i + 1 < inst.get_num_operand(); i += 2) {
+                    auto def = local_def(inst.get_operand(i));
+                    auto pred = dyn_cast<BasicBlock>(inst.get_operand(i + 1));
+                    if (def)
+                        solver.edge_gen(pred).set(bits_[def] - 1);
+                }
+            } else {
+                for (auto op : inst.get_operands()) {
+                    auto def = local_def(op);
+                    if (def and def->get_parent() != &bb)
+                        gen.set(bits_[def] - 1);
+                }
+            }
+            if (bits_[&inst] != 0)
+                kill.set(bits_[&inst] - 1);
+        }
+    }
+    solver.solve();
+    live_in_ = std::move(solver.get_in());
+    live_out_ = std::move(solver.get_out());
+}
@@ -3,24 +3,13 @@
 #include <memory>
 
 /**
- * @brief 循环检测Pass的主入口函数
- *
- * 该函数执行以下步骤：
- * 1. 创建支配树分析实例
- * 2. 遍历模块中的所有函数
- * 3. 对每个非声明函数执行循环检测
- * 4. 最后打印检测结果
+ * @brief 合并并行执行时工作线程副本检测到的循环
+ * @param worker 工作线程使用的副本
  */
-void LoopDetection::run() {
-    dominators_ = std::make_unique<Dominators>(m_);
-    for (auto &f1 : m_->get_functions()) {
-        auto f = &f1;
-        if (f->is_declaration())
-            continue;
-        func_ = f;
-        run_on_func(f);
-    }
-    print();
+void LoopDetection::merge(FunctionPass *worker) {
+    auto other = static_cast<LoopDetection *>(worker);
+    loops_.insert(loops_.end(), other->loops_.begin(), other->loops_.end());
+    bb_to_loop_.insert(other->bb_to_loop_.begin(), other->bb_to_loop_.end());
 }
 
 /**
@@ -101,7 +90,7 @@ void LoopDetection::discover_loop_and_sub_loops(BasicBlock *bb, BBset &latches,
  * @param f 要分析的函数
  *
  * 该函数通过以下步骤检测循环：
- * 1. 运行支配树分析
+ * 1. 获取该函数的支配树分析结果
  * 2. 按支配树后序遍历所有基本块
  * 3. 对每个块，检查其前驱是否存在回边
  * 4. 如果存在回边，创建新的循环并：
@@ -110,12 +99,13 @@ void LoopDetection::discover_loop_and_sub_loops(BasicBlock *bb, BBset &latches,
  *    - 发现循环体和子循环
  */
 void LoopDetection::run_on_func(Function *f) {
-    dominators_->run_on_func(f);
-    for (auto &bb1 : dominators_->get_dom_post_order()) {
+    func_ = f;
+    auto dominators = am_->get_result<Dominators>(f);
+    for (auto &bb1 : dominators->get_dom_post_order()) {
         auto bb = bb1;
         BBset latches;
         for (auto &pred : bb->get_pre_basic_blocks()) {
-            if (dominators_->is_dominate(bb, pred)) {
+            if (dominators->is_dominate(bb, pred)) {
                 // pred is a back edge
                 // pred -> bb , pred is the latch node
                 latches.insert(pred);
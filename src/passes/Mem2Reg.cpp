@@ -6,40 +6,31 @@
 #include "logging.hpp"
 
 /**
- *!@brief Mem2Reg Pass的主入口函数
+ *!@brief Mem2Reg Pass 对单个函数的处理
+ * @param f 要处理的函数
  * 
  * 该函数执行内存到寄存器的提升过程，将栈上的局部变量提升到SSA格式。
  * 主要步骤：
- * 1. 创建并运行支配树分析
- * 2. 对每个非声明函数：
- *    - 清空相关数据结构
- *    - 插入必要的phi指令
- *    - 执行变量重命名
+ * 1. 获取该函数的支配树
+ * 2. 清空相关数据结构
+ * 3. 插入必要的phi指令
+ * 4. 执行变量重命名
  * 
  * 注意：函数执行后，冗余的局部变量分配指令将由后续的死代码删除Pass处理
  */
-void Mem2Reg::run() {
-    // printf("This is Mem2reg run\n");
-    // 创建支配树分析 Pass 的实例
-    dominators_ = std::make_unique<Dominators>(m_);
-    // 建立支配树
-    dominators_->run();
-    // 以函数为单元遍历实现 Mem2Reg 算法
-    for (auto &f : m_->get_functions()) {
-        if (f.is_declaration())
-            continue;
-        func_ = &f;
-        var_val_stack.clear();
-        phi_lval.clear();
-        if (func_->get_basic_blocks().size() >= 1) {
-            // 对应伪代码中 phi 指令插入的阶段
-            generate_phi();
-            // 对应伪代码中重命名阶段
-            rename(func_->get_entry_block());
-            // printf("Done! mem2reg run\n");
-        }
-        // 后续 DeadCode 将移除冗余的局部变量的分配空间
+void Mem2Reg::run_on_func(Function *f) {
+    func_ = f;
+    // 获取支配树，结果可能已由之前的 pass 计算并缓存
+    dominators_ = am_->get_result<Dominators>(func_);
+    var_val_stack.reset(func_->get_num_inst_indices());
+    phi_lval.reset(func_->get_num_inst_indices());
+    if (func_->get_basic_blocks().size() >= 1) {
+        // 对应伪代码中 phi 指令插入的阶段
+        generate_phi();
+        // 对应伪代码中重命名阶段
+        rename(func_->get_entry_block());
     }
+    // 后续 DeadCode 将移除冗余的局部变量的分配空间
 }
 
 /**
@@ -59,49 +50,50 @@ void Mem2Reg::run() {
  */
 void Mem2Reg::generate_phi() {
     // printf("This is generate_phi\n");
-    // global_live_var_name 是全局名字集合，以 alloca 出的局部变量来统计。
+    // global_live_var_name 是全局名字集合，以 alloca 出的局部变量来统计，
+    // 按第一次被 store 的顺序排列。
     // ? 步骤一：找到活跃在多个 block 的全局名字集合，以及它们所属的 bb 块
-    std::set<Value *> global_live_var_name;
-    std::map<Value *, std::set<BasicBlock *>> live_var_2blocks;
+    std::vector<AllocaInst *> global_live_var_name;
+    DenseInstMap<std::vector<BasicBlock *>> live_var_2blocks(
+        func_->get_num_inst_indices());
     for (auto &bb : func_->get_basic_blocks()) {
-        std::set<Value *> var_is_killed;
         for (auto &instr : bb.get_instructions()) {
             if (instr.is_store()) {
                 // store i32 a, i32 *b
                 // a is r_val, b is l_val
                 auto l_val = static_cast<StoreInst *>(&instr)->get_lval();
                 if (is_valid_ptr(l_val)) {
-                    global_live_var_name.insert(l_val);
-                    live_var_2blocks[l_val].insert(&bb);
+                    auto var = l_val->as<AllocaInst>();
+                    auto &blocks = live_var_2blocks[var];
+                    if (blocks.empty())
+                        global_live_var_name.push_back(var);
+                    if (blocks.empty() or blocks.back() != &bb)
+                        blocks.push_back(&bb);
                 }
             }
         }
     }
 
     // ? 步骤二：从支配树获取支配边界信息，并在对应位置插入 phi 指令
-    std::map<std::pair<BasicBlock *, Value *>, bool>
-        bb_has_var_phi; // bb has phi for var
+    // 变量逐个处理，bb 中已有当前变量的 phi 当且仅当 phi_var[bb] == var
+    DenseBlockMap<AllocaInst *> phi_var(func_->get_num_block_indices());
     for (auto var : global_live_var_name) {
-        std::vector<BasicBlock *> work_list;
-        work_list.assign(live_var_2blocks[var].begin(),
-                         live_var_2blocks[var].end());
+        std::vector<BasicBlock *> work_list = live_var_2blocks[var];
         for (unsigned i = 0; i < work_list.size(); i++) {
             auto bb = work_list[i];
             for (auto bb_dominance_frontier_bb :
                  dominators_->get_dominance_frontier(bb)) {
-                if (bb_has_var_phi.find({bb_dominance_frontier_bb, var}) ==
-                    bb_has_var_phi.end()) {
+                if (phi_var[bb_dominance_frontier_bb] != var) {
                     // generate phi for bb_dominance_frontier_bb & add
                     // bb_dominance_frontier_bb to work list
-                    // printf("ready to create phi\n");
                     auto phi = PhiInst::create_phi(
                         var->get_type()->get_pointer_element_type(),
                         bb_dominance_frontier_bb);
-                    phi_lval.emplace(phi, var);
+                    // phi 插入基本块后才有编号
                     bb_dominance_frontier_bb->add_instr_begin(phi);
+                    phi_lval[phi] = var;
                     work_list.push_back(bb_dominance_frontier_bb);
-                    bb_has_var_phi[{bb_dominance_frontier_bb, var}] = true;
-                    // LOG(DEBUG) << phi->print();
+                    phi_var[bb_dominance_frontier_bb] = var;
                 }
             }
         }
@@ -114,10 +106,12 @@ void Mem2Reg::rename(BasicBlock *bb) {
     // TODO
     // throw "Unimplemented rename";
     // ? 步骤一：将 phi 指令作为 lval 的最新定值，lval 即是为局部变量 alloca 出的地址空间
-    std::vector<Value *> vars_to_pop;
+    std::vector<AllocaInst *> vars_to_pop;
     for (auto &instr : bb->get_instructions()){
-        if (auto *phi = dynamic_cast<PhiInst *>(&instr)){
+        if (auto *phi = dyn_cast<PhiInst>(&instr)){
             auto lval = phi_lval[phi];
+            if (lval == nullptr)
+                continue; // 不是本 pass 插入的 phi
             var_val_stack[lval].push_back(phi);
             vars_to_pop.push_back(lval);
         } else {
@@ -131,19 +125,21 @@ void Mem2Reg::rename(BasicBlock *bb) {
         if (instr.is_phi()){
             continue;
         }
-        if (auto *load = dynamic_cast<LoadInst *>(&instr)){
+        if (auto *load = dyn_cast<LoadInst>(&instr)){
             auto lval = load->get_lval();
-            if (is_valid_ptr(lval) && var_val_stack.count(lval) && !var_val_stack[lval].empty()){
-                auto new_val = var_val_stack[lval].back();
-                load->replace_all_use_with(new_val);
-                wait_delete.push_back(load);
+            if (is_valid_ptr(lval)){
+                auto &val_stack = var_val_stack[lval->as<AllocaInst>()];
+                if (!val_stack.empty()){
+                    load->replace_all_use_with(val_stack.back());
+                    wait_delete.push_back(load);
+                }
             }
         }
     // ! 步骤三：将 store 指令的 rval，也即被存入内存的值，作为 lval 的最新定值
-        else if (auto *store = dynamic_cast<StoreInst *>(&instr)){
+        else if (auto *store = dyn_cast<StoreInst>(&instr)){
             auto rval = store->get_rval();
-            auto lval = store->get_lval();
-            if (is_valid_ptr(lval)){
+            if (is_valid_ptr(store->get_lval())){
+                auto lval = store->get_lval()->as<AllocaInst>();
                 var_val_stack[lval].push_back(rval);
                 vars_to_pop.push_back(lval);
                 wait_delete.push_back(store);
@@ -155,9 +151,9 @@ void Mem2Reg::rename(BasicBlock *bb) {
     // ? 步骤四：为 lval 对应的 phi 指令参数补充完整
     for (auto succ_bb : bb->get_succ_basic_blocks()){
         for (auto &instr : succ_bb->get_instructions()){
-            if (auto *phi = dynamic_cast<PhiInst *>(&instr)){
+            if (auto *phi = dyn_cast<PhiInst>(&instr)){
                 auto lval = phi_lval[phi];
-                if (var_val_stack.count(lval) && !var_val_stack[lval].empty()){
+                if (lval != nullptr && !var_val_stack[lval].empty()){
                     auto new_val = var_val_stack[lval].back();
                     phi->add_phi_pair_operand(new_val, bb);
                 }
@@ -0,0 +1,121 @@
+#include "PassInstrumentation.hpp"
+#include "Module.hpp"
+
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <sys/resource.h>
+
+IRCounts IRCounts::collect(Module *m) {
+    IRCounts counts;
+    for (auto &f : m->get_functions()) {
+        counts.functions++;
+        for (auto &bb : f.get_basic_blocks()) {
+            counts.blocks++;
+            counts.instructions += bb.get_num_of_instr();
+        }
+    }
+    return counts;
+}
+
+static double cpu_time_ms() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+long PassInstrumentation::get_peak_rss_kb() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss; // Linux 下单位为 KB
+}
+
+void PassInstrumentation::run_pass(const std::string &name, Module *m,
+                                   const std::function<void()> &body) {
+    PassRecord record;
+    record.name = name;
+    // 统计 IR 规模需要遍历整个模块，不计入 pass 时间
+    record.before = IRCounts::collect(m);
+
+    auto wall_start = std::chrono::steady_clock::now();
+    auto cpu_start = cpu_time_ms();
+    body();
+    record.cpu_ms = cpu_time_ms() - cpu_start;
+    record.wall_ms = std::chrono::duration<double, std::milli>(
+                         std::chrono::steady_clock::now() - wall_start)
+                         .count();
+
+    record.after = IRCounts::collect(m);
+    record.peak_rss_kb = get_peak_rss_kb();
+    records_.push_back(std::move(record));
+}
+
+void PassInstrumentation::print_timing_table(std::ostream &os) const {
+    double total_wall = 0, total_cpu = 0;
+    for (auto &r : records_) {
+        total_wall += r.wall_ms;
+        total_cpu += r.cpu_ms;
+    }
+
+    auto old_flags = os.flags();
+    auto old_precision = os.precision();
+    os << std::fixed << std::setprecision(3);
+    os << "===== Pass execution timing report =====\n";
+    os << std::setw(12) << "Wall(ms)" << std::setw(8) << "%" << std::setw(12)
+       << "CPU(ms)" << std::setw(14) << "PeakRSS(KB)"
+       << "  Name\n";
+    for (auto &r : records_) {
+        os << std::setw(12) << r.wall_ms << std::setw(8)
+           << (total_wall > 0 ? r.wall_ms * 100 / total_wall : 0)
+           << std::setw(12) << r.cpu_ms << std::setw(14) << r.peak_rss_kb
+           << "  " << r.name << "\n";
+    }
+    os << std::setw(12) << total_wall << std::setw(8) << 100.0 << std::setw(12)
+       << total_cpu << std::setw(14) << get_peak_rss_kb() << "  Total\n";
+    os.flags(old_flags);
+    os.precision(old_precision);
+}
+
+void PassInstrumentation::print_stats_table(std::ostream &os) const {
+    auto column = [&](unsigned before, unsigned after, int width) {
+        os << std::setw(width)
+           << (std::to_string(before) + " -> " + std::to_string(after));
+    };
+    os << "===== IR statistics per pass (before -> after) =====\n";
+    os << std::setw(16) << "Functions" << std::setw(16) << "Blocks"
+       << std::setw(20) << "Instructions"
+       << "  Name\n";
+    for (auto &r : records_) {
+        column(r.before.functions, r.after.functions, 16);
+        column(r.before.blocks, r.after.blocks, 16);
+        column(r.before.instructions, r.after.instructions, 20);
+        os << "  " << r.name << "\n";
+    }
+}
+
+static void print_counts_json(std::ostream &os, const IRCounts &c) {
+    os << "{\"functions\": " << c.functions << ", \"blocks\": " << c.blocks
+       << ", \"instructions\": " << c.instructions << "}";
+}
+
+void PassInstrumentation::print_json(std::ostream &os) const {
+    double total_wall = 0, total_cpu = 0;
+    os << "{\n  \"passes\": [";
+    for (unsigned i = 0; i < records_.size(); i++) {
+        auto &r = records_[i];
+        total_wall += r.wall_ms;
+        total_cpu += r.cpu_ms;
+        os << (i ? ",\n" : "\n");
+        os << "    {\"name\": \"" << r.name << "\", \"wall_ms\": " << r.wall_ms
+           << ", \"cpu_ms\": " << r.cpu_ms
+           << ", \"peak_rss_kb\": " << r.peak_rss_kb << ", \"before\": ";
+        print_counts_json(os, r.before);
+        os << ", \"after\": ";
+        print_counts_json(os, r.after);
+        os << "}";
+    }
+    os << "\n  ],\n";
+    os << "  \"total_wall_ms\": " << total_wall << ",\n";
+    os << "  \"total_cpu_ms\": " << total_cpu << ",\n";
+    os << "  \"peak_rss_kb\": " << get_peak_rss_kb() << "\n}\n";
+}
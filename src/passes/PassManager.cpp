@@ -0,0 +1,59 @@
+#include "PassManager.hpp"
+#include "ThreadPool.hpp"
+
+void FunctionPass::run() {
+    init();
+    for (auto &f : m_->get_functions()) {
+        if (f.is_declaration())
+            continue;
+        run_on_func(&f);
+    }
+    finish();
+}
+
+void PassManager::run() {
+    for (auto &pass : passes_) {
+        if (instrumentation_.enabled()) {
+            instrumentation_.run_pass(pass->get_name(), m_,
+                                      [&]() { run_pass(pass.get()); });
+        } else {
+            run_pass(pass.get());
+        }
+        analysis_manager_.invalidate(pass->get_preserved_analyses());
+    }
+}
+
+void PassManager::run_pass(Pass *pass) {
+    auto function_pass = dynamic_cast<FunctionPass *>(pass);
+    if (function_pass and num_threads_ > 1) {
+        run_function_pass_parallel(function_pass);
+    } else {
+        // 模块级 pass（如 FuncInfo）总是串行执行
+        pass->run();
+    }
+}
+
+void PassManager::run_function_pass_parallel(FunctionPass *pass) {
+    pass->init();
+
+    ThreadPool pool(num_threads_);
+    std::vector<std::unique_ptr<FunctionPass>> workers;
+    for (unsigned i = 0; i < pool.size(); i++) {
+        workers.emplace_back(pass->clone());
+        workers.back()->set_analysis_manager(&analysis_manager_);
+    }
+    for (auto &f : m_->get_functions()) {
+        if (f.is_declaration())
+            continue;
+        auto func = &f;
+        pool.submit([&workers, func](unsigned worker_id) {
+            workers[worker_id]->run_on_func(func);
+        });
+    }
+    pool.wait();
+
+    for (auto &worker : workers) {
+        pass->merge(worker.get());
+    }
+    pass->finish();
+}
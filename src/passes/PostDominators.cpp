@@ -0,0 +1,174 @@
+#include "PostDominators.hpp"
+#include "BasicBlock.hpp"
+#include "Function.hpp"
+
+#include <vector>
+
+/**
+ *!@brief 对单个函数执行后必经关系分析
+ * @param f 要分析的函数
+ *
+ * 1. 找出连向虚拟出口的基本块
+ * 2. 从虚拟出口出发深度优先遍历反向 CFG，得到后序编号
+ * 3. 用迭代算法计算直接后必经结点(ipdom)
+ * 4. 计算后必经边界，即控制依赖关系
+ */
+void PostDominators::run_on_func(Function *f) {
+    auto num_blocks = f->get_num_block_indices();
+    post_order_.reset(num_blocks);
+    ipdom_.reset(num_blocks);
+    reaches_exit_.reset(num_blocks);
+    is_exit_.reset(num_blocks);
+    exits_.clear();
+    post_order_vec_.clear();
+
+    find_exits(f);
+    run_dfs(f);
+    create_ipdom();
+    create_post_dominance_frontier(f);
+}
+
+/**
+ *!@brief 找出连向虚拟出口的基本块
+ * @param f 要分析的函数
+ *
+ * 先是没有后继的基本块（以 ret 结尾），再是沿前驱
+ * 反向遍历时访问不到的基本块，即到不了 ret 的死循环中的块。
+ * 把后者也连向虚拟出口，反向 CFG 上每个基本块都从虚拟出口可达。
+ */
+void PostDominators::find_exits(Function *f) {
+    std::vector<BasicBlock *> stack;
+    for (auto &bb : f->get_basic_blocks()) {
+        if (bb.get_succ_basic_blocks().empty()) {
+            exits_.push_back(&bb);
+            reaches_exit_[&bb] = true;
+            stack.push_back(&bb);
+        }
+    }
+    while (not stack.empty()) {
+        auto bb = stack.back();
+        stack.pop_back();
+        for (auto pred : bb->get_pre_basic_blocks()) {
+            if (not reaches_exit_[pred]) {
+                reaches_exit_[pred] = true;
+                stack.push_back(pred);
+            }
+        }
+    }
+    for (auto &bb : f->get_basic_blocks()) {
+        if (not reaches_exit_[&bb])
+            exits_.push_back(&bb);
+    }
+    for (auto bb : exits_)
+        is_exit_[bb] = true;
+}
+
+/**
+ *!@brief 从虚拟出口出发深度优先遍历反向 CFG
+ * @param f 要分析的函数
+ *
+ * 虚拟出口的后继为 exits_，基本块的后继为其 CFG 前驱。
+ * 用显式栈代替递归，结果为 post_order_vec_/post_order_。
+ */
+void PostDominators::run_dfs(Function *f) {
+    DenseBlockMap<bool> visited(f->get_num_block_indices());
+    // 栈中每项为基本块及其下一个待访问前驱的下标
+    std::vector<std::pair<BasicBlock *, unsigned>> stack;
+    for (auto exit : exits_) {
+        if (visited[exit])
+            continue;
+        visited[exit] = true;
+        stack.emplace_back(exit, 0);
+        while (not stack.empty()) {
+            auto &[bb, next] = stack.back();
+            auto &preds = bb->get_pre_basic_blocks();
+            if (next < preds.size()) {
+                auto pred = preds[next++];
+                if (not visited[pred]) {
+                    visited[pred] = true;
+                    stack.emplace_back(pred, 0);
+                }
+                continue;
+            }
+            post_order_[bb] = post_order_vec_.size();
+            post_order_vec_.push_back(bb);
+            stack.pop_back();
+        }
+    }
+    // 虚拟出口
+    post_order_vec_.push_back(nullptr);
+}
+
+// 与 Dominators::intersect 相同，在以后序号表示的树上求最近公共祖先
+static unsigned intersect(const std::vector<unsigned> &doms, unsigned b1,
+                          unsigned b2) {
+    while (b1 != b2) {
+        while (b1 < b2)
+            b1 = doms[b1];
+        while (b2 < b1)
+            b2 = doms[b2];
+    }
+    return b1;
+}
+
+/**
+ *!@brief 计算所有基本块的直接后必经结点
+ *
+ * 在反向 CFG 上使用 Cooper-Harvey-Kennedy 迭代算法，
+ * 基本块在反向 CFG 上的前驱为其 CFG 后继，连向虚拟出口的块还有虚拟出口。
+ */
+void PostDominators::create_ipdom() {
+    const unsigned undefined = ~0u;
+    unsigned root = post_order_vec_.size() - 1;
+    doms_.assign(post_order_vec_.size(), undefined);
+    doms_[root] = root;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (unsigned b = root; b-- > 0;) {
+            auto bb = post_order_vec_[b];
+            unsigned new_idom = is_exit_[bb] ? root : undefined;
+            for (auto succ : bb->get_succ_basic_blocks()) {
+                unsigned p = post_order_[succ];
+                if (doms_[p] == undefined)
+                    continue;
+                new_idom = new_idom == undefined
+                               ? p
+                               : intersect(doms_, new_idom, p);
+            }
+            if (doms_[b] != new_idom) {
+                doms_[b] = new_idom;
+                changed = true;
+            }
+        }
+    }
+    for (unsigned b = 0; b < root; b++)
+        ipdom_[post_order_vec_[b]] = post_order_vec_[doms_[b]];
+}
+
+/**
+ *!@brief 计算所有基本块的后必经边界
+ * @param f 要分析的函数
+ *
+ * 与支配边界对称：对于每个有多个后继的基本块B，从每个后继出发
+ * 沿后必经树向上直到B的直接后必经结点，将B加入路径上各节点的边界中。
+ * Y 的后必经边界就是 Y 控制依赖的基本块：这些块末尾的分支决定 Y 是否执行。
+ * 虚拟出口作为后继时B的直接后必经结点就是它，这条路径为空。
+ */
+void PostDominators::create_post_dominance_frontier(Function *f) {
+    frontier_.reset(f->get_num_block_indices());
+    for (auto &bb : f->get_basic_blocks()) {
+        auto &succs = bb.get_succ_basic_blocks();
+        if (succs.size() + is_exit_[&bb] < 2)
+            continue;
+        unsigned ipdom = doms_[post_order_[&bb]];
+        for (auto succ : succs) {
+            for (auto runner = post_order_[succ]; runner != ipdom;
+                 runner = doms_[runner]) {
+                auto &pdf = frontier_[post_order_vec_[runner]];
+                if (pdf.empty() || pdf.back() != &bb)
+                    pdf.push_back(&bb);
+            }
+        }
+    }
+}
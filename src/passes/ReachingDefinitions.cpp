@@ -0,0 +1,51 @@
+#include "ReachingDefinitions.hpp"
+#include "DataFlow.hpp"
+#include "Function.hpp"
+
+#include <unordered_map>
+
+/**
+ *!@brief 对单个函数执行到达定值分析
+ * @param f 要分析的函数
+ *
+ * 先为函数中的 store 编号并按地址分组，基本块的 kill 为写其中
+ * 各地址的全部 store，gen 为其中对每个地址的最后一次 store。
+ */
+void ReachingDefinitions::run_on_func(Function *f) {
+    stores_.clear();
+    bits_.reset(f->get_num_inst_indices());
+    for (auto &bb : f->get_basic_blocks()) {
+        for (auto &inst : bb.get_instructions()) {
+            if (auto store = dyn_cast<StoreInst>(&inst)) {
+                stores_.push_back(store);
+                bits_[store] = stores_.size();
+            }
+        }
+    }
+    std::unordered_map<Value *, BitVector> stores_to;
+    for (auto store : stores_) {
+        auto &stores = stores_to[store->get_lval()];
+        if (stores.size() == 0)
+            stores = BitVector(stores_.size());
+        stores.set(bits_[store] - 1);
+    }
+
+    BitVectorDataFlow<DataFlowDirection::Forward, DataFlowMeet::Union> solver(
+        f, stores_.size());
+    for (auto &bb : f->get_basic_blocks()) {
+        auto &gen = solver.gen(&bb);
+        auto &kill = solver.kill(&bb);
+        for (auto &inst : bb.get_instructions()) {
+            auto store = dyn_cast<StoreInst>(&inst);
+            if (store == nullptr)
+                continue;
+            auto &stores = stores_to[store->get_lval()];
+            gen.subtract(stores);
+            gen.set(bits_[store] - 1);
+            kill.union_with(stores);
+        }
+    }
+    solver.solve();
+    reach_in_ = std::move(solver.get_in());
+    reach_out_ = std::move(solver.get_out());
+}
@@ -0,0 +1,83 @@
+// Allocation benchmark for the IR arena: counts heap allocations while the
+// IR of a large generated program is built and optimized, then measures a
+// walk over all instructions (with cache misses when perf events are
+// available) and the teardown of the module.
+//
+// usage: arena_bench [num_funcs]
+
+#include "DeadCode.hpp"
+#include "Mem2Reg.hpp"
+#include "PassManager.hpp"
+#include "bench.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<size_t> num_allocs{0};
+
+void *operator new(size_t size) {
+    num_allocs++;
+    if (auto *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { std::free(ptr); }
+
+int main(int argc, char **argv) {
+    int num_funcs = argc > 1 ? std::atoi(argv[1]) : 1000;
+    auto source = make_program(num_funcs);
+
+    Stopwatch watch;
+    size_t allocs_before = num_allocs;
+    auto m = build_module(source);
+    double build_ms = watch.lap();
+    size_t build_allocs = num_allocs - allocs_before;
+
+    {
+        PassManager PM(m.get());
+        PM.add_pass<Mem2Reg>();
+        PM.add_pass<DeadCode>();
+        PM.run();
+    }
+    size_t total_allocs = num_allocs - allocs_before;
+    watch.lap();
+
+    // pointer chasing over every instruction and its operands
+    CacheMissCounter misses;
+    misses.start();
+    long sum = 0;
+    for (int round = 0; round < 20; round++) {
+        for (auto &func : m->get_functions()) {
+            for (auto &bb : func.get_basic_blocks()) {
+                for (auto &inst : bb.get_instructions()) {
+                    sum += inst.get_instr_type() + inst.get_num_operand();
+                }
+            }
+        }
+    }
+    auto walk_misses = misses.stop();
+    double walk_ms = watch.lap();
+
+    m.reset();
+    double teardown_ms = watch.lap();
+
+    std::printf("functions          %d\n", num_funcs);
+    std::printf("allocs (build)     %zu\n", build_allocs);
+    std::printf("allocs (+passes)   %zu\n", total_allocs);
+    std::printf("build              %.1f ms\n", build_ms);
+    std::printf("walk x20           %.1f ms\n", walk_ms);
+    if (misses.valid()) {
+        std::printf("walk cache misses  %llu\n",
+                    static_cast<unsigned long long>(walk_misses));
+    } else {
+        std::printf("walk cache misses  n/a\n");
+    }
+    std::printf("teardown           %.1f ms\n", teardown_ms);
+    return sum == -1;
+}
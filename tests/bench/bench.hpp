@@ -0,0 +1,133 @@
+#pragma once
+
+// Helpers shared by the benchmarks: a stopwatch, a hardware cache-miss
+// counter, and a generator of large cminus programs.
+
+#include "Module.hpp"
+#include "ast.hpp"
+#include "cminusf_builder.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <memory>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+class Stopwatch {
+  public:
+    Stopwatch() : start_(std::chrono::steady_clock::now()) {}
+
+    // milliseconds since the last call, or since construction
+    double lap() {
+        auto now = std::chrono::steady_clock::now();
+        double ms =
+            std::chrono::duration<double, std::milli>(now - start_).count();
+        start_ = now;
+        return ms;
+    }
+
+  private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+// counts the cache misses of this thread; perf events may be unavailable
+// (e.g. in containers), then valid() is false and the count is 0
+class CacheMissCounter {
+  public:
+    CacheMissCounter() {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+    ~CacheMissCounter() {
+        if (valid()) {
+            close(fd_);
+        }
+    }
+    CacheMissCounter(const CacheMissCounter &) = delete;
+    CacheMissCounter &operator=(const CacheMissCounter &) = delete;
+
+    bool valid() const { return fd_ >= 0; }
+    void start() {
+        if (valid()) {
+            ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+    uint64_t stop() {
+        uint64_t count = 0;
+        if (valid()) {
+            ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd_, &count, sizeof(count)) != sizeof(count)) {
+                count = 0;
+            }
+        }
+        return count;
+    }
+
+  private:
+    long fd_;
+};
+
+// identifiers are letters only: fa, fb, ..., fz, fba, ...
+inline std::string func_name(int i) {
+    std::string name;
+    do {
+        name.insert(name.begin(), static_cast<char>('a' + i % 26));
+        i /= 26;
+    } while (i);
+    return "f" + name;
+}
+
+// num_funcs functions, each with a nested loop, an if/else and global
+// accesses, and a main calling all of them
+inline std::string make_program(int num_funcs) {
+    std::string source = "int g;\nfloat gf;\n";
+    for (int i = 0; i < num_funcs; i++) {
+        auto name = func_name(i);
+        auto k = std::to_string(i % 7 + 1);
+        source += "int " + name + "(int a, int b) {\n";
+        source += "    int i; int j; int s; float t;\n";
+        source += "    i = 0; s = " + std::to_string(i) + "; t = 1.5;\n";
+        source += "    while (i < a) {\n";
+        source += "        j = 0;\n";
+        source += "        while (j < b) {\n";
+        source += "            s = s + g * " + k + " + i;\n";
+        source += "            if (s > 1000) s = s - 1000; else s = s + 1;\n";
+        source += "            j = j + 1;\n";
+        source += "        }\n";
+        source += "        i = i + 1; t = t * 1.0;\n";
+        source += "    }\n";
+        source += "    if (t > 2.0) g = g + 1;\n";
+        source += "    return s;\n";
+        source += "}\n";
+    }
+    source += "int main(void) {\n    int s;\n    g = 1; s = 0;\n";
+    for (int i = 0; i < num_funcs; i++) {
+        source += "    s = s + " + func_name(i) + "(3, 3);\n";
+    }
+    source += "    output(s);\n    return 0;\n}\n";
+    return source;
+}
+
+// builds the LightIR of a cminus program held in memory
+inline std::unique_ptr<Module> build_module(std::string source) {
+    auto *input = fmemopen(source.data(), source.size(), "r");
+    auto *syntax_tree = parse_file(input);
+    fclose(input);
+    auto ast = AST(syntax_tree);
+    CminusfBuilder builder;
+    ast.run_visitor(builder);
+    return builder.getModule();
+}
@@ -0,0 +1,77 @@
+// CFG edge benchmark: builds a function of many blocks whose conditional
+// branches all jump to one join block, then times walking the edge lists,
+// retargeting the branches to another join block and erasing them. Every
+// edge to a join block is removed from a list of num_blocks / 3
+// predecessors.
+//
+// usage: cfg_bench [num_blocks]
+
+#include "BasicBlock.hpp"
+#include "Constant.hpp"
+#include "Function.hpp"
+#include "Instruction.hpp"
+#include "bench.hpp"
+
+#include <cstdlib>
+#include <vector>
+
+int main(int argc, char **argv) {
+    int num_blocks = argc > 1 ? std::atoi(argv[1]) : 200000;
+    auto m = std::make_unique<Module>();
+    auto *func_ty = FunctionType::get(m->get_void_type(), {});
+    auto *func = Function::create(func_ty, "f", m.get());
+    std::vector<BasicBlock *> bbs;
+    for (int i = 0; i < num_blocks; i++) {
+        bbs.push_back(BasicBlock::create(m.get(), "", func));
+    }
+    auto *join = bbs[num_blocks - 2];
+    auto *other_join = bbs[num_blocks - 1];
+    auto *cond = ConstantInt::get(true, m.get());
+
+    Stopwatch watch;
+    // a chain of blocks, every third one also branches to join
+    std::vector<BranchInst *> brs;
+    for (int i = 0; i + 2 < num_blocks; i++) {
+        if (i % 3 == 0) {
+            brs.push_back(
+                BranchInst::create_cond_br(cond, bbs[i + 1], join, bbs[i]));
+        } else {
+            brs.push_back(BranchInst::create_br(bbs[i + 1], bbs[i]));
+        }
+    }
+    double create_ms = watch.lap();
+
+    long sum = 0;
+    for (int round = 0; round < 20; round++) {
+        for (auto *bb : bbs) {
+            for (auto *pred : bb->get_pre_basic_blocks()) {
+                sum += pred == bb;
+            }
+            for (auto *succ : bb->get_succ_basic_blocks()) {
+                sum += succ == bb;
+            }
+        }
+    }
+    double walk_ms = watch.lap();
+
+    for (auto *br : brs) {
+        if (br->is_cond_br()) {
+            br->set_operand(2, other_join);
+        }
+    }
+    double retarget_ms = watch.lap();
+    auto join_preds = other_join->get_pre_basic_blocks().size();
+
+    for (int i = 0; i + 2 < num_blocks; i++) {
+        bbs[i]->erase_instr(brs[i]);
+    }
+    double erase_ms = watch.lap();
+
+    std::printf("blocks             %d\n", num_blocks);
+    std::printf("preds of join      %zu\n", join_preds);
+    std::printf("create             %.1f ms\n", create_ms);
+    std::printf("walk x20           %.1f ms\n", walk_ms);
+    std::printf("retarget           %.1f ms\n", retarget_ms);
+    std::printf("erase              %.1f ms\n", erase_ms);
+    return sum != 0;
+}
@@ -0,0 +1,162 @@
+// Dataflow benchmark: one generated function with thousands of blocks
+// (if/else and short loops over 40 variables). Times ReachingDefinitions
+// on the stores of the variables, then Liveness after Mem2Reg, and the
+// same liveness problem solved with std::set and std::map the way the
+// passes used to, whose result must agree with the bit vectors.
+//
+// usage: dataflow_bench [num_statements]
+
+#include "Liveness.hpp"
+#include "Mem2Reg.hpp"
+#include "ReachingDefinitions.hpp"
+#include "bench.hpp"
+
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <set>
+
+static const int num_vars = 40;
+
+// variable names are letters only: vaa, vba, ...
+static std::string var_name(int i) {
+    return std::string("v") + char('a' + i % 26) + char('a' + i / 26);
+}
+
+// about num_statements * 3 blocks in the function big
+static std::string make_branchy_program(int num_statements) {
+    std::mt19937 rng(1);
+    auto var = [&]() { return var_name(rng() % num_vars); };
+    auto expr = [&]() {
+        unsigned k = rng() % (num_vars + 2);
+        auto rhs = k < num_vars ? var_name(k) : k == num_vars ? "a" : "1";
+        return var() + " + " + rhs;
+    };
+    std::string source = "int g;\nint big(int a) {\n";
+    for (int i = 0; i < num_vars; i++) {
+        source += "    int " + var_name(i) + ";\n";
+    }
+    source += "    int lp;\n";
+    for (int i = 0; i < num_vars; i++) {
+        source += "    " + var_name(i) + " = " + std::to_string(i) + ";\n";
+    }
+    for (int i = 0; i < num_statements; i++) {
+        unsigned kind = rng() % 10;
+        if (kind < 5) {
+            source += "    if (" + var() + " > " + var() + ") " + var() +
+                      " = " + expr() + "; else " + var() + " = " + expr() +
+                      ";\n";
+        } else if (kind < 7) {
+            source += "    lp = 0;\n    while (lp < 3) {\n        " + var() +
+                      " = " + expr() + ";\n        if (a > " + var() + ") " +
+                      var() + " = " + expr() +
+                      "; else g = g + 1;\n        lp = lp + 1;\n    }\n";
+        } else {
+            source += "    " + var() + " = " + expr() + ";\n";
+        }
+    }
+    source += "    return " + var_name(0);
+    for (int i = 1; i < num_vars; i++) {
+        source += " + " + var_name(i);
+    }
+    source += ";\n}\nvoid main(void) { output(big(3)); }\n";
+    return source;
+}
+
+// round-robin liveness over std::set, with the conventions of Liveness:
+// a phi uses its incoming values at the end of the predecessors
+static size_t set_liveness(Function *func) {
+    std::map<BasicBlock *, std::set<Value *>> use, def, phi_use, live_in;
+    for (auto &bb : func->get_basic_blocks()) {
+        for (auto &inst : bb.get_instructions()) {
+            if (inst.is_phi()) {
+                for (unsigned i = 0; i + 1 < inst.get_num_operand(); i += 2) {
+                    if (dyn_cast<Instruction>(inst.get_operand(i))) {
+                        auto *pred =
+                            dyn_cast<BasicBlock>(inst.get_operand(i + 1));
+                        phi_use[pred].insert(inst.get_operand(i));
+                    }
+                }
+            } else {
+                for (auto *op : inst.get_operands()) {
+                    if (dyn_cast<Instruction>(op) and not def[&bb].count(op))
+                        use[&bb].insert(op);
+                }
+            }
+            if (not inst.is_void())
+                def[&bb].insert(&inst);
+        }
+    }
+    for (bool changed = true; changed;) {
+        changed = false;
+        auto &bbs = func->get_basic_blocks();
+        for (auto it = bbs.rbegin(); it != bbs.rend(); ++it) {
+            auto *bb = &*it;
+            auto live_out = phi_use[bb];
+            for (auto *succ : bb->get_succ_basic_blocks()) {
+                live_out.insert(live_in[succ].begin(), live_in[succ].end());
+            }
+            auto in = use[bb];
+            for (auto *value : live_out) {
+                if (not def[bb].count(value))
+                    in.insert(value);
+            }
+            if (in != live_in[bb]) {
+                live_in[bb] = std::move(in);
+                changed = true;
+            }
+        }
+    }
+    size_t total = 0;
+    for (auto &[bb, values] : live_in) {
+        total += values.size();
+    }
+    return total;
+}
+
+int main(int argc, char **argv) {
+    int num_statements = argc > 1 ? std::atoi(argv[1]) : 2000;
+    auto m = build_module(make_branchy_program(num_statements));
+    Function *big = nullptr;
+    for (auto &func : m->get_functions()) {
+        if (func.get_name() == "big")
+            big = &func;
+    }
+    auto num_blocks = big->get_num_basic_blocks();
+
+    Stopwatch watch;
+    ReachingDefinitions reaching(m.get());
+    reaching.run_on_func(big);
+    double reaching_ms = watch.lap();
+    auto num_stores = reaching.get_num_stores();
+
+    {
+        PassManager PM(m.get());
+        PM.add_pass<Mem2Reg>();
+        PM.run();
+    }
+    watch.lap();
+    Liveness liveness(m.get());
+    liveness.run_on_func(big);
+    double liveness_ms = watch.lap();
+    size_t live_total = 0;
+    for (auto &bb : big->get_basic_blocks()) {
+        live_total += liveness.get_live_in(&bb).count();
+    }
+    watch.lap();
+    auto set_total = set_liveness(big);
+    double set_ms = watch.lap();
+
+    std::printf("blocks             %u\n", num_blocks);
+    std::printf("reaching           %.2f ms (%u stores)\n", reaching_ms,
+                num_stores);
+    std::printf("liveness           %.2f ms (%u values)\n", liveness_ms,
+                liveness.get_num_values());
+    std::printf("std::set liveness  %.2f ms\n", set_ms);
+    if (live_total != set_total) {
+        std::printf("live-in sets disagree: %zu vs %zu\n", live_total,
+                    set_total);
+        return 1;
+    }
+    return 0;
+}
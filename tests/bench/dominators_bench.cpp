@@ -0,0 +1,126 @@
+// Scaling benchmark for Dominators: builds functions of num_blocks blocks
+// in four shapes and times both algorithms on each, together with the
+// dominance frontiers. The nest shape is one path as deep as the function
+// is long, which a recursive DFS would not survive.
+//
+// usage: dominators_bench [num_blocks]
+
+#include "BasicBlock.hpp"
+#include "Constant.hpp"
+#include "Dominators.hpp"
+#include "Function.hpp"
+#include "Instruction.hpp"
+#include "bench.hpp"
+
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+enum class Shape { Chain, Loops, Nest, Random };
+
+static const char *shape_name(Shape shape) {
+    switch (shape) {
+    case Shape::Chain:
+        return "chain";
+    case Shape::Loops:
+        return "loops";
+    case Shape::Nest:
+        return "nest";
+    default:
+        return "random";
+    }
+}
+
+// chain: if/else diamonds in sequence; loops: while loops in sequence,
+// each body an if; nest: while loops nested in each other; random: a
+// chain with random forward and backward edges
+static Function *build(Module *m, Shape shape, int num_blocks) {
+    auto *func_ty = FunctionType::get(m->get_void_type(), {});
+    auto *func = Function::create(func_ty, "f", m);
+    auto *cond = ConstantInt::get(true, m);
+    auto create = [&]() { return BasicBlock::create(m, "", func); };
+    auto *cur = create();
+    if (shape == Shape::Chain) {
+        for (int i = 0; i < num_blocks / 2; i++) {
+            auto *then_bb = create(), *join = create();
+            BranchInst::create_cond_br(cond, then_bb, join, cur);
+            BranchInst::create_br(join, then_bb);
+            cur = join;
+        }
+        ReturnInst::create_void_ret(cur);
+    } else if (shape == Shape::Loops) {
+        for (int i = 0; i < num_blocks / 4; i++) {
+            auto *header = create(), *body = create(), *then_bb = create(),
+                 *exit = create();
+            BranchInst::create_br(header, cur);
+            BranchInst::create_cond_br(cond, body, exit, header);
+            BranchInst::create_cond_br(cond, then_bb, header, body);
+            BranchInst::create_br(header, then_bb);
+            cur = exit;
+        }
+        ReturnInst::create_void_ret(cur);
+    } else if (shape == Shape::Nest) {
+        std::vector<BasicBlock *> headers, exits;
+        for (int i = 0; i < num_blocks / 3; i++) {
+            auto *header = create(), *exit = create(), *body = create();
+            BranchInst::create_br(header, cur);
+            BranchInst::create_cond_br(cond, body, exit, header);
+            headers.push_back(header);
+            exits.push_back(exit);
+            cur = body;
+        }
+        BranchInst::create_br(headers.back(), cur);
+        for (size_t i = headers.size() - 1; i > 0; i--) {
+            BranchInst::create_br(headers[i - 1], exits[i]);
+        }
+        ReturnInst::create_void_ret(exits[0]);
+    } else {
+        std::mt19937 rng(3);
+        std::vector<BasicBlock *> bbs{cur};
+        for (int i = 1; i < num_blocks; i++) {
+            bbs.push_back(create());
+        }
+        for (int i = 0; i + 1 < num_blocks; i++) {
+            auto *back = bbs[i - rng() % std::min(i + 1, 64)];
+            auto *forward =
+                bbs[std::min(num_blocks - 1, i + 1 + int(rng() % 8))];
+            if (rng() % 4) {
+                BranchInst::create_cond_br(cond, bbs[i + 1],
+                                           rng() % 3 ? forward : back, bbs[i]);
+            } else {
+                BranchInst::create_br(bbs[i + 1], bbs[i]);
+            }
+        }
+        ReturnInst::create_void_ret(bbs[num_blocks - 1]);
+    }
+    return func;
+}
+
+int main(int argc, char **argv) {
+    int num_blocks = argc > 1 ? std::atoi(argv[1]) : 100000;
+    std::printf("%-8s %8s %12s %12s %12s\n", "shape", "blocks", "iterative",
+                "semi-nca", "frontiers");
+    for (auto shape :
+         {Shape::Chain, Shape::Loops, Shape::Nest, Shape::Random}) {
+        auto m = std::make_unique<Module>();
+        auto *func = build(m.get(), shape, num_blocks);
+        Dominators iterative(m.get()), semi_nca(m.get());
+        iterative.set_algorithm(Dominators::Algorithm::Iterative);
+        semi_nca.set_algorithm(Dominators::Algorithm::SemiNCA);
+
+        Stopwatch watch;
+        iterative.run_on_func(func);
+        double iterative_ms = watch.lap();
+        semi_nca.run_on_func(func);
+        double semi_nca_ms = watch.lap();
+        for (auto &bb : func->get_basic_blocks()) {
+            semi_nca.get_dominance_frontier(&bb);
+        }
+        double frontier_ms = watch.lap();
+
+        std::printf("%-8s %8u %9.1f ms %9.1f ms %9.1f ms\n", shape_name(shape),
+                    func->get_num_basic_blocks(), iterative_ms, semi_nca_ms,
+                    frontier_ms);
+    }
+    return 0;
+}
@@ -0,0 +1,84 @@
+// Cast benchmark for the ValueKind tags: classifies every instruction and
+// operand of a large generated program with dyn_cast (classof) and with
+// dynamic_cast, then times the optimization passes, which cast on every
+// instruction they visit.
+//
+// usage: rtti_bench [num_funcs] [rounds]
+
+#include "Constant.hpp"
+#include "DeadCode.hpp"
+#include "LICM.hpp"
+#include "Mem2Reg.hpp"
+#include "PassManager.hpp"
+#include "bench.hpp"
+
+#include <cstdlib>
+#include <type_traits>
+
+// the kinds the passes most often ask about
+template <typename Cast> static long classify(Module *m, Cast cast) {
+    long count = 0;
+    for (auto &func : m->get_functions()) {
+        for (auto &bb : func.get_basic_blocks()) {
+            for (auto &inst : bb.get_instructions()) {
+                count += cast(&inst, static_cast<LoadInst *>(nullptr)) != 0;
+                count += cast(&inst, static_cast<StoreInst *>(nullptr)) != 0;
+                count += cast(&inst, static_cast<PhiInst *>(nullptr)) != 0;
+                count += cast(&inst, static_cast<CallInst *>(nullptr)) != 0;
+                for (auto *op : inst.get_operands()) {
+                    count += cast(op, static_cast<Constant *>(nullptr)) != 0;
+                    count +=
+                        cast(op, static_cast<GlobalVariable *>(nullptr)) != 0;
+                    count += cast(op, static_cast<AllocaInst *>(nullptr)) != 0;
+                }
+            }
+        }
+    }
+    return count;
+}
+
+int main(int argc, char **argv) {
+    int num_funcs = argc > 1 ? std::atoi(argv[1]) : 4000;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 10;
+    auto m = build_module(make_program(num_funcs));
+
+    auto tag_cast = [](auto *v, auto *tag) {
+        return dyn_cast<std::remove_pointer_t<decltype(tag)>>(v);
+    };
+    auto rtti_cast = [](auto *v, auto *tag) {
+        return dynamic_cast<decltype(tag)>(v);
+    };
+
+    Stopwatch watch;
+    long tag_count = 0;
+    for (int round = 0; round < rounds; round++) {
+        tag_count += classify(m.get(), tag_cast);
+    }
+    double tag_ms = watch.lap();
+    long rtti_count = 0;
+    for (int round = 0; round < rounds; round++) {
+        rtti_count += classify(m.get(), rtti_cast);
+    }
+    double rtti_ms = watch.lap();
+    if (tag_count != rtti_count) {
+        std::printf("dyn_cast and dynamic_cast disagree: %ld vs %ld\n",
+                    tag_count, rtti_count);
+        return 1;
+    }
+
+    {
+        PassManager PM(m.get());
+        PM.add_pass<Mem2Reg>();
+        PM.add_pass<DeadCode>();
+        PM.add_pass<LoopInvariantCodeMotion>();
+        PM.add_pass<DeadCode>();
+        PM.run();
+    }
+    double passes_ms = watch.lap();
+
+    std::printf("functions          %d\n", num_funcs);
+    std::printf("dyn_cast x%d       %.1f ms\n", rounds, tag_ms);
+    std::printf("dynamic_cast x%d   %.1f ms\n", rounds, rtti_ms);
+    std::printf("passes             %.1f ms\n", passes_ms);
+    return 0;
+}
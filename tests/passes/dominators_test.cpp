@@ -0,0 +1,301 @@
+// Randomized check of the dominator analysis. On random CFGs, the
+// iterative algorithm and Semi-NCA must agree with dominator sets
+// computed by the textbook dataflow equations. After random edits (edges
+// added and deleted, edges split by a new block, unreachable blocks
+// removed), the incrementally updated result must equal a fresh run.
+//
+// usage: dominators_test [seed]
+
+#include "BasicBlock.hpp"
+#include "Constant.hpp"
+#include "Dominators.hpp"
+#include "Function.hpp"
+#include "Instruction.hpp"
+#include "Module.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+static int num_failures = 0;
+
+#define CHECK(cond, ...)                                                       \
+    do {                                                                       \
+        if (not(cond)) {                                                       \
+            std::printf("%s:%d: check failed: %s: ", __FILE__, __LINE__,     \
+                        #cond);                                                \
+            std::printf(__VA_ARGS__);                                          \
+            std::printf("\n");                                                 \
+            num_failures++;                                                    \
+        }                                                                      \
+    } while (0)
+
+using Blocks = std::vector<BasicBlock *>;
+
+static Function *create_function(Module *m) {
+    auto *func_ty = FunctionType::get(m->get_void_type(), {});
+    return Function::create(func_ty, "f", m);
+}
+
+// mostly forward edges to near blocks, some to any block (loops, and
+// blocks no path reaches)
+static BasicBlock *random_target(std::mt19937 &rng, const Blocks &bbs,
+                                 unsigned i) {
+    unsigned n = bbs.size();
+    if (rng() % 3 == 0) {
+        return bbs[rng() % n];
+    }
+    return bbs[std::min<unsigned>(n - 1, i + 1 + rng() % 3)];
+}
+
+// n blocks ending in ret, br or a conditional br
+static Blocks random_cfg(std::mt19937 &rng, Module *m, Function *func,
+                         unsigned n) {
+    Blocks bbs;
+    for (unsigned i = 0; i < n; i++) {
+        bbs.push_back(BasicBlock::create(m, "", func));
+    }
+    auto *cond = ConstantInt::get(true, m);
+    for (unsigned i = 0; i < n; i++) {
+        switch (rng() % 4) {
+        case 0:
+            ReturnInst::create_void_ret(bbs[i]);
+            break;
+        case 1:
+            BranchInst::create_br(random_target(rng, bbs, i), bbs[i]);
+            break;
+        default:
+            BranchInst::create_cond_br(cond, random_target(rng, bbs, i),
+                                       random_target(rng, bbs, i), bbs[i]);
+        }
+    }
+    return bbs;
+}
+
+// dom[b][d]: d dominates b, by iterating the dataflow equations to the
+// fixed point; unreachable blocks dominate nothing and have no dominators
+static std::vector<std::vector<bool>> dataflow_dominators(const Blocks &bbs) {
+    unsigned n = bbs.size();
+    std::vector<bool> reachable(n);
+    std::vector<unsigned> stack{0};
+    reachable[0] = true;
+    while (not stack.empty()) {
+        auto *bb = bbs[stack.back()];
+        stack.pop_back();
+        for (auto *succ : bb->get_succ_basic_blocks()) {
+            if (not reachable[succ->get_index()]) {
+                reachable[succ->get_index()] = true;
+                stack.push_back(succ->get_index());
+            }
+        }
+    }
+    std::vector<std::vector<bool>> dom(n, reachable);
+    dom[0] = std::vector<bool>(n);
+    dom[0][0] = true;
+    for (unsigned b = 0; b < n; b++) {
+        if (not reachable[b]) {
+            dom[b] = std::vector<bool>(n);
+        }
+    }
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (unsigned b = 1; b < n; b++) {
+            if (not reachable[b]) {
+                continue;
+            }
+            auto meet = reachable;
+            for (auto *pred : bbs[b]->get_pre_basic_blocks()) {
+                unsigned p = pred->get_index();
+                if (not reachable[p]) {
+                    continue;
+                }
+                for (unsigned d = 0; d < n; d++) {
+                    meet[d] = meet[d] and dom[p][d];
+                }
+            }
+            meet[b] = true;
+            if (meet != dom[b]) {
+                dom[b] = meet;
+                changed = true;
+            }
+        }
+    }
+    return dom;
+}
+
+static void check_algorithms(std::mt19937 &rng, unsigned max_blocks) {
+    auto m = std::make_unique<Module>();
+    auto *func = create_function(m.get());
+    auto bbs = random_cfg(rng, m.get(), func, 1 + rng() % max_blocks);
+    unsigned n = bbs.size();
+
+    Dominators iterative(m.get()), semi_nca(m.get());
+    iterative.set_algorithm(Dominators::Algorithm::Iterative);
+    semi_nca.set_algorithm(Dominators::Algorithm::SemiNCA);
+    iterative.run_on_func(func);
+    semi_nca.run_on_func(func);
+    auto dom = dataflow_dominators(bbs);
+
+    for (unsigned b = 0; b < n; b++) {
+        auto *bb = bbs[b];
+        CHECK(iterative.get_idom(bb) == semi_nca.get_idom(bb), "block %u/%u",
+              b, n);
+        if (not dom[b][b]) {
+            CHECK(iterative.get_idom(bb) == nullptr, "unreachable %u/%u", b,
+                  n);
+            continue;
+        }
+        // the idom is the strict dominator that the others dominate
+        BasicBlock *idom = bb;
+        if (b != 0) {
+            unsigned best = b;
+            for (unsigned d = 0; d < n; d++) {
+                if (d != b and dom[b][d] and
+                    (best == b or dom[d][best])) {
+                    best = d;
+                }
+            }
+            idom = bbs[best];
+        }
+        CHECK(iterative.get_idom(bb) == idom, "idom of %u/%u", b, n);
+        for (unsigned other = 0; other < n; other++) {
+            if (dom[other][other]) {
+                CHECK(iterative.is_dominate(bb, bbs[other]) == dom[other][b] and
+                          semi_nca.is_dominate(bb, bbs[other]) == dom[other][b],
+                      "%u dominates %u, %u blocks", b, other, n);
+            }
+        }
+        CHECK(iterative.get_dominance_frontier(bb) ==
+                  semi_nca.get_dominance_frontier(bb),
+              "frontier of %u/%u", b, n);
+    }
+}
+
+// the incremental result must not differ from a fresh run in anything a
+// pass can query
+static void compare(Dominators &updated, Module *m, Function *func,
+                    const Blocks &bbs, unsigned step) {
+    Dominators fresh(m);
+    fresh.run_on_func(func);
+    for (auto *bb : bbs) {
+        CHECK(updated.get_idom(bb) == fresh.get_idom(bb), "step %u", step);
+        if (fresh.get_idom(bb) == nullptr) {
+            continue;
+        }
+        auto children = updated.get_dom_tree_succ_blocks(bb);
+        auto fresh_children = fresh.get_dom_tree_succ_blocks(bb);
+        std::sort(children.begin(), children.end());
+        std::sort(fresh_children.begin(), fresh_children.end());
+        CHECK(children == fresh_children, "step %u", step);
+        CHECK(updated.get_dominance_frontier(bb) ==
+                  fresh.get_dominance_frontier(bb),
+              "step %u", step);
+        for (auto *other : bbs) {
+            if (fresh.get_idom(other)) {
+                CHECK(updated.is_dominate(bb, other) ==
+                          fresh.is_dominate(bb, other),
+                      "step %u", step);
+            }
+        }
+    }
+    CHECK(updated.get_dom_dfs_order().size() ==
+              fresh.get_dom_dfs_order().size(),
+          "step %u", step);
+}
+
+static void check_updates(std::mt19937 &rng) {
+    auto m = std::make_unique<Module>();
+    auto *func = create_function(m.get());
+    auto *cond = ConstantInt::get(true, m.get());
+    unsigned n = 2 + rng() % 150;
+    Blocks bbs;
+    std::vector<BranchInst *> brs;
+    for (unsigned i = 0; i < n; i++) {
+        bbs.push_back(BasicBlock::create(m.get(), "", func));
+    }
+    for (unsigned i = 0; i < n; i++) {
+        brs.push_back(BranchInst::create_cond_br(
+            cond, random_target(rng, bbs, i), random_target(rng, bbs, i),
+            bbs[i]));
+    }
+
+    Dominators dominators(m.get());
+    dominators.set_algorithm(rng() % 2 ? Dominators::Algorithm::SemiNCA
+                                       : Dominators::Algorithm::Iterative);
+    dominators.run_on_func(func);
+    for (unsigned step = 0; step < 60; step++) {
+        unsigned b = rng() % bbs.size();
+        auto *bb = bbs[b];
+        auto *br = brs[b];
+        unsigned kind = rng() % 10;
+        if (kind < 8) {
+            if (not br->is_cond_br()) {
+                continue;
+            }
+            // a br to two blocks loses one, a br to one block gains one
+            unsigned i = 1 + rng() % 2;
+            auto *target = static_cast<BasicBlock *>(br->get_operand(i));
+            auto *other = static_cast<BasicBlock *>(br->get_operand(3 - i));
+            if (target != other) {
+                br->set_operand(i, other);
+                dominators.delete_edge(bb, target);
+            } else {
+                auto *new_target = bbs[rng() % bbs.size()];
+                if (new_target == target) {
+                    continue;
+                }
+                br->set_operand(i, new_target);
+                dominators.insert_edge(bb, new_target);
+            }
+        } else if (kind == 8) {
+            // split the edges of br to one target
+            if (not br->is_cond_br()) {
+                continue;
+            }
+            unsigned i = 1 + rng() % 2;
+            auto *target = static_cast<BasicBlock *>(br->get_operand(i));
+            auto *split = BasicBlock::create(m.get(), "", func);
+            br->set_operand(i, split);
+            if (br->get_operand(3 - i) == target and rng() % 2) {
+                br->set_operand(3 - i, split);
+            }
+            brs.push_back(BranchInst::create_br(target, split));
+            bbs.push_back(split);
+            dominators.insert_block(split);
+        } else {
+            // remove a block without predecessors
+            if (bb == func->get_entry_block() or
+                not bb->get_pre_basic_blocks().empty()) {
+                continue;
+            }
+            dominators.remove_block(bb);
+            bb->erase_from_parent();
+            delete bb;
+            bbs.erase(bbs.begin() + b);
+            brs.erase(brs.begin() + b);
+        }
+        compare(dominators, m.get(), func, bbs, step);
+    }
+}
+
+int main(int argc, char **argv) {
+    std::mt19937 rng(argc > 1 ? std::atoi(argv[1]) : 1);
+    // small functions cover the corner cases, larger ones use more than
+    // one level of the Semi-NCA forest
+    for (int round = 0; round < 2500; round++) {
+        check_algorithms(rng, 12);
+    }
+    for (int round = 0; round < 300; round++) {
+        check_algorithms(rng, 400);
+    }
+    for (int round = 0; round < 40; round++) {
+        check_updates(rng);
+    }
+    if (num_failures) {
+        std::printf("%d checks failed\n", num_failures);
+        return 1;
+    }
+    return 0;
+}
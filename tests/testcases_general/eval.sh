@@ -0,0 +1,68 @@
+#!/bin/bash
+
+# 用解释器运行每个测试用例，比较输出与返回值
+# usage: ./eval.sh [-roundtrip] <cminusfc> [<cminusfc options>...]
+#        e.g. ./eval.sh build/cminusfc -mem2reg -licm
+# -roundtrip: 先输出 .ll 与 .lirb，读回后带选项优化再输出，
+#             运行第二次输出的结果，检查读回的 IR 能正确优化和打印
+
+if [[ $1 == "-roundtrip" ]]; then
+    ROUNDTRIP=1
+    shift
+fi
+if [[ $# -lt 1 ]]; then
+    echo "usage: ./eval.sh [-roundtrip] <cminusfc> [<cminusfc options>...]"
+    exit 1
+fi
+
+CMINUSFC=$1
+shift
+TESTCASE_DIR="$(cd "$(dirname "$0")" && pwd)"
+TMP_DIR="$(mktemp -d)"
+trap 'rm -rf "$TMP_DIR"' EXIT
+score=0
+total=0
+
+# 运行 $1，输出程序的输出和返回值
+function run() {
+    local file=$1
+    shift
+    "$CMINUSFC" -interpret "$@" "$file" < "$input"
+    echo $?
+}
+
+for testcase in "$TESTCASE_DIR"/*.cminus; do
+    name="${testcase%.cminus}"
+    # 有 .in 文件时作为标准输入
+    input=/dev/null
+    if [[ -f "$name.in" ]]; then
+        input="$name.in"
+    fi
+    # .out 是程序的输出，最后一行是返回值
+    expected="$(cat "$name.out")"
+    correct=1
+    if [[ -z $ROUNDTRIP ]]; then
+        [[ "$(run "$testcase" "$@")" == "$expected" ]] || correct=0
+    else
+        for ext in ll lirb; do
+            emit=-emit-llvm
+            if [[ $ext == lirb ]]; then
+                emit=-emit-binary
+            fi
+            first="$TMP_DIR/first.$ext"
+            second="$TMP_DIR/second.$ext"
+            "$CMINUSFC" $emit "$testcase" -o "$first" &&
+                "$CMINUSFC" $emit "$@" "$first" -o "$second" &&
+                [[ "$(run "$second")" == "$expected" ]] || correct=0
+        done
+    fi
+    if [[ $correct -eq 1 ]]; then
+        let score=score+1
+    else
+        echo "[info] $(basename "$testcase") differs from the expected output."
+    fi
+    let total=total+1
+done
+
+echo "[info] Score with options '$*': $score/$total"
+[[ $score -eq $total ]]